@@ -0,0 +1,32 @@
+# frozen_string_literal: true
+
+require "larb"
+
+Warning[:experimental] = false
+
+module LarbBenchmark
+  ROUNDS = 5
+
+  module_function
+
+  def measure(label, operations)
+    best = Float::INFINITY
+    ROUNDS.times do
+      started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      yield
+      best = [best, Process.clock_gettime(Process::CLOCK_MONOTONIC) - started].min
+    end
+    printf("  %-32s %10.2f ns/op\n", label, best * 1e9 / operations)
+  end
+
+  def each_simd_level
+    original = Larb.simd_level
+    Larb.simd_levels.each do |level|
+      Larb.simd_level = level
+      puts "#{level}:"
+      yield level
+    end
+  ensure
+    Larb.simd_level = original
+  end
+end
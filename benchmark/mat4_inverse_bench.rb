@@ -0,0 +1,18 @@
+# frozen_string_literal: true
+
+require_relative "helper"
+
+BATCH = 100_000
+
+f64 = Larb::Mat4Array.from(Array.new(BATCH) { |i| Larb::Mat4.rotation_z(i * 0.001) * Larb::Mat4.translation(i, 1, 2) })
+f32 = f64.convert(:float32)
+f64_out = Larb::Mat4Array.new(BATCH)
+f32_out = Larb::Mat4Array.new(BATCH, type: :float32)
+mask = IO::Buffer.new(BATCH)
+
+puts "Mat4Array inverse (threads: #{Larb.threads})"
+LarbBenchmark.each_simd_level do
+  LarbBenchmark.measure("Mat4Array#inverse float64", BATCH) { f64.inverse(f64_out) }
+  LarbBenchmark.measure("Mat4Array#inverse float32", BATCH) { f32.inverse(f32_out) }
+  LarbBenchmark.measure("Mat4Array#inverse(mask:) float64", BATCH) { f64.inverse(f64_out, mask: mask) }
+end
@@ -0,0 +1,24 @@
+# frozen_string_literal: true
+
+require_relative "helper"
+
+CALLS = 200_000
+BATCH = 100_000
+
+a = Larb::Mat4.perspective(1.0, 1.5, 0.1, 100) * Larb::Mat4.translation(1, 2, 3)
+b = Larb::Mat4.rotation_y(0.5) * Larb::Mat4.scaling(2, 3, 4)
+out = Larb::Mat4.identity.dup
+
+f64 = Larb::Mat4Array.from(Array.new(BATCH) { |i| Larb::Mat4.rotation_z(i * 0.001) })
+f32 = f64.convert(:float32)
+f64_out = Larb::Mat4Array.new(BATCH)
+f32_out = Larb::Mat4Array.new(BATCH, type: :float32)
+
+puts "Mat4 multiply (threads: #{Larb.threads})"
+LarbBenchmark.each_simd_level do
+  LarbBenchmark.measure("Mat4#*", CALLS) { CALLS.times { a * b } }
+  LarbBenchmark.measure("Mat4.multiply(a, b, out)", CALLS) { CALLS.times { Larb::Mat4.multiply(a, b, out) } }
+  LarbBenchmark.measure("Mat4Array#multiply float64", BATCH) { f64.multiply(f64, f64_out) }
+  LarbBenchmark.measure("Mat4Array#multiply float32", BATCH) { f32.multiply(f32, f32_out) }
+  LarbBenchmark.measure("Mat4Array#multiply(Mat4) float32", BATCH) { f32.multiply(b, f32_out) }
+end
@@ -2,38 +2,40 @@
 
 #include <math.h>
 
-static void color_free(void *ptr) {
-  xfree(ptr);
-}
+#include "vec3.h"
+#include "vec4.h"
 
 static size_t color_memsize(const void *ptr) {
-  return sizeof(ColorData);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(ColorData);
 }
 
 static const rb_data_type_t color_type = {
     "Color",
-    {0, color_free, color_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, color_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cColor = Qnil;
-static VALUE cVec3 = Qnil;
-static VALUE cVec4 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
-
-static ColorData *color_get(VALUE obj) {
+VALUE cColor = Qnil;
+static VALUE color_const_black = Qnil;
+static VALUE color_const_white = Qnil;
+static VALUE color_const_red = Qnil;
+static VALUE color_const_green = Qnil;
+static VALUE color_const_blue = Qnil;
+static VALUE color_const_yellow = Qnil;
+static VALUE color_const_cyan = Qnil;
+static VALUE color_const_magenta = Qnil;
+static VALUE color_const_transparent = Qnil;
+
+ColorData *color_get(VALUE obj) {
   ColorData *data = NULL;
   TypedData_Get_Struct(obj, ColorData, &color_type, data);
   return data;
 }
 
-static VALUE color_build(VALUE klass, double r, double g, double b, double a) {
+VALUE color_build(VALUE klass, double r, double g, double b, double a) {
   VALUE obj = color_alloc(klass);
   ColorData *data = color_get(obj);
   data->r = r;
@@ -69,6 +71,7 @@ static VALUE color_get_r(VALUE self) {
 }
 
 static VALUE color_set_r(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   ColorData *data = color_get(self);
   data->r = value_to_double(value);
   return value;
@@ -80,6 +83,7 @@ static VALUE color_get_g(VALUE self) {
 }
 
 static VALUE color_set_g(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   ColorData *data = color_get(self);
   data->g = value_to_double(value);
   return value;
@@ -91,6 +95,7 @@ static VALUE color_get_b(VALUE self) {
 }
 
 static VALUE color_set_b(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   ColorData *data = color_get(self);
   data->b = value_to_double(value);
   return value;
@@ -102,21 +107,24 @@ static VALUE color_get_a(VALUE self) {
 }
 
 static VALUE color_set_a(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   ColorData *data = color_get(self);
   data->a = value_to_double(value);
   return value;
 }
 
 VALUE color_alloc(VALUE klass) {
-  ColorData *data = ALLOC(ColorData);
+  ColorData *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, ColorData, &color_type, data);
   data->r = 0.0;
   data->g = 0.0;
   data->b = 0.0;
   data->a = 1.0;
-  return TypedData_Wrap_Struct(klass, &color_type, data);
+  return obj;
 }
 
 VALUE color_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE vr = Qnil;
   VALUE vg = Qnil;
   VALUE vb = Qnil;
@@ -132,6 +140,12 @@ VALUE color_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE color_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *color_get(self) = *color_get(other);
+  return self;
+}
+
 static VALUE color_class_bracket(int argc, VALUE *argv, VALUE klass) {
   VALUE vr = Qnil;
   VALUE vg = Qnil;
@@ -197,59 +211,63 @@ static VALUE color_class_from_hex(VALUE klass, VALUE hex_value) {
   return color_build(klass, r, g, b, a);
 }
 
+static VALUE color_constant(VALUE klass, VALUE constant) {
+  if (klass == cColor) {
+    return constant;
+  }
+  VALUE obj = color_alloc(klass);
+  *color_get(obj) = *color_get(constant);
+  return obj;
+}
+
 static VALUE color_class_black(VALUE klass) {
-  return color_build(klass, 0.0, 0.0, 0.0, 1.0);
+  return color_constant(klass, color_const_black);
 }
 
 static VALUE color_class_white(VALUE klass) {
-  return color_build(klass, 1.0, 1.0, 1.0, 1.0);
+  return color_constant(klass, color_const_white);
 }
 
 static VALUE color_class_red(VALUE klass) {
-  return color_build(klass, 1.0, 0.0, 0.0, 1.0);
+  return color_constant(klass, color_const_red);
 }
 
 static VALUE color_class_green(VALUE klass) {
-  return color_build(klass, 0.0, 1.0, 0.0, 1.0);
+  return color_constant(klass, color_const_green);
 }
 
 static VALUE color_class_blue(VALUE klass) {
-  return color_build(klass, 0.0, 0.0, 1.0, 1.0);
+  return color_constant(klass, color_const_blue);
 }
 
 static VALUE color_class_yellow(VALUE klass) {
-  return color_build(klass, 1.0, 1.0, 0.0, 1.0);
+  return color_constant(klass, color_const_yellow);
 }
 
 static VALUE color_class_cyan(VALUE klass) {
-  return color_build(klass, 0.0, 1.0, 1.0, 1.0);
+  return color_constant(klass, color_const_cyan);
 }
 
 static VALUE color_class_magenta(VALUE klass) {
-  return color_build(klass, 1.0, 0.0, 1.0, 1.0);
+  return color_constant(klass, color_const_magenta);
 }
 
 static VALUE color_class_transparent(VALUE klass) {
-  return color_build(klass, 0.0, 0.0, 0.0, 0.0);
+  return color_constant(klass, color_const_transparent);
 }
 
 VALUE color_class_from_vec4(VALUE klass, VALUE vec4) {
-  double r = value_to_double(rb_funcall(vec4, rb_intern("x"), 0));
-  double g = value_to_double(rb_funcall(vec4, rb_intern("y"), 0));
-  double b = value_to_double(rb_funcall(vec4, rb_intern("z"), 0));
-  double a = value_to_double(rb_funcall(vec4, rb_intern("w"), 0));
-  return color_build(klass, r, g, b, a);
+  Vec4Data *v = vec4_get(vec4);
+  return color_build(klass, v->x, v->y, v->z, v->w);
 }
 
 VALUE color_class_from_vec3(int argc, VALUE *argv, VALUE klass) {
   VALUE vec3 = Qnil;
   VALUE alpha = Qnil;
   rb_scan_args(argc, argv, "11", &vec3, &alpha);
-  double r = value_to_double(rb_funcall(vec3, rb_intern("x"), 0));
-  double g = value_to_double(rb_funcall(vec3, rb_intern("y"), 0));
-  double b = value_to_double(rb_funcall(vec3, rb_intern("z"), 0));
+  Vec3Data *v = vec3_get(vec3);
   double a = NIL_P(alpha) ? 1.0 : value_to_double(alpha);
-  return color_build(klass, r, g, b, a);
+  return color_build(klass, v->x, v->y, v->z, a);
 }
 
 VALUE color_add(VALUE self, VALUE other) {
@@ -298,6 +316,73 @@ VALUE color_clamp(VALUE self) {
                      clamp_double(a->a, 0.0, 1.0));
 }
 
+VALUE color_add_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  ColorData *a = color_get(self);
+  ColorData *b = color_get(other);
+  a->r += b->r;
+  a->g += b->g;
+  a->b += b->b;
+  a->a += b->a;
+  return self;
+}
+
+VALUE color_sub_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  ColorData *a = color_get(self);
+  ColorData *b = color_get(other);
+  a->r -= b->r;
+  a->g -= b->g;
+  a->b -= b->b;
+  a->a -= b->a;
+  return self;
+}
+
+VALUE color_mul_bang(VALUE self, VALUE scalar) {
+  rb_check_frozen(self);
+  ColorData *a = color_get(self);
+  if (rb_obj_is_kind_of(scalar, cColor)) {
+    ColorData *b = color_get(scalar);
+    a->r *= b->r;
+    a->g *= b->g;
+    a->b *= b->b;
+    a->a *= b->a;
+    return self;
+  }
+  if (rb_obj_is_kind_of(scalar, rb_cNumeric)) {
+    double s = value_to_double(scalar);
+    a->r *= s;
+    a->g *= s;
+    a->b *= s;
+    a->a *= s;
+    return self;
+  }
+  rb_raise(rb_eTypeError, "expected Color or Numeric");
+  return Qnil;
+}
+
+VALUE color_lerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  ColorData *a = color_get(self);
+  ColorData *b = color_get(other);
+  double s = value_to_double(t);
+  a->r += (b->r - a->r) * s;
+  a->g += (b->g - a->g) * s;
+  a->b += (b->b - a->b) * s;
+  a->a += (b->a - a->a) * s;
+  return self;
+}
+
+VALUE color_clamp_bang(VALUE self) {
+  rb_check_frozen(self);
+  ColorData *a = color_get(self);
+  a->r = clamp_double(a->r, 0.0, 1.0);
+  a->g = clamp_double(a->g, 0.0, 1.0);
+  a->b = clamp_double(a->b, 0.0, 1.0);
+  a->a = clamp_double(a->a, 0.0, 1.0);
+  return self;
+}
+
 VALUE color_to_bytes(VALUE self) {
   ColorData *a = color_get(self);
   int r = (int)lround(a->r * 255.0);
@@ -324,14 +409,12 @@ VALUE color_to_hex(VALUE self) {
 
 VALUE color_to_vec3(VALUE self) {
   ColorData *a = color_get(self);
-  return rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(a->r), DBL2NUM(a->g),
-                    DBL2NUM(a->b));
+  return vec3_build(cVec3, a->r, a->g, a->b);
 }
 
 VALUE color_to_vec4(VALUE self) {
   ColorData *a = color_get(self);
-  return rb_funcall(cVec4, rb_intern("new"), 4, DBL2NUM(a->r), DBL2NUM(a->g),
-                    DBL2NUM(a->b), DBL2NUM(a->a));
+  return vec4_build(cVec4, a->r, a->g, a->b, a->a);
 }
 
 VALUE color_to_a(VALUE self) {
@@ -396,11 +479,10 @@ VALUE color_inspect(VALUE self) {
 
 void Init_color(VALUE module) {
   cColor = rb_define_class_under(module, "Color", rb_cObject);
-  cVec3 = rb_const_get(mLarb, rb_intern("Vec3"));
-  cVec4 = rb_const_get(mLarb, rb_intern("Vec4"));
 
   rb_define_alloc_func(cColor, color_alloc);
   rb_define_method(cColor, "initialize", color_initialize, -1);
+  rb_define_method(cColor, "initialize_copy", color_initialize_copy, 1);
 
   rb_define_singleton_method(cColor, "[]", color_class_bracket, -1);
   rb_define_singleton_method(cColor, "rgb", color_class_rgb, 3);
@@ -416,6 +498,7 @@ void Init_color(VALUE module) {
   rb_define_singleton_method(cColor, "cyan", color_class_cyan, 0);
   rb_define_singleton_method(cColor, "magenta", color_class_magenta, 0);
   rb_define_singleton_method(cColor, "transparent", color_class_transparent, 0);
+
   rb_define_singleton_method(cColor, "from_vec4", color_class_from_vec4, 1);
   rb_define_singleton_method(cColor, "from_vec3", color_class_from_vec3, -1);
 
@@ -433,6 +516,11 @@ void Init_color(VALUE module) {
   rb_define_method(cColor, "*", color_mul, 1);
   rb_define_method(cColor, "lerp", color_lerp, 2);
   rb_define_method(cColor, "clamp", color_clamp, 0);
+  rb_define_method(cColor, "add!", color_add_bang, 1);
+  rb_define_method(cColor, "sub!", color_sub_bang, 1);
+  rb_define_method(cColor, "mul!", color_mul_bang, 1);
+  rb_define_method(cColor, "lerp!", color_lerp_bang, 2);
+  rb_define_method(cColor, "clamp!", color_clamp_bang, 0);
   rb_define_method(cColor, "to_bytes", color_to_bytes, 0);
   rb_define_method(cColor, "to_hex", color_to_hex, 0);
   rb_define_method(cColor, "to_vec3", color_to_vec3, 0);
@@ -443,4 +531,23 @@ void Init_color(VALUE module) {
   rb_define_method(cColor, "near?", color_near, -1);
   rb_define_method(cColor, "inspect", color_inspect, 0);
   rb_define_alias(cColor, "to_s", "inspect");
+
+  larb_define_constant(cColor, "BLACK", &color_const_black,
+                       color_build(cColor, 0.0, 0.0, 0.0, 1.0));
+  larb_define_constant(cColor, "WHITE", &color_const_white,
+                       color_build(cColor, 1.0, 1.0, 1.0, 1.0));
+  larb_define_constant(cColor, "RED", &color_const_red,
+                       color_build(cColor, 1.0, 0.0, 0.0, 1.0));
+  larb_define_constant(cColor, "GREEN", &color_const_green,
+                       color_build(cColor, 0.0, 1.0, 0.0, 1.0));
+  larb_define_constant(cColor, "BLUE", &color_const_blue,
+                       color_build(cColor, 0.0, 0.0, 1.0, 1.0));
+  larb_define_constant(cColor, "YELLOW", &color_const_yellow,
+                       color_build(cColor, 1.0, 1.0, 0.0, 1.0));
+  larb_define_constant(cColor, "CYAN", &color_const_cyan,
+                       color_build(cColor, 0.0, 1.0, 1.0, 1.0));
+  larb_define_constant(cColor, "MAGENTA", &color_const_magenta,
+                       color_build(cColor, 1.0, 0.0, 1.0, 1.0));
+  larb_define_constant(cColor, "TRANSPARENT", &color_const_transparent,
+                       color_build(cColor, 0.0, 0.0, 0.0, 0.0));
 }
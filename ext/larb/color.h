@@ -10,9 +10,13 @@ typedef struct {
   double a;
 } ColorData;
 
+extern VALUE cColor;
+
 void Init_color(VALUE module);
 VALUE color_alloc(VALUE klass);
 VALUE color_initialize(int argc, VALUE *argv, VALUE self);
+ColorData *color_get(VALUE obj);
+VALUE color_build(VALUE klass, double r, double g, double b, double a);
 
 VALUE color_class_from_vec4(VALUE klass, VALUE vec4);
 VALUE color_class_from_vec3(int argc, VALUE *argv, VALUE klass);
@@ -22,6 +26,11 @@ VALUE color_sub(VALUE self, VALUE other);
 VALUE color_mul(VALUE self, VALUE scalar);
 VALUE color_lerp(VALUE self, VALUE other, VALUE t);
 VALUE color_clamp(VALUE self);
+VALUE color_add_bang(VALUE self, VALUE other);
+VALUE color_sub_bang(VALUE self, VALUE other);
+VALUE color_mul_bang(VALUE self, VALUE scalar);
+VALUE color_lerp_bang(VALUE self, VALUE other, VALUE t);
+VALUE color_clamp_bang(VALUE self);
 VALUE color_to_bytes(VALUE self);
 VALUE color_to_hex(VALUE self);
 VALUE color_to_vec3(VALUE self);
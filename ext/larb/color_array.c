@@ -0,0 +1,421 @@
+#include "color_array.h"
+
+#include <math.h>
+
+#include "color.h"
+#include "packed_buffer.h"
+
+static const PackedArrayClass color_array_class;
+
+static const rb_data_type_t color_array_type = {
+    "ColorArray",
+    {packed_array_mark, RUBY_TYPED_DEFAULT_FREE, packed_array_memsize},
+    0,
+    (void *)&color_array_class,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
+};
+
+static const PackedArrayClass color_array_class = {
+    &color_array_type,
+    4,
+    false,
+    PACKED_FLOAT32,
+    NULL,
+    {{0}, {"f", 4, 16, 1, {4}, {4}}},
+};
+
+static VALUE cColorArray = Qnil;
+
+ColorArrayData *color_array_get(VALUE obj) {
+  return packed_array_get(obj, &color_array_class);
+}
+
+VALUE color_array_build(VALUE klass, long length) {
+  return packed_array_build(klass, &color_array_class, length,
+                            PACKED_FLOAT32);
+}
+
+static float *color_array_at(ColorArrayData *data, long index) {
+  return (float *)data->data + index * 4;
+}
+
+static void read_color(VALUE color, float *out) {
+  ColorData *c = color_get(color);
+  out[0] = (float)c->r;
+  out[1] = (float)c->g;
+  out[2] = (float)c->b;
+  out[3] = (float)c->a;
+}
+
+static VALUE color_new(const float *c) {
+  return color_build(cColor, c[0], c[1], c[2], c[3]);
+}
+
+static float clamp_float(float value) {
+  if (value < 0.0f) {
+    return 0.0f;
+  }
+  if (value > 1.0f) {
+    return 1.0f;
+  }
+  return value;
+}
+
+static const float *color_array_operand(VALUE other, long length,
+                                        float *scratch, long *stride,
+                                        int allow_scalar) {
+  if (rb_obj_is_kind_of(other, cColorArray)) {
+    ColorArrayData *b = color_array_get(other);
+    packed_check_length(length, b->length);
+    *stride = 4;
+    return b->data;
+  }
+  if (rb_obj_is_kind_of(other, cColor)) {
+    read_color(other, scratch);
+    *stride = 0;
+    return scratch;
+  }
+  if (allow_scalar && rb_obj_is_kind_of(other, rb_cNumeric)) {
+    float s = (float)value_to_double(other);
+    scratch[0] = s;
+    scratch[1] = s;
+    scratch[2] = s;
+    scratch[3] = s;
+    *stride = 0;
+    return scratch;
+  }
+  rb_raise(rb_eTypeError, allow_scalar ? "expected ColorArray, Color or Numeric"
+                                       : "expected ColorArray or Color");
+  return NULL;
+}
+
+static VALUE color_array_output(VALUE self, VALUE out, long length) {
+  if (NIL_P(out)) {
+    return color_array_build(rb_obj_class(self), length);
+  }
+  if (!rb_obj_is_kind_of(out, cColorArray)) {
+    rb_raise(rb_eTypeError, "expected ColorArray for output");
+  }
+  ColorArrayData *data = color_array_get(out);
+  packed_check_length(length, data->length);
+  packed_buffer_check_writable(out, data->buffer);
+  return out;
+}
+
+static void add_kernel(const float *a, const float *b, long stride, float *out,
+                       long n) {
+  for (long i = 0; i < n; i++) {
+    const float *p = a + i * 4;
+    const float *q = b + i * stride;
+    float *o = out + i * 4;
+    o[0] = p[0] + q[0];
+    o[1] = p[1] + q[1];
+    o[2] = p[2] + q[2];
+    o[3] = p[3] + q[3];
+  }
+}
+
+static void mul_kernel(const float *a, const float *b, long stride, float *out,
+                       long n) {
+  for (long i = 0; i < n; i++) {
+    const float *p = a + i * 4;
+    const float *q = b + i * stride;
+    float *o = out + i * 4;
+    o[0] = p[0] * q[0];
+    o[1] = p[1] * q[1];
+    o[2] = p[2] * q[2];
+    o[3] = p[3] * q[3];
+  }
+}
+
+static void lerp_kernel(const float *a, const float *b, long stride, float t,
+                        float *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const float *p = a + i * 4;
+    const float *q = b + i * stride;
+    float *o = out + i * 4;
+    o[0] = p[0] + (q[0] - p[0]) * t;
+    o[1] = p[1] + (q[1] - p[1]) * t;
+    o[2] = p[2] + (q[2] - p[2]) * t;
+    o[3] = p[3] + (q[3] - p[3]) * t;
+  }
+}
+
+static void clamp_kernel(const float *a, float *out, long n) {
+  for (long i = 0; i < n * 4; i++) {
+    out[i] = clamp_float(a[i]);
+  }
+}
+
+static void to_rgba8_kernel(const float *a, unsigned char *out, long n) {
+  for (long i = 0; i < n * 4; i++) {
+    out[i] = (unsigned char)lroundf(clamp_float(a[i]) * 255.0f);
+  }
+}
+
+static void from_rgba8_kernel(const unsigned char *a, float *out, long n) {
+  for (long i = 0; i < n * 4; i++) {
+    out[i] = (float)a[i] / 255.0f;
+  }
+}
+
+typedef struct {
+  void (*kernel)(const float *, const float *, long, float *, long);
+  const float *a;
+  const float *b;
+  long stride;
+  float t;
+  void *out;
+  long length;
+  const unsigned char *bytes;
+} ColorArrayJob;
+
+static void binary_job(void *ptr, long begin, long end) {
+  ColorArrayJob *job = ptr;
+  job->kernel(job->a + begin * 4, job->b + begin * job->stride, job->stride,
+              (float *)job->out + begin * 4, end - begin);
+}
+
+static void lerp_job(void *ptr, long begin, long end) {
+  ColorArrayJob *job = ptr;
+  lerp_kernel(job->a + begin * 4, job->b + begin * job->stride, job->stride,
+              job->t, (float *)job->out + begin * 4, end - begin);
+}
+
+static void clamp_job(void *ptr, long begin, long end) {
+  ColorArrayJob *job = ptr;
+  clamp_kernel(job->a + begin * 4, (float *)job->out + begin * 4,
+               end - begin);
+}
+
+static void to_rgba8_job(void *ptr, long begin, long end) {
+  ColorArrayJob *job = ptr;
+  to_rgba8_kernel(job->a + begin * 4, (unsigned char *)job->out + begin * 4,
+                  end - begin);
+}
+
+static void from_rgba8_job(void *ptr, long begin, long end) {
+  ColorArrayJob *job = ptr;
+  from_rgba8_kernel(job->bytes + begin * 4, (float *)job->out + begin * 4,
+                    end - begin);
+}
+
+static PackedPin color_array_pin(VALUE obj) {
+  if (!rb_obj_is_kind_of(obj, cColorArray)) {
+    return packed_pin(Qnil, Qnil, NULL);
+  }
+  ColorArrayData *data = color_array_get(obj);
+  return packed_pin(obj, data->buffer, &data->locks);
+}
+
+static void color_array_run(PackedJob run, ColorArrayJob *job, VALUE self,
+                            VALUE other, VALUE result) {
+  if (!NIL_P(result)) {
+    size_t size = (size_t)job->length * sizeof(float) * 4;
+    packed_check_overlap(job->a, size, job->out, size);
+    packed_check_overlap(job->b, job->stride ? size : 0, job->out, size);
+  }
+  PackedPin pins[3] = {color_array_pin(self), color_array_pin(other),
+                       color_array_pin(result)};
+  packed_run(job->length, run, job, pins, 3);
+}
+
+static VALUE color_array_binary(int argc, VALUE *argv, VALUE self,
+                                int allow_scalar,
+                                void (*kernel)(const float *, const float *,
+                                               long, float *, long)) {
+  VALUE other = Qnil;
+  VALUE out = Qnil;
+  float scratch[4];
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "11", &other, &out);
+  const float *b = color_array_operand(other, color_array_get(self)->length,
+                                       scratch, &stride, allow_scalar);
+  ColorArrayData *a = color_array_get(self);
+  VALUE result = color_array_output(self, out, a->length);
+  ColorArrayJob job = {kernel, a->data, b, stride, 0.0f,
+                       color_array_get(result)->data, a->length};
+  color_array_run(binary_job, &job, self, other, result);
+  return result;
+}
+
+VALUE color_array_alloc(VALUE klass) {
+  return packed_array_alloc(klass, &color_array_class);
+}
+
+static VALUE color_array_class_from(VALUE klass, VALUE colors) {
+  VALUE ary = rb_check_array_type(colors);
+  if (NIL_P(ary)) {
+    rb_raise(rb_eTypeError, "expected Array");
+  }
+
+  long length = RARRAY_LEN(ary);
+  VALUE obj = color_array_build(klass, length);
+  ColorArrayData *data = color_array_get(obj);
+  for (long i = 0; i < length; i++) {
+    read_color(rb_ary_entry(ary, i), color_array_at(data, i));
+  }
+  return obj;
+}
+
+static VALUE color_array_class_from_rgba8(VALUE klass, VALUE bytes) {
+  StringValue(bytes);
+  long size = RSTRING_LEN(bytes);
+  if (size % 4 != 0) {
+    rb_raise(rb_eArgError, "RGBA8 data size must be a multiple of 4 (%ld)",
+             size);
+  }
+
+  VALUE source = rb_str_new_frozen(bytes);
+  VALUE obj = color_array_build(klass, size / 4);
+  ColorArrayData *data = color_array_get(obj);
+  ColorArrayJob job = {NULL, NULL, NULL, 0, 0.0f, data->data, data->length,
+                       (const unsigned char *)RSTRING_PTR(source)};
+  color_array_run(from_rgba8_job, &job, Qnil, Qnil, obj);
+  RB_GC_GUARD(source);
+  return obj;
+}
+
+VALUE color_array_aref(VALUE self, VALUE index) {
+  ColorArrayData *data = color_array_get(self);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    return Qnil;
+  }
+  return color_new(color_array_at(data, idx));
+}
+
+VALUE color_array_aset(VALUE self, VALUE index, VALUE value) {
+  ColorArrayData *data = color_array_get(self);
+  packed_buffer_check_writable(self, data->buffer);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    rb_raise(rb_eIndexError, "index %ld out of range", NUM2LONG(index));
+  }
+  read_color(value, color_array_at(data, idx));
+  return value;
+}
+
+VALUE color_array_each(VALUE self) {
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, packed_array_length);
+  for (long i = 0; i < color_array_get(self)->length; i++) {
+    rb_yield(color_new(color_array_at(color_array_get(self), i)));
+  }
+  return self;
+}
+
+VALUE color_array_to_a(VALUE self) {
+  ColorArrayData *data = color_array_get(self);
+  VALUE ary = rb_ary_new_capa(data->length);
+  for (long i = 0; i < data->length; i++) {
+    rb_ary_push(ary, color_new(color_array_at(data, i)));
+  }
+  return ary;
+}
+
+VALUE color_array_add(int argc, VALUE *argv, VALUE self) {
+  return color_array_binary(argc, argv, self, 0, add_kernel);
+}
+
+VALUE color_array_multiply(int argc, VALUE *argv, VALUE self) {
+  return color_array_binary(argc, argv, self, 1, mul_kernel);
+}
+
+VALUE color_array_lerp(int argc, VALUE *argv, VALUE self) {
+  VALUE other = Qnil;
+  VALUE t = Qnil;
+  VALUE out = Qnil;
+  float scratch[4];
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "21", &other, &t, &out);
+  float s = (float)value_to_double(t);
+  ColorArrayData *a = color_array_get(self);
+  const float *b = color_array_operand(other, a->length, scratch, &stride, 0);
+  VALUE result = color_array_output(self, out, a->length);
+  ColorArrayJob job = {NULL, a->data, b, stride, s,
+                       color_array_get(result)->data, a->length};
+  color_array_run(lerp_job, &job, self, other, result);
+  return result;
+}
+
+VALUE color_array_clamp(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  ColorArrayData *a = color_array_get(self);
+  VALUE result = color_array_output(self, out, a->length);
+  ColorArrayJob job = {NULL, a->data, NULL, 0, 0.0f,
+                       color_array_get(result)->data, a->length};
+  color_array_run(clamp_job, &job, self, Qnil, result);
+  return result;
+}
+
+VALUE color_array_to_rgba8(VALUE self) {
+  ColorArrayData *a = color_array_get(self);
+  VALUE str = rb_str_new(NULL, a->length * 4);
+  ColorArrayJob job = {NULL, a->data, NULL, 0, 0.0f, RSTRING_PTR(str),
+                       a->length};
+  color_array_run(to_rgba8_job, &job, self, Qnil, Qnil);
+  return str;
+}
+
+VALUE color_array_equal(VALUE self, VALUE other) {
+  if (!rb_obj_is_kind_of(other, cColorArray)) {
+    return Qfalse;
+  }
+  ColorArrayData *a = color_array_get(self);
+  ColorArrayData *b = color_array_get(other);
+  if (a->length != b->length) {
+    return Qfalse;
+  }
+  const float *av = a->data;
+  const float *bv = b->data;
+  for (long i = 0; i < a->length * 4; i++) {
+    if (av[i] != bv[i]) {
+      return Qfalse;
+    }
+  }
+  return Qtrue;
+}
+
+VALUE color_array_inspect(VALUE self) {
+  ColorArrayData *a = color_array_get(self);
+  VALUE str = rb_str_new_cstr("ColorArray[");
+  for (long i = 0; i < a->length; i++) {
+    if (i > 0) {
+      rb_str_cat_cstr(str, ", ");
+    }
+    rb_str_concat(str, rb_inspect(color_new(color_array_at(a, i))));
+  }
+  rb_str_cat_cstr(str, "]");
+  return str;
+}
+
+void Init_color_array(VALUE module) {
+  cColorArray = rb_define_class_under(module, "ColorArray", rb_cObject);
+  rb_define_alloc_func(cColorArray, color_array_alloc);
+  packed_array_define(cColorArray, &color_array_class);
+
+  rb_define_singleton_method(cColorArray, "from", color_array_class_from, 1);
+  rb_define_singleton_method(cColorArray, "from_rgba8",
+                             color_array_class_from_rgba8, 1);
+
+  rb_define_method(cColorArray, "[]", color_array_aref, 1);
+  rb_define_method(cColorArray, "[]=", color_array_aset, 2);
+  rb_define_method(cColorArray, "each", color_array_each, 0);
+  rb_define_method(cColorArray, "to_a", color_array_to_a, 0);
+
+  rb_define_method(cColorArray, "add", color_array_add, -1);
+  rb_define_alias(cColorArray, "+", "add");
+  rb_define_method(cColorArray, "multiply", color_array_multiply, -1);
+  rb_define_alias(cColorArray, "*", "multiply");
+  rb_define_method(cColorArray, "lerp", color_array_lerp, -1);
+  rb_define_method(cColorArray, "clamp", color_array_clamp, -1);
+  rb_define_method(cColorArray, "to_rgba8", color_array_to_rgba8, 0);
+  rb_define_method(cColorArray, "==", color_array_equal, 1);
+  rb_define_method(cColorArray, "inspect", color_array_inspect, 0);
+  rb_define_alias(cColorArray, "to_s", "inspect");
+}
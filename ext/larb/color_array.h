@@ -0,0 +1,26 @@
+#ifndef COLOR_ARRAY_H
+#define COLOR_ARRAY_H
+
+#include "larb.h"
+#include "packed_buffer.h"
+
+typedef PackedArray ColorArrayData;
+
+void Init_color_array(VALUE module);
+VALUE color_array_alloc(VALUE klass);
+ColorArrayData *color_array_get(VALUE obj);
+VALUE color_array_build(VALUE klass, long length);
+
+VALUE color_array_aref(VALUE self, VALUE index);
+VALUE color_array_aset(VALUE self, VALUE index, VALUE value);
+VALUE color_array_each(VALUE self);
+VALUE color_array_to_a(VALUE self);
+VALUE color_array_add(int argc, VALUE *argv, VALUE self);
+VALUE color_array_multiply(int argc, VALUE *argv, VALUE self);
+VALUE color_array_lerp(int argc, VALUE *argv, VALUE self);
+VALUE color_array_clamp(int argc, VALUE *argv, VALUE self);
+VALUE color_array_to_rgba8(VALUE self);
+VALUE color_array_equal(VALUE self, VALUE other);
+VALUE color_array_inspect(VALUE self);
+
+#endif
@@ -0,0 +1,138 @@
+#include "cursor.h"
+
+#include <time.h>
+
+#include "thread_pool.h"
+
+static size_t cursor_memsize(const void *ptr) {
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(CursorData);
+}
+
+static const rb_data_type_t cursor_type = {
+    "Cursor",
+    {0, RUBY_TYPED_DEFAULT_FREE, cursor_memsize},
+    0,
+    0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        LARB_TYPED_EMBEDDABLE,
+};
+
+static VALUE cCursor = Qnil;
+
+static VALUE cursor_alloc(VALUE klass) {
+  CursorData *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, CursorData, &cursor_type, data);
+  data->elements = -1;
+  data->time = -1.0;
+  data->grain = THREAD_POOL_CHUNK;
+  return obj;
+}
+
+static CursorData *cursor_get(VALUE obj) {
+  CursorData *data = NULL;
+  TypedData_Get_Struct(obj, CursorData, &cursor_type, data);
+  return data;
+}
+
+static double cursor_clock(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static long cursor_count_option(VALUE value, const char *name) {
+  long count = NUM2LONG(value);
+  if (count < 1) {
+    rb_raise(rb_eArgError, "%s must be positive", name);
+  }
+  return count;
+}
+
+static VALUE cursor_initialize(int argc, VALUE *argv, VALUE self) {
+  VALUE length = Qnil;
+  VALUE opts = Qnil;
+  ID keys[3];
+  VALUE values[3];
+
+  rb_scan_args(argc, argv, "1:", &length, &opts);
+  CursorData *data = cursor_get(self);
+  data->length = NUM2LONG(length);
+  if (data->length < 0) {
+    rb_raise(rb_eArgError, "negative length");
+  }
+  if (NIL_P(opts)) {
+    return self;
+  }
+  keys[0] = rb_intern("elements");
+  keys[1] = rb_intern("time");
+  keys[2] = rb_intern("grain");
+  rb_get_kwargs(opts, keys, 0, 3, values);
+  if (values[0] != Qundef && !NIL_P(values[0])) {
+    data->elements = cursor_count_option(values[0], "elements");
+  }
+  if (values[1] != Qundef && !NIL_P(values[1])) {
+    data->time = value_to_double(values[1]);
+    if (!(data->time > 0.0)) {
+      rb_raise(rb_eArgError, "time must be positive");
+    }
+  }
+  if (values[2] != Qundef && !NIL_P(values[2])) {
+    data->grain = cursor_count_option(values[2], "grain");
+  }
+  return self;
+}
+
+static VALUE cursor_step(VALUE self) {
+  CursorData *data = cursor_get(self);
+  long budget = data->elements < 0 ? data->length : data->elements;
+  double deadline = data->time < 0.0 ? 0.0 : cursor_clock() + data->time;
+
+  rb_check_frozen(self);
+  rb_need_block();
+  while (budget > 0 && data->position < data->length) {
+    long count = data->length - data->position;
+    if (count > budget) {
+      count = budget;
+    }
+    if (data->time >= 0.0 && count > data->grain) {
+      count = data->grain;
+    }
+    rb_yield_values(2, LONG2NUM(data->position), LONG2NUM(count));
+    data->position += count;
+    budget -= count;
+    if (data->time >= 0.0 && cursor_clock() >= deadline) {
+      break;
+    }
+  }
+  return data->position >= data->length ? Qtrue : Qfalse;
+}
+
+static VALUE cursor_length(VALUE self) {
+  return LONG2NUM(cursor_get(self)->length);
+}
+
+static VALUE cursor_position(VALUE self) {
+  return LONG2NUM(cursor_get(self)->position);
+}
+
+static VALUE cursor_done_p(VALUE self) {
+  CursorData *data = cursor_get(self);
+  return data->position >= data->length ? Qtrue : Qfalse;
+}
+
+static VALUE cursor_rewind(VALUE self) {
+  rb_check_frozen(self);
+  cursor_get(self)->position = 0;
+  return self;
+}
+
+void Init_cursor(VALUE module) {
+  cCursor = rb_define_class_under(module, "Cursor", rb_cObject);
+  rb_define_alloc_func(cCursor, cursor_alloc);
+  rb_define_method(cCursor, "initialize", cursor_initialize, -1);
+  rb_define_method(cCursor, "step", cursor_step, 0);
+  rb_define_method(cCursor, "length", cursor_length, 0);
+  rb_define_method(cCursor, "position", cursor_position, 0);
+  rb_define_method(cCursor, "done?", cursor_done_p, 0);
+  rb_define_method(cCursor, "rewind", cursor_rewind, 0);
+}
@@ -0,0 +1,16 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "larb.h"
+
+typedef struct {
+  long length;
+  long position;
+  long elements;
+  double time;
+  long grain;
+} CursorData;
+
+void Init_cursor(VALUE module);
+
+#endif
@@ -5,7 +5,16 @@ require "mkmf"
 # mathライブラリの確認
 have_library("m", "sin")
 
-# 最適化フラグ
-$CFLAGS << " -O3 -march=native -ffast-math -funroll-loops"
+# 埋め込みTypedDataの確認 (Ruby 3.3+)
+have_const("RUBY_TYPED_EMBEDDABLE", "ruby.h")
+
+# ワーカースレッド用のpthreadの確認
+have_header("pthread.h")
+
+# 最適化フラグ (SIMDカーネルは実行時にCPUを判定して選択)
+$CFLAGS << " -O3 -ffast-math -funroll-loops"
+
+# ビルドしたマシン専用に最適化する場合は --enable-march-native
+$CFLAGS << " -march=native" if enable_config("march-native", false)
 
 create_makefile("larb/larb")
@@ -1,4 +1,7 @@
 #include "larb.h"
+
+#include <ruby/ractor.h>
+
 #include "vec2.h"
 #include "vec3.h"
 #include "vec4.h"
@@ -9,11 +12,44 @@
 #include "mat2d.h"
 #include "color.h"
 #include "quat2.h"
+#include "vec2_array.h"
+#include "vec3_array.h"
+#include "mat4_array.h"
+#include "quat_array.h"
+#include "color_array.h"
+#include "packed_buffer.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "task.h"
+#include "cursor.h"
 
 VALUE mLarb = Qnil;
 
+VALUE larb_define_constant(VALUE klass, const char *name, VALUE *slot,
+                           VALUE obj) {
+  *slot = rb_ractor_make_shareable(obj);
+  rb_gc_register_address(slot);
+  rb_define_const(klass, name, obj);
+  return obj;
+}
+
+void larb_check_main_ractor(const char *name) {
+  VALUE ractor = rb_path2class("Ractor");
+  if (rb_funcall(ractor, rb_intern("current"), 0) !=
+      rb_funcall(ractor, rb_intern("main"), 0)) {
+    rb_raise(rb_path2class("Ractor::IsolationError"),
+             "can not set %s from non-main Ractors", name);
+  }
+}
+
 void Init_larb(void) {
+  rb_ext_ractor_safe(true);
   mLarb = rb_define_module("Larb");
+  Init_packed_buffer(mLarb);
+  Init_simd(mLarb);
+  Init_thread_pool(mLarb);
+  Init_task(mLarb);
+  Init_cursor(mLarb);
   Init_vec2(mLarb);
   Init_vec3(mLarb);
   Init_vec4(mLarb);
@@ -24,4 +60,9 @@ void Init_larb(void) {
   Init_mat2d(mLarb);
   Init_color(mLarb);
   Init_quat2(mLarb);
+  Init_vec2_array(mLarb);
+  Init_vec3_array(mLarb);
+  Init_mat4_array(mLarb);
+  Init_quat_array(mLarb);
+  Init_color_array(mLarb);
 }
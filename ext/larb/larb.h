@@ -3,6 +3,29 @@
 
 #include <ruby.h>
 
+#ifdef HAVE_CONST_RUBY_TYPED_EMBEDDABLE
+#define LARB_TYPED_EMBEDDABLE RUBY_TYPED_EMBEDDABLE
+#else
+#define LARB_TYPED_EMBEDDABLE 0
+#endif
+
 extern VALUE mLarb;
 
+VALUE larb_define_constant(VALUE klass, const char *name, VALUE *slot,
+                           VALUE obj);
+void larb_check_main_ractor(const char *name);
+
+static inline double value_to_double(VALUE value) {
+  if (RB_FLOAT_TYPE_P(value)) {
+    return RFLOAT_VALUE(value);
+  }
+  if (RB_FIXNUM_P(value)) {
+    return (double)FIX2LONG(value);
+  }
+  if (RB_TYPE_P(value, T_BIGNUM)) {
+    return rb_big2dbl(value);
+  }
+  return NUM2DBL(rb_funcall(value, rb_intern("to_f"), 0));
+}
+
 #endif
@@ -2,38 +2,34 @@
 
 #include <math.h>
 
-static void mat2_free(void *ptr) {
-  xfree(ptr);
-}
+#include "packed_buffer.h"
+#include "vec2.h"
+#include "vec2_array.h"
 
 static size_t mat2_memsize(const void *ptr) {
-  return sizeof(Mat2Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Mat2Data);
 }
 
 static const rb_data_type_t mat2_type = {
     "Mat2",
-    {0, mat2_free, mat2_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, mat2_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cMat2 = Qnil;
-static VALUE cVec2 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cMat2 = Qnil;
+static VALUE mat2_const_identity = Qnil;
+static VALUE mat2_const_zero = Qnil;
 
-static Mat2Data *mat2_get(VALUE obj) {
+Mat2Data *mat2_get(VALUE obj) {
   Mat2Data *data = NULL;
   TypedData_Get_Struct(obj, Mat2Data, &mat2_type, data);
   return data;
 }
 
-static VALUE mat2_build(VALUE klass, double a0, double a1, double a2,
-                        double a3) {
+VALUE mat2_build(VALUE klass, double a0, double a1, double a2, double a3) {
   VALUE obj = mat2_alloc(klass);
   Mat2Data *data = mat2_get(obj);
   data->data[0] = a0;
@@ -44,15 +40,17 @@ static VALUE mat2_build(VALUE klass, double a0, double a1, double a2,
 }
 
 VALUE mat2_alloc(VALUE klass) {
-  Mat2Data *data = ALLOC(Mat2Data);
+  Mat2Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Mat2Data, &mat2_type, data);
   data->data[0] = 1.0;
   data->data[1] = 0.0;
   data->data[2] = 0.0;
   data->data[3] = 1.0;
-  return TypedData_Wrap_Struct(klass, &mat2_type, data);
+  return obj;
 }
 
 VALUE mat2_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE data_arg = Qnil;
   Mat2Data *data = mat2_get(self);
 
@@ -78,12 +76,27 @@ VALUE mat2_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE mat2_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *mat2_get(self) = *mat2_get(other);
+  return self;
+}
+
+static VALUE mat2_constant(VALUE klass, VALUE constant) {
+  if (klass == cMat2) {
+    return constant;
+  }
+  VALUE obj = mat2_alloc(klass);
+  *mat2_get(obj) = *mat2_get(constant);
+  return obj;
+}
+
 static VALUE mat2_class_identity(VALUE klass) {
-  return mat2_build(klass, 1.0, 0.0, 0.0, 1.0);
+  return mat2_constant(klass, mat2_const_identity);
 }
 
 static VALUE mat2_class_zero(VALUE klass) {
-  return mat2_build(klass, 0.0, 0.0, 0.0, 0.0);
+  return mat2_constant(klass, mat2_const_zero);
 }
 
 static VALUE mat2_class_rotation(VALUE klass, VALUE radians) {
@@ -98,11 +111,9 @@ static VALUE mat2_class_scaling(VALUE klass, VALUE x, VALUE y) {
 }
 
 static VALUE mat2_class_from_vec2(VALUE klass, VALUE v1, VALUE v2) {
-  double x1 = value_to_double(rb_funcall(v1, rb_intern("x"), 0));
-  double y1 = value_to_double(rb_funcall(v1, rb_intern("y"), 0));
-  double x2 = value_to_double(rb_funcall(v2, rb_intern("x"), 0));
-  double y2 = value_to_double(rb_funcall(v2, rb_intern("y"), 0));
-  return mat2_build(klass, x1, y1, x2, y2);
+  Vec2Data *a = vec2_get(v1);
+  Vec2Data *b = vec2_get(v2);
+  return mat2_build(klass, a->x, a->y, b->x, b->y);
 }
 
 VALUE mat2_aref(VALUE self, VALUE index) {
@@ -115,6 +126,7 @@ VALUE mat2_aref(VALUE self, VALUE index) {
 }
 
 VALUE mat2_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Mat2Data *data = mat2_get(self);
   long idx = NUM2LONG(index);
   if (idx < 0 || idx > 3) {
@@ -137,12 +149,9 @@ VALUE mat2_mul(VALUE self, VALUE other) {
   }
 
   if (rb_obj_is_kind_of(other, cVec2)) {
-    double x = value_to_double(rb_funcall(other, rb_intern("x"), 0));
-    double y = value_to_double(rb_funcall(other, rb_intern("y"), 0));
-    VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-    return rb_funcall(vec2_class, rb_intern("new"), 2,
-                      DBL2NUM(a->data[0] * x + a->data[2] * y),
-                      DBL2NUM(a->data[1] * x + a->data[3] * y));
+    Vec2Data *v = vec2_get(other);
+    return vec2_build(cVec2, a->data[0] * v->x + a->data[2] * v->y,
+                      a->data[1] * v->x + a->data[3] * v->y);
   }
 
   if (rb_obj_is_kind_of(other, rb_cNumeric)) {
@@ -154,6 +163,83 @@ VALUE mat2_mul(VALUE self, VALUE other) {
   return Qnil;
 }
 
+static void transform_kernel_f64(const double *m, const double *src,
+                                 double *dst, long n) {
+  for (long i = 0; i < n; i++) {
+    const double *p = src + i * 2;
+    double *o = dst + i * 2;
+    double x = m[0] * p[0] + m[2] * p[1];
+    double y = m[1] * p[0] + m[3] * p[1];
+    o[0] = x;
+    o[1] = y;
+  }
+}
+
+static void transform_kernel_f32(const double *matrix, const float *src,
+                                 float *dst, long n) {
+  float m[4];
+  for (int i = 0; i < 4; i++) {
+    m[i] = (float)matrix[i];
+  }
+  for (long i = 0; i < n; i++) {
+    const float *p = src + i * 2;
+    float *o = dst + i * 2;
+    float x = m[0] * p[0] + m[2] * p[1];
+    float y = m[1] * p[0] + m[3] * p[1];
+    o[0] = x;
+    o[1] = y;
+  }
+}
+
+typedef struct {
+  double m[4];
+  PackedType type;
+  const void *src;
+  void *dst;
+  long length;
+} TransformJob;
+
+static void transform_job(void *ptr, long begin, long end) {
+  TransformJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    transform_kernel_f32(job->m, (const float *)job->src + begin * 2,
+                         (float *)job->dst + begin * 2, end - begin);
+  } else {
+    transform_kernel_f64(job->m, (const double *)job->src + begin * 2,
+                         (double *)job->dst + begin * 2, end - begin);
+  }
+}
+
+VALUE mat2_transform_points(int argc, VALUE *argv, VALUE self) {
+  VALUE points = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &points, &out);
+  Mat2Data *a = mat2_get(self);
+  Vec2ArrayData *src = vec2_array_get(points);
+  if (NIL_P(out)) {
+    out = vec2_array_build(rb_obj_class(points), src->length, src->type);
+  }
+  Vec2ArrayData *dst = vec2_array_get(out);
+  if (dst->length != src->length) {
+    rb_raise(rb_eArgError, "length mismatch (%ld for %ld)", dst->length,
+             src->length);
+  }
+  packed_type_check(src->type, dst->type);
+  packed_buffer_check_writable(out, dst->buffer);
+
+  TransformJob job = {{0}, src->type, src->data, dst->data, src->length};
+  for (int i = 0; i < 4; i++) {
+    job.m[i] = a->data[i];
+  }
+  size_t size = (size_t)src->length * 2 * packed_type_size(src->type);
+  packed_check_overlap(src->data, size, dst->data, size);
+  PackedPin pins[2] = {packed_pin(points, src->buffer, &src->locks),
+                       packed_pin(out, dst->buffer, &dst->locks)};
+  packed_run(job.length, transform_job, &job, pins, 2);
+  return out;
+}
+
 VALUE mat2_add(VALUE self, VALUE other) {
   Mat2Data *a = mat2_get(self);
   Mat2Data *b = mat2_get(other);
@@ -270,13 +356,14 @@ VALUE mat2_inspect(VALUE self) {
 
 void Init_mat2(VALUE module) {
   cMat2 = rb_define_class_under(module, "Mat2", rb_cObject);
-  cVec2 = rb_const_get(mLarb, rb_intern("Vec2"));
 
   rb_define_alloc_func(cMat2, mat2_alloc);
   rb_define_method(cMat2, "initialize", mat2_initialize, -1);
+  rb_define_method(cMat2, "initialize_copy", mat2_initialize_copy, 1);
 
   rb_define_singleton_method(cMat2, "identity", mat2_class_identity, 0);
   rb_define_singleton_method(cMat2, "zero", mat2_class_zero, 0);
+
   rb_define_singleton_method(cMat2, "rotation", mat2_class_rotation, 1);
   rb_define_singleton_method(cMat2, "scaling", mat2_class_scaling, 2);
   rb_define_singleton_method(cMat2, "from_vec2", mat2_class_from_vec2, 2);
@@ -285,6 +372,7 @@ void Init_mat2(VALUE module) {
   rb_define_method(cMat2, "[]", mat2_aref, 1);
   rb_define_method(cMat2, "[]=", mat2_aset, 2);
   rb_define_method(cMat2, "*", mat2_mul, 1);
+  rb_define_method(cMat2, "transform_points", mat2_transform_points, -1);
   rb_define_method(cMat2, "+", mat2_add, 1);
   rb_define_method(cMat2, "-", mat2_sub, 1);
   rb_define_method(cMat2, "determinant", mat2_determinant, 0);
@@ -297,4 +385,9 @@ void Init_mat2(VALUE module) {
   rb_define_method(cMat2, "near?", mat2_near, -1);
   rb_define_method(cMat2, "inspect", mat2_inspect, 0);
   rb_define_alias(cMat2, "to_s", "inspect");
+
+  larb_define_constant(cMat2, "IDENTITY", &mat2_const_identity,
+                       mat2_build(cMat2, 1.0, 0.0, 0.0, 1.0));
+  larb_define_constant(cMat2, "ZERO", &mat2_const_zero,
+                       mat2_build(cMat2, 0.0, 0.0, 0.0, 0.0));
 }
@@ -7,13 +7,18 @@ typedef struct {
   double data[4];
 } Mat2Data;
 
+extern VALUE cMat2;
+
 void Init_mat2(VALUE module);
 VALUE mat2_alloc(VALUE klass);
 VALUE mat2_initialize(int argc, VALUE *argv, VALUE self);
+Mat2Data *mat2_get(VALUE obj);
+VALUE mat2_build(VALUE klass, double a0, double a1, double a2, double a3);
 
 VALUE mat2_aref(VALUE self, VALUE index);
 VALUE mat2_aset(VALUE self, VALUE index, VALUE value);
 VALUE mat2_mul(VALUE self, VALUE other);
+VALUE mat2_transform_points(int argc, VALUE *argv, VALUE self);
 VALUE mat2_add(VALUE self, VALUE other);
 VALUE mat2_sub(VALUE self, VALUE other);
 VALUE mat2_determinant(VALUE self);
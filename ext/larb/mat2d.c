@@ -2,38 +2,35 @@
 
 #include <math.h>
 
-static void mat2d_free(void *ptr) {
-  xfree(ptr);
-}
+#include "mat3.h"
+#include "packed_buffer.h"
+#include "vec2.h"
+#include "vec2_array.h"
 
 static size_t mat2d_memsize(const void *ptr) {
-  return sizeof(Mat2dData);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Mat2dData);
 }
 
 static const rb_data_type_t mat2d_type = {
     "Mat2d",
-    {0, mat2d_free, mat2d_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, mat2d_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cMat2d = Qnil;
-static VALUE cVec2 = Qnil;
-static VALUE cMat3 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cMat2d = Qnil;
+static VALUE mat2d_const_identity = Qnil;
+static VALUE mat2d_const_zero = Qnil;
 
-static Mat2dData *mat2d_get(VALUE obj) {
+Mat2dData *mat2d_get(VALUE obj) {
   Mat2dData *data = NULL;
   TypedData_Get_Struct(obj, Mat2dData, &mat2d_type, data);
   return data;
 }
 
-static VALUE mat2d_build(VALUE klass, const double *values) {
+VALUE mat2d_build(VALUE klass, const double *values) {
   VALUE obj = mat2d_alloc(klass);
   Mat2dData *data = mat2d_get(obj);
   for (int i = 0; i < 6; i++) {
@@ -48,18 +45,61 @@ static VALUE mat2d_build6(VALUE klass, double v0, double v1, double v2,
   return mat2d_build(klass, values);
 }
 
+static void mat2d_multiply_values(const double *a, const double *b,
+                                  double *out) {
+  double result[6];
+  result[0] = a[0] * b[0] + a[2] * b[1];
+  result[1] = a[1] * b[0] + a[3] * b[1];
+  result[2] = a[0] * b[2] + a[2] * b[3];
+  result[3] = a[1] * b[2] + a[3] * b[3];
+  result[4] = a[0] * b[4] + a[2] * b[5] + a[4];
+  result[5] = a[1] * b[4] + a[3] * b[5] + a[5];
+  for (int i = 0; i < 6; i++) {
+    out[i] = result[i];
+  }
+}
+
+static int mat2d_invert_values(const double *m, double *out) {
+  double det = m[0] * m[3] - m[1] * m[2];
+  if (fabs(det) < 1e-10) {
+    return 0;
+  }
+  double inv_det = 1.0 / det;
+  double result[6];
+  result[0] = m[3] * inv_det;
+  result[1] = -m[1] * inv_det;
+  result[2] = -m[2] * inv_det;
+  result[3] = m[0] * inv_det;
+  result[4] = (m[2] * m[5] - m[3] * m[4]) * inv_det;
+  result[5] = (m[1] * m[4] - m[0] * m[5]) * inv_det;
+  for (int i = 0; i < 6; i++) {
+    out[i] = result[i];
+  }
+  return 1;
+}
+
+static Mat2dData *mat2d_output(VALUE klass, VALUE *out) {
+  if (NIL_P(*out)) {
+    *out = mat2d_alloc(klass);
+  }
+  rb_check_frozen(*out);
+  return mat2d_get(*out);
+}
+
 VALUE mat2d_alloc(VALUE klass) {
-  Mat2dData *data = ALLOC(Mat2dData);
+  Mat2dData *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Mat2dData, &mat2d_type, data);
   data->data[0] = 1.0;
   data->data[1] = 0.0;
   data->data[2] = 0.0;
   data->data[3] = 1.0;
   data->data[4] = 0.0;
   data->data[5] = 0.0;
-  return TypedData_Wrap_Struct(klass, &mat2d_type, data);
+  return obj;
 }
 
 VALUE mat2d_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE data_arg = Qnil;
   Mat2dData *data = mat2d_get(self);
 
@@ -86,12 +126,27 @@ VALUE mat2d_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE mat2d_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *mat2d_get(self) = *mat2d_get(other);
+  return self;
+}
+
+static VALUE mat2d_constant(VALUE klass, VALUE constant) {
+  if (klass == cMat2d) {
+    return constant;
+  }
+  VALUE obj = mat2d_alloc(klass);
+  *mat2d_get(obj) = *mat2d_get(constant);
+  return obj;
+}
+
 static VALUE mat2d_class_identity(VALUE klass) {
-  return mat2d_alloc(klass);
+  return mat2d_constant(klass, mat2d_const_identity);
 }
 
 static VALUE mat2d_class_zero(VALUE klass) {
-  return mat2d_build6(klass, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  return mat2d_constant(klass, mat2d_const_zero);
 }
 
 static VALUE mat2d_class_translation(VALUE klass, VALUE x, VALUE y) {
@@ -118,12 +173,11 @@ static VALUE mat2d_class_from_rotation_translation_scale(VALUE klass,
   double r = value_to_double(rotation);
   double c = cos(r);
   double s = sin(r);
-  double sx = value_to_double(rb_funcall(scale, rb_intern("x"), 0));
-  double sy = value_to_double(rb_funcall(scale, rb_intern("y"), 0));
-  double tx = value_to_double(rb_funcall(translation, rb_intern("x"), 0));
-  double ty = value_to_double(rb_funcall(translation, rb_intern("y"), 0));
+  Vec2Data *sv = vec2_get(scale);
+  Vec2Data *tv = vec2_get(translation);
 
-  return mat2d_build6(klass, c * sx, s * sx, -s * sy, c * sy, tx, ty);
+  return mat2d_build6(klass, c * sv->x, s * sv->x, -s * sv->y, c * sv->y,
+                      tv->x, tv->y);
 }
 
 VALUE mat2d_aref(VALUE self, VALUE index) {
@@ -136,6 +190,7 @@ VALUE mat2d_aref(VALUE self, VALUE index) {
 }
 
 VALUE mat2d_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Mat2dData *data = mat2d_get(self);
   long idx = NUM2LONG(index);
   if (idx < 0 || idx > 5) {
@@ -150,23 +205,15 @@ VALUE mat2d_mul(VALUE self, VALUE other) {
 
   if (rb_obj_is_kind_of(other, cMat2d)) {
     Mat2dData *b = mat2d_get(other);
-    return mat2d_build6(
-        rb_obj_class(self),
-        a->data[0] * b->data[0] + a->data[2] * b->data[1],
-        a->data[1] * b->data[0] + a->data[3] * b->data[1],
-        a->data[0] * b->data[2] + a->data[2] * b->data[3],
-        a->data[1] * b->data[2] + a->data[3] * b->data[3],
-        a->data[0] * b->data[4] + a->data[2] * b->data[5] + a->data[4],
-        a->data[1] * b->data[4] + a->data[3] * b->data[5] + a->data[5]);
+    double result[6];
+    mat2d_multiply_values(a->data, b->data, result);
+    return mat2d_build(rb_obj_class(self), result);
   }
 
   if (rb_obj_is_kind_of(other, cVec2)) {
-    double x = value_to_double(rb_funcall(other, rb_intern("x"), 0));
-    double y = value_to_double(rb_funcall(other, rb_intern("y"), 0));
-    VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-    return rb_funcall(vec2_class, rb_intern("new"), 2,
-                      DBL2NUM(a->data[0] * x + a->data[2] * y + a->data[4]),
-                      DBL2NUM(a->data[1] * x + a->data[3] * y + a->data[5]));
+    Vec2Data *v = vec2_get(other);
+    return vec2_build(cVec2, a->data[0] * v->x + a->data[2] * v->y + a->data[4],
+                      a->data[1] * v->x + a->data[3] * v->y + a->data[5]);
   }
 
   if (rb_obj_is_kind_of(other, rb_cNumeric)) {
@@ -179,6 +226,83 @@ VALUE mat2d_mul(VALUE self, VALUE other) {
   return Qnil;
 }
 
+static void transform_kernel_f64(const double *m, const double *src,
+                                 double *dst, long n) {
+  for (long i = 0; i < n; i++) {
+    const double *p = src + i * 2;
+    double *o = dst + i * 2;
+    double x = m[0] * p[0] + m[2] * p[1] + m[4];
+    double y = m[1] * p[0] + m[3] * p[1] + m[5];
+    o[0] = x;
+    o[1] = y;
+  }
+}
+
+static void transform_kernel_f32(const double *matrix, const float *src,
+                                 float *dst, long n) {
+  float m[6];
+  for (int i = 0; i < 6; i++) {
+    m[i] = (float)matrix[i];
+  }
+  for (long i = 0; i < n; i++) {
+    const float *p = src + i * 2;
+    float *o = dst + i * 2;
+    float x = m[0] * p[0] + m[2] * p[1] + m[4];
+    float y = m[1] * p[0] + m[3] * p[1] + m[5];
+    o[0] = x;
+    o[1] = y;
+  }
+}
+
+typedef struct {
+  double m[6];
+  PackedType type;
+  const void *src;
+  void *dst;
+  long length;
+} TransformJob;
+
+static void transform_job(void *ptr, long begin, long end) {
+  TransformJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    transform_kernel_f32(job->m, (const float *)job->src + begin * 2,
+                         (float *)job->dst + begin * 2, end - begin);
+  } else {
+    transform_kernel_f64(job->m, (const double *)job->src + begin * 2,
+                         (double *)job->dst + begin * 2, end - begin);
+  }
+}
+
+VALUE mat2d_transform_points(int argc, VALUE *argv, VALUE self) {
+  VALUE points = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &points, &out);
+  Mat2dData *a = mat2d_get(self);
+  Vec2ArrayData *src = vec2_array_get(points);
+  if (NIL_P(out)) {
+    out = vec2_array_build(rb_obj_class(points), src->length, src->type);
+  }
+  Vec2ArrayData *dst = vec2_array_get(out);
+  if (dst->length != src->length) {
+    rb_raise(rb_eArgError, "length mismatch (%ld for %ld)", dst->length,
+             src->length);
+  }
+  packed_type_check(src->type, dst->type);
+  packed_buffer_check_writable(out, dst->buffer);
+
+  TransformJob job = {{0}, src->type, src->data, dst->data, src->length};
+  for (int i = 0; i < 6; i++) {
+    job.m[i] = a->data[i];
+  }
+  size_t size = (size_t)src->length * 2 * packed_type_size(src->type);
+  packed_check_overlap(src->data, size, dst->data, size);
+  PackedPin pins[2] = {packed_pin(points, src->buffer, &src->locks),
+                       packed_pin(out, dst->buffer, &dst->locks)};
+  packed_run(job.length, transform_job, &job, pins, 2);
+  return out;
+}
+
 VALUE mat2d_add(VALUE self, VALUE other) {
   Mat2dData *a = mat2d_get(self);
   Mat2dData *b = mat2d_get(other);
@@ -202,20 +326,35 @@ VALUE mat2d_determinant(VALUE self) {
   return DBL2NUM(a->data[0] * a->data[3] - a->data[1] * a->data[2]);
 }
 
+static VALUE mat2d_class_multiply(int argc, VALUE *argv, VALUE klass) {
+  VALUE a = Qnil;
+  VALUE b = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "21", &a, &b, &out);
+  Mat2dData *ad = mat2d_get(a);
+  Mat2dData *bd = mat2d_get(b);
+  Mat2dData *dst = mat2d_output(klass, &out);
+  mat2d_multiply_values(ad->data, bd->data, dst->data);
+  return out;
+}
+
 VALUE mat2d_inverse(VALUE self) {
   Mat2dData *a = mat2d_get(self);
-  double det = a->data[0] * a->data[3] - a->data[1] * a->data[2];
-  if (fabs(det) < 1e-10) {
+  double inv[6];
+  if (!mat2d_invert_values(a->data, inv)) {
     rb_raise(rb_eRuntimeError, "Matrix is not invertible");
   }
-  double inv_det = 1.0 / det;
-  return mat2d_build6(rb_obj_class(self), a->data[3] * inv_det,
-                      -a->data[1] * inv_det, -a->data[2] * inv_det,
-                      a->data[0] * inv_det,
-                      (a->data[2] * a->data[5] - a->data[3] * a->data[4]) *
-                          inv_det,
-                      (a->data[1] * a->data[4] - a->data[0] * a->data[5]) *
-                          inv_det);
+  return mat2d_build(rb_obj_class(self), inv);
+}
+
+VALUE mat2d_invert_into(VALUE self, VALUE out) {
+  Mat2dData *a = mat2d_get(self);
+  Mat2dData *dst = mat2d_output(rb_obj_class(self), &out);
+  if (!mat2d_invert_values(a->data, dst->data)) {
+    rb_raise(rb_eRuntimeError, "Matrix is not invertible");
+  }
+  return out;
 }
 
 VALUE mat2d_translate(VALUE self, VALUE x, VALUE y) {
@@ -242,9 +381,7 @@ VALUE mat2d_scale(VALUE self, VALUE x, VALUE y) {
 
 VALUE mat2d_extract_translation(VALUE self) {
   Mat2dData *a = mat2d_get(self);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(a->data[4]),
-                    DBL2NUM(a->data[5]));
+  return vec2_build(cVec2, a->data[4], a->data[5]);
 }
 
 VALUE mat2d_extract_rotation(VALUE self) {
@@ -256,8 +393,7 @@ VALUE mat2d_extract_scale(VALUE self) {
   Mat2dData *a = mat2d_get(self);
   double sx = sqrt(a->data[0] * a->data[0] + a->data[1] * a->data[1]);
   double sy = sqrt(a->data[2] * a->data[2] + a->data[3] * a->data[3]);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(sx), DBL2NUM(sy));
+  return vec2_build(cVec2, sx, sy);
 }
 
 VALUE mat2d_frobenius_norm(VALUE self) {
@@ -271,13 +407,9 @@ VALUE mat2d_frobenius_norm(VALUE self) {
 
 VALUE mat2d_to_mat3(VALUE self) {
   Mat2dData *a = mat2d_get(self);
-  VALUE mat3_class = rb_const_get(mLarb, rb_intern("Mat3"));
-  return rb_funcall(mat3_class, rb_intern("new"), 1,
-                    rb_ary_new3(9, DBL2NUM(a->data[0]), DBL2NUM(a->data[1]),
-                                DBL2NUM(0.0), DBL2NUM(a->data[2]),
-                                DBL2NUM(a->data[3]), DBL2NUM(0.0),
-                                DBL2NUM(a->data[4]), DBL2NUM(a->data[5]),
-                                DBL2NUM(1.0)));
+  double values[9] = {a->data[0], a->data[1], 0.0, a->data[2], a->data[3],
+                      0.0, a->data[4], a->data[5], 1.0};
+  return mat3_build(cMat3, values);
 }
 
 VALUE mat2d_to_a(VALUE self) {
@@ -341,29 +473,32 @@ VALUE mat2d_inspect(VALUE self) {
 
 void Init_mat2d(VALUE module) {
   cMat2d = rb_define_class_under(module, "Mat2d", rb_cObject);
-  cVec2 = rb_const_get(mLarb, rb_intern("Vec2"));
-  cMat3 = rb_const_get(mLarb, rb_intern("Mat3"));
 
   rb_define_alloc_func(cMat2d, mat2d_alloc);
   rb_define_method(cMat2d, "initialize", mat2d_initialize, -1);
+  rb_define_method(cMat2d, "initialize_copy", mat2d_initialize_copy, 1);
 
   rb_define_singleton_method(cMat2d, "identity", mat2d_class_identity, 0);
   rb_define_singleton_method(cMat2d, "zero", mat2d_class_zero, 0);
+
   rb_define_singleton_method(cMat2d, "translation", mat2d_class_translation,
                              2);
   rb_define_singleton_method(cMat2d, "rotation", mat2d_class_rotation, 1);
   rb_define_singleton_method(cMat2d, "scaling", mat2d_class_scaling, 2);
   rb_define_singleton_method(cMat2d, "from_rotation_translation_scale",
                              mat2d_class_from_rotation_translation_scale, 3);
+  rb_define_singleton_method(cMat2d, "multiply", mat2d_class_multiply, -1);
 
   rb_define_method(cMat2d, "data", mat2d_data, 0);
   rb_define_method(cMat2d, "[]", mat2d_aref, 1);
   rb_define_method(cMat2d, "[]=", mat2d_aset, 2);
   rb_define_method(cMat2d, "*", mat2d_mul, 1);
+  rb_define_method(cMat2d, "transform_points", mat2d_transform_points, -1);
   rb_define_method(cMat2d, "+", mat2d_add, 1);
   rb_define_method(cMat2d, "-", mat2d_sub, 1);
   rb_define_method(cMat2d, "determinant", mat2d_determinant, 0);
   rb_define_method(cMat2d, "inverse", mat2d_inverse, 0);
+  rb_define_method(cMat2d, "invert_into", mat2d_invert_into, 1);
   rb_define_method(cMat2d, "translate", mat2d_translate, 2);
   rb_define_method(cMat2d, "rotate", mat2d_rotate, 1);
   rb_define_method(cMat2d, "scale", mat2d_scale, 2);
@@ -377,4 +512,9 @@ void Init_mat2d(VALUE module) {
   rb_define_method(cMat2d, "near?", mat2d_near, -1);
   rb_define_method(cMat2d, "inspect", mat2d_inspect, 0);
   rb_define_alias(cMat2d, "to_s", "inspect");
+
+  larb_define_constant(cMat2d, "IDENTITY", &mat2d_const_identity,
+                       mat2d_alloc(cMat2d));
+  larb_define_constant(cMat2d, "ZERO", &mat2d_const_zero,
+                       mat2d_build6(cMat2d, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0));
 }
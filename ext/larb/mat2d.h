@@ -7,17 +7,23 @@ typedef struct {
   double data[6];
 } Mat2dData;
 
+extern VALUE cMat2d;
+
 void Init_mat2d(VALUE module);
 VALUE mat2d_alloc(VALUE klass);
 VALUE mat2d_initialize(int argc, VALUE *argv, VALUE self);
+Mat2dData *mat2d_get(VALUE obj);
+VALUE mat2d_build(VALUE klass, const double *values);
 
 VALUE mat2d_aref(VALUE self, VALUE index);
 VALUE mat2d_aset(VALUE self, VALUE index, VALUE value);
 VALUE mat2d_mul(VALUE self, VALUE other);
+VALUE mat2d_transform_points(int argc, VALUE *argv, VALUE self);
 VALUE mat2d_add(VALUE self, VALUE other);
 VALUE mat2d_sub(VALUE self, VALUE other);
 VALUE mat2d_determinant(VALUE self);
 VALUE mat2d_inverse(VALUE self);
+VALUE mat2d_invert_into(VALUE self, VALUE out);
 VALUE mat2d_translate(VALUE self, VALUE x, VALUE y);
 VALUE mat2d_rotate(VALUE self, VALUE radians);
 VALUE mat2d_scale(VALUE self, VALUE x, VALUE y);
@@ -2,37 +2,38 @@
 
 #include <math.h>
 
-static void mat3_free(void *ptr) {
-  xfree(ptr);
-}
+#include "mat2d.h"
+#include "mat4.h"
+#include "quat.h"
+#include "vec3.h"
+#include "view.h"
 
 static size_t mat3_memsize(const void *ptr) {
-  return sizeof(Mat3Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Mat3Data);
 }
 
 static const rb_data_type_t mat3_type = {
     "Mat3",
-    {0, mat3_free, mat3_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, mat3_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cMat3 = Qnil;
-static VALUE cVec3 = Qnil;
+static const ViewLayout mat3_layout = {"d", 8, 72, 2, {3, 3}, {8, 24}};
 
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cMat3 = Qnil;
+static VALUE mat3_const_identity = Qnil;
+static VALUE mat3_const_zero = Qnil;
 
-static Mat3Data *mat3_get(VALUE obj) {
+Mat3Data *mat3_get(VALUE obj) {
   Mat3Data *data = NULL;
   TypedData_Get_Struct(obj, Mat3Data, &mat3_type, data);
   return data;
 }
 
-static VALUE mat3_build(VALUE klass, const double *values) {
+VALUE mat3_build(VALUE klass, const double *values) {
   VALUE obj = mat3_alloc(klass);
   Mat3Data *data = mat3_get(obj);
   for (int i = 0; i < 9; i++) {
@@ -48,8 +49,58 @@ static VALUE mat3_build9(VALUE klass, double v0, double v1, double v2,
   return mat3_build(klass, values);
 }
 
+static void mat3_multiply_values(const double *a, const double *b,
+                                 double *out) {
+  double result[9];
+  result[0] = a[0] * b[0] + a[3] * b[1] + a[6] * b[2];
+  result[1] = a[1] * b[0] + a[4] * b[1] + a[7] * b[2];
+  result[2] = a[2] * b[0] + a[5] * b[1] + a[8] * b[2];
+  result[3] = a[0] * b[3] + a[3] * b[4] + a[6] * b[5];
+  result[4] = a[1] * b[3] + a[4] * b[4] + a[7] * b[5];
+  result[5] = a[2] * b[3] + a[5] * b[4] + a[8] * b[5];
+  result[6] = a[0] * b[6] + a[3] * b[7] + a[6] * b[8];
+  result[7] = a[1] * b[6] + a[4] * b[7] + a[7] * b[8];
+  result[8] = a[2] * b[6] + a[5] * b[7] + a[8] * b[8];
+  for (int i = 0; i < 9; i++) {
+    out[i] = result[i];
+  }
+}
+
+static int mat3_invert_values(const double *m, double *out) {
+  double det = m[0] * (m[4] * m[8] - m[5] * m[7]) -
+               m[3] * (m[1] * m[8] - m[2] * m[7]) +
+               m[6] * (m[1] * m[5] - m[2] * m[4]);
+  if (fabs(det) < 1e-10) {
+    return 0;
+  }
+  double inv_det = 1.0 / det;
+  double result[9];
+  result[0] = (m[4] * m[8] - m[5] * m[7]) * inv_det;
+  result[1] = (m[2] * m[7] - m[1] * m[8]) * inv_det;
+  result[2] = (m[1] * m[5] - m[2] * m[4]) * inv_det;
+  result[3] = (m[5] * m[6] - m[3] * m[8]) * inv_det;
+  result[4] = (m[0] * m[8] - m[2] * m[6]) * inv_det;
+  result[5] = (m[2] * m[3] - m[0] * m[5]) * inv_det;
+  result[6] = (m[3] * m[7] - m[4] * m[6]) * inv_det;
+  result[7] = (m[1] * m[6] - m[0] * m[7]) * inv_det;
+  result[8] = (m[0] * m[4] - m[1] * m[3]) * inv_det;
+  for (int i = 0; i < 9; i++) {
+    out[i] = result[i];
+  }
+  return 1;
+}
+
+static Mat3Data *mat3_output(VALUE klass, VALUE *out) {
+  if (NIL_P(*out)) {
+    *out = mat3_alloc(klass);
+  }
+  rb_check_frozen(*out);
+  return mat3_get(*out);
+}
+
 VALUE mat3_alloc(VALUE klass) {
-  Mat3Data *data = ALLOC(Mat3Data);
+  Mat3Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Mat3Data, &mat3_type, data);
   data->data[0] = 1.0;
   data->data[1] = 0.0;
   data->data[2] = 0.0;
@@ -59,10 +110,11 @@ VALUE mat3_alloc(VALUE klass) {
   data->data[6] = 0.0;
   data->data[7] = 0.0;
   data->data[8] = 1.0;
-  return TypedData_Wrap_Struct(klass, &mat3_type, data);
+  return obj;
 }
 
 VALUE mat3_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE data_arg = Qnil;
   Mat3Data *data = mat3_get(self);
 
@@ -92,47 +144,60 @@ VALUE mat3_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE mat3_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *mat3_get(self) = *mat3_get(other);
+  return self;
+}
+
+static VALUE mat3_constant(VALUE klass, VALUE constant) {
+  if (klass == cMat3) {
+    return constant;
+  }
+  VALUE obj = mat3_alloc(klass);
+  *mat3_get(obj) = *mat3_get(constant);
+  return obj;
+}
+
 static VALUE mat3_class_identity(VALUE klass) {
-  return mat3_alloc(klass);
+  return mat3_constant(klass, mat3_const_identity);
 }
 
 static VALUE mat3_class_zero(VALUE klass) {
-  return mat3_build9(klass, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  return mat3_constant(klass, mat3_const_zero);
+}
+
+static void mat3_values_from_mat4(const double *m, double *out) {
+  out[0] = m[0];
+  out[1] = m[1];
+  out[2] = m[2];
+  out[3] = m[4];
+  out[4] = m[5];
+  out[5] = m[6];
+  out[6] = m[8];
+  out[7] = m[9];
+  out[8] = m[10];
 }
 
 static VALUE mat3_class_from_mat4(VALUE klass, VALUE mat4) {
   double values[9];
-  values[0] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(0)));
-  values[1] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(1)));
-  values[2] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(2)));
-  values[3] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(4)));
-  values[4] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(5)));
-  values[5] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(6)));
-  values[6] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(8)));
-  values[7] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(9)));
-  values[8] = value_to_double(rb_funcall(mat4, rb_intern("[]"), 1, INT2NUM(10)));
+  mat3_values_from_mat4(mat4_get(mat4)->data, values);
   return mat3_build(klass, values);
 }
 
 static VALUE mat3_class_from_mat2d(VALUE klass, VALUE mat2d) {
-  double values[9];
-  values[0] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(0)));
-  values[1] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(1)));
-  values[2] = 0.0;
-  values[3] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(2)));
-  values[4] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(3)));
-  values[5] = 0.0;
-  values[6] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(4)));
-  values[7] = value_to_double(rb_funcall(mat2d, rb_intern("[]"), 1, INT2NUM(5)));
-  values[8] = 1.0;
+  Mat2dData *m = mat2d_get(mat2d);
+  double values[9] = {m->data[0], m->data[1], 0.0, m->data[2], m->data[3],
+                      0.0, m->data[4], m->data[5], 1.0};
   return mat3_build(klass, values);
 }
 
 static VALUE mat3_class_from_quaternion(VALUE klass, VALUE quat) {
-  double x = value_to_double(rb_funcall(quat, rb_intern("x"), 0));
-  double y = value_to_double(rb_funcall(quat, rb_intern("y"), 0));
-  double z = value_to_double(rb_funcall(quat, rb_intern("z"), 0));
-  double w = value_to_double(rb_funcall(quat, rb_intern("w"), 0));
+  QuatData *q = quat_get(quat);
+  double x = q->x;
+  double y = q->y;
+  double z = q->z;
+  double w = q->w;
   double x2 = x + x;
   double y2 = y + y;
   double z2 = z + z;
@@ -152,9 +217,14 @@ static VALUE mat3_class_from_quaternion(VALUE klass, VALUE quat) {
 }
 
 static VALUE mat3_class_normal_from_mat4(VALUE klass, VALUE mat4) {
-  VALUE m3 = mat3_class_from_mat4(klass, mat4);
-  VALUE inv = rb_funcall(m3, rb_intern("inverse"), 0);
-  return rb_funcall(inv, rb_intern("transpose"), 0);
+  double m[9];
+  double inv[9];
+  mat3_values_from_mat4(mat4_get(mat4)->data, m);
+  if (!mat3_invert_values(m, inv)) {
+    rb_raise(rb_eRuntimeError, "Matrix is not invertible");
+  }
+  return mat3_build9(klass, inv[0], inv[3], inv[6], inv[1], inv[4], inv[7],
+                     inv[2], inv[5], inv[8]);
 }
 
 static VALUE mat3_class_projection(VALUE klass, VALUE width, VALUE height) {
@@ -191,6 +261,7 @@ VALUE mat3_aref(VALUE self, VALUE index) {
 }
 
 VALUE mat3_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Mat3Data *data = mat3_get(self);
   long idx = NUM2LONG(index);
   if (idx < 0 || idx > 8) {
@@ -205,40 +276,17 @@ VALUE mat3_mul(VALUE self, VALUE other) {
 
   if (rb_obj_is_kind_of(other, cMat3)) {
     Mat3Data *b = mat3_get(other);
-    return mat3_build9(
-        rb_obj_class(self),
-        a->data[0] * b->data[0] + a->data[3] * b->data[1] +
-            a->data[6] * b->data[2],
-        a->data[1] * b->data[0] + a->data[4] * b->data[1] +
-            a->data[7] * b->data[2],
-        a->data[2] * b->data[0] + a->data[5] * b->data[1] +
-            a->data[8] * b->data[2],
-        a->data[0] * b->data[3] + a->data[3] * b->data[4] +
-            a->data[6] * b->data[5],
-        a->data[1] * b->data[3] + a->data[4] * b->data[4] +
-            a->data[7] * b->data[5],
-        a->data[2] * b->data[3] + a->data[5] * b->data[4] +
-            a->data[8] * b->data[5],
-        a->data[0] * b->data[6] + a->data[3] * b->data[7] +
-            a->data[6] * b->data[8],
-        a->data[1] * b->data[6] + a->data[4] * b->data[7] +
-            a->data[7] * b->data[8],
-        a->data[2] * b->data[6] + a->data[5] * b->data[7] +
-            a->data[8] * b->data[8]);
+    double result[9];
+    mat3_multiply_values(a->data, b->data, result);
+    return mat3_build(rb_obj_class(self), result);
   }
 
   if (rb_obj_is_kind_of(other, cVec3)) {
-    double x = value_to_double(rb_funcall(other, rb_intern("x"), 0));
-    double y = value_to_double(rb_funcall(other, rb_intern("y"), 0));
-    double z = value_to_double(rb_funcall(other, rb_intern("z"), 0));
-    VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
-    return rb_funcall(vec3_class, rb_intern("new"), 3,
-                      DBL2NUM(a->data[0] * x + a->data[3] * y +
-                              a->data[6] * z),
-                      DBL2NUM(a->data[1] * x + a->data[4] * y +
-                              a->data[7] * z),
-                      DBL2NUM(a->data[2] * x + a->data[5] * y +
-                              a->data[8] * z));
+    Vec3Data *v = vec3_get(other);
+    return vec3_build(
+        cVec3, a->data[0] * v->x + a->data[3] * v->y + a->data[6] * v->z,
+        a->data[1] * v->x + a->data[4] * v->y + a->data[7] * v->z,
+        a->data[2] * v->x + a->data[5] * v->y + a->data[8] * v->z);
   }
 
   if (rb_obj_is_kind_of(other, rb_cNumeric)) {
@@ -280,26 +328,35 @@ VALUE mat3_determinant(VALUE self) {
   return DBL2NUM(det);
 }
 
+static VALUE mat3_class_multiply(int argc, VALUE *argv, VALUE klass) {
+  VALUE a = Qnil;
+  VALUE b = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "21", &a, &b, &out);
+  Mat3Data *ad = mat3_get(a);
+  Mat3Data *bd = mat3_get(b);
+  Mat3Data *dst = mat3_output(klass, &out);
+  mat3_multiply_values(ad->data, bd->data, dst->data);
+  return out;
+}
+
 VALUE mat3_inverse(VALUE self) {
   Mat3Data *a = mat3_get(self);
-  double det = a->data[0] * (a->data[4] * a->data[8] - a->data[5] * a->data[7]) -
-               a->data[3] * (a->data[1] * a->data[8] - a->data[2] * a->data[7]) +
-               a->data[6] * (a->data[1] * a->data[5] - a->data[2] * a->data[4]);
-  if (fabs(det) < 1e-10) {
+  double inv[9];
+  if (!mat3_invert_values(a->data, inv)) {
     rb_raise(rb_eRuntimeError, "Matrix is not invertible");
   }
-  double inv_det = 1.0 / det;
-  return mat3_build9(
-      rb_obj_class(self),
-      (a->data[4] * a->data[8] - a->data[5] * a->data[7]) * inv_det,
-      (a->data[2] * a->data[7] - a->data[1] * a->data[8]) * inv_det,
-      (a->data[1] * a->data[5] - a->data[2] * a->data[4]) * inv_det,
-      (a->data[5] * a->data[6] - a->data[3] * a->data[8]) * inv_det,
-      (a->data[0] * a->data[8] - a->data[2] * a->data[6]) * inv_det,
-      (a->data[2] * a->data[3] - a->data[0] * a->data[5]) * inv_det,
-      (a->data[3] * a->data[7] - a->data[4] * a->data[6]) * inv_det,
-      (a->data[1] * a->data[6] - a->data[0] * a->data[7]) * inv_det,
-      (a->data[0] * a->data[4] - a->data[1] * a->data[3]) * inv_det);
+  return mat3_build(rb_obj_class(self), inv);
+}
+
+VALUE mat3_invert_into(VALUE self, VALUE out) {
+  Mat3Data *a = mat3_get(self);
+  Mat3Data *dst = mat3_output(rb_obj_class(self), &out);
+  if (!mat3_invert_values(a->data, dst->data)) {
+    rb_raise(rb_eRuntimeError, "Matrix is not invertible");
+  }
+  return out;
 }
 
 VALUE mat3_transpose(VALUE self) {
@@ -427,15 +484,37 @@ VALUE mat3_inspect(VALUE self) {
   return str;
 }
 
+static bool mat3_view_get(VALUE obj, rb_memory_view_t *view, int flags) {
+  return view_fill(view, obj, mat3_get(obj)->data, -1, OBJ_FROZEN(obj), flags,
+                   &mat3_layout);
+}
+
+static bool mat3_view_release(VALUE obj, rb_memory_view_t *view) {
+  view_release(view);
+  return true;
+}
+
+static bool mat3_view_available(VALUE obj) {
+  return true;
+}
+
+static const rb_memory_view_entry_t mat3_view_entry = {
+    mat3_view_get,
+    mat3_view_release,
+    mat3_view_available,
+};
+
 void Init_mat3(VALUE module) {
   cMat3 = rb_define_class_under(module, "Mat3", rb_cObject);
-  cVec3 = rb_const_get(mLarb, rb_intern("Vec3"));
+  rb_memory_view_register(cMat3, &mat3_view_entry);
 
   rb_define_alloc_func(cMat3, mat3_alloc);
   rb_define_method(cMat3, "initialize", mat3_initialize, -1);
+  rb_define_method(cMat3, "initialize_copy", mat3_initialize_copy, 1);
 
   rb_define_singleton_method(cMat3, "identity", mat3_class_identity, 0);
   rb_define_singleton_method(cMat3, "zero", mat3_class_zero, 0);
+
   rb_define_singleton_method(cMat3, "from_mat4", mat3_class_from_mat4, 1);
   rb_define_singleton_method(cMat3, "from_mat2d", mat3_class_from_mat2d, 1);
   rb_define_singleton_method(cMat3, "from_quaternion",
@@ -446,6 +525,7 @@ void Init_mat3(VALUE module) {
   rb_define_singleton_method(cMat3, "translation", mat3_class_translation, 2);
   rb_define_singleton_method(cMat3, "rotation", mat3_class_rotation, 1);
   rb_define_singleton_method(cMat3, "scaling", mat3_class_scaling, 2);
+  rb_define_singleton_method(cMat3, "multiply", mat3_class_multiply, -1);
 
   rb_define_method(cMat3, "data", mat3_data, 0);
   rb_define_method(cMat3, "[]", mat3_aref, 1);
@@ -455,6 +535,7 @@ void Init_mat3(VALUE module) {
   rb_define_method(cMat3, "-", mat3_sub, 1);
   rb_define_method(cMat3, "determinant", mat3_determinant, 0);
   rb_define_method(cMat3, "inverse", mat3_inverse, 0);
+  rb_define_method(cMat3, "invert_into", mat3_invert_into, 1);
   rb_define_method(cMat3, "transpose", mat3_transpose, 0);
   rb_define_method(cMat3, "adjoint", mat3_adjoint, 0);
   rb_define_method(cMat3, "frobenius_norm", mat3_frobenius_norm, 0);
@@ -466,4 +547,10 @@ void Init_mat3(VALUE module) {
   rb_define_method(cMat3, "near?", mat3_near, -1);
   rb_define_method(cMat3, "inspect", mat3_inspect, 0);
   rb_define_alias(cMat3, "to_s", "inspect");
+
+  larb_define_constant(cMat3, "IDENTITY", &mat3_const_identity,
+                       mat3_alloc(cMat3));
+  larb_define_constant(cMat3, "ZERO", &mat3_const_zero,
+                       mat3_build9(cMat3, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                   0.0, 0.0));
 }
@@ -7,9 +7,13 @@ typedef struct {
   double data[9];
 } Mat3Data;
 
+extern VALUE cMat3;
+
 void Init_mat3(VALUE module);
 VALUE mat3_alloc(VALUE klass);
 VALUE mat3_initialize(int argc, VALUE *argv, VALUE self);
+Mat3Data *mat3_get(VALUE obj);
+VALUE mat3_build(VALUE klass, const double *values);
 
 VALUE mat3_aref(VALUE self, VALUE index);
 VALUE mat3_aset(VALUE self, VALUE index, VALUE value);
@@ -18,6 +22,7 @@ VALUE mat3_add(VALUE self, VALUE other);
 VALUE mat3_sub(VALUE self, VALUE other);
 VALUE mat3_determinant(VALUE self);
 VALUE mat3_inverse(VALUE self);
+VALUE mat3_invert_into(VALUE self, VALUE out);
 VALUE mat3_transpose(VALUE self);
 VALUE mat3_adjoint(VALUE self);
 VALUE mat3_frobenius_norm(VALUE self);
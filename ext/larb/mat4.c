@@ -2,39 +2,48 @@
 
 #include <math.h>
 
-static void mat4_free(void *ptr) {
-  xfree(ptr);
-}
+#include "packed_buffer.h"
+#include "quat.h"
+#include "simd.h"
+#include "vec3.h"
+#include "vec4.h"
+#include "view.h"
+#include "vec3_array.h"
+
+#ifdef LARB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#define SIMD_KERNELS_HEADER "mat4_kernels.h"
+#include "simd_kernels.h"
+#undef SIMD_KERNELS_HEADER
 
 static size_t mat4_memsize(const void *ptr) {
-  return sizeof(Mat4Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Mat4Data);
 }
 
 static const rb_data_type_t mat4_type = {
     "Mat4",
-    {0, mat4_free, mat4_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, mat4_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cMat4 = Qnil;
-static VALUE cVec3 = Qnil;
-static VALUE cVec4 = Qnil;
-static VALUE cQuat = Qnil;
+static const ViewLayout mat4_layout = {"d", 8, 128, 2, {4, 4}, {8, 32}};
 
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cMat4 = Qnil;
+static VALUE mat4_const_identity = Qnil;
+static VALUE mat4_const_zero = Qnil;
 
-static Mat4Data *mat4_get(VALUE obj) {
+Mat4Data *mat4_get(VALUE obj) {
   Mat4Data *data = NULL;
   TypedData_Get_Struct(obj, Mat4Data, &mat4_type, data);
   return data;
 }
 
-static VALUE mat4_build(VALUE klass, const double *values) {
+VALUE mat4_build(VALUE klass, const double *values) {
   VALUE obj = mat4_alloc(klass);
   Mat4Data *data = mat4_get(obj);
   for (int i = 0; i < 16; i++) {
@@ -52,23 +61,232 @@ static VALUE mat4_build16(VALUE klass, double v0, double v1, double v2,
   return mat4_build(klass, values);
 }
 
-static inline void vec3_normalize(double *x, double *y, double *z) {
+static inline void normalize3(double *x, double *y, double *z) {
   double len = sqrt((*x) * (*x) + (*y) * (*y) + (*z) * (*z));
   *x /= len;
   *y /= len;
   *z /= len;
 }
 
-static inline void vec3_cross(double ax, double ay, double az, double bx,
-                              double by, double bz, double *rx, double *ry,
-                              double *rz) {
+static inline void cross3(double ax, double ay, double az, double bx,
+                          double by, double bz, double *rx, double *ry,
+                          double *rz) {
   *rx = ay * bz - az * by;
   *ry = az * bx - ax * bz;
   *rz = ax * by - ay * bx;
 }
 
+static void multiply_kernel(const double *ad, const double *bd, double *out) {
+  double result[16];
+
+  result[0] = ad[0] * bd[0] + ad[4] * bd[1] + ad[8] * bd[2] + ad[12] * bd[3];
+  result[1] = ad[1] * bd[0] + ad[5] * bd[1] + ad[9] * bd[2] + ad[13] * bd[3];
+  result[2] = ad[2] * bd[0] + ad[6] * bd[1] + ad[10] * bd[2] + ad[14] * bd[3];
+  result[3] = ad[3] * bd[0] + ad[7] * bd[1] + ad[11] * bd[2] + ad[15] * bd[3];
+
+  result[4] = ad[0] * bd[4] + ad[4] * bd[5] + ad[8] * bd[6] + ad[12] * bd[7];
+  result[5] = ad[1] * bd[4] + ad[5] * bd[5] + ad[9] * bd[6] + ad[13] * bd[7];
+  result[6] = ad[2] * bd[4] + ad[6] * bd[5] + ad[10] * bd[6] + ad[14] * bd[7];
+  result[7] = ad[3] * bd[4] + ad[7] * bd[5] + ad[11] * bd[6] + ad[15] * bd[7];
+
+  result[8] = ad[0] * bd[8] + ad[4] * bd[9] + ad[8] * bd[10] + ad[12] * bd[11];
+  result[9] = ad[1] * bd[8] + ad[5] * bd[9] + ad[9] * bd[10] + ad[13] * bd[11];
+  result[10] = ad[2] * bd[8] + ad[6] * bd[9] + ad[10] * bd[10] + ad[14] * bd[11];
+  result[11] = ad[3] * bd[8] + ad[7] * bd[9] + ad[11] * bd[10] + ad[15] * bd[11];
+
+  result[12] = ad[0] * bd[12] + ad[4] * bd[13] + ad[8] * bd[14] + ad[12] * bd[15];
+  result[13] = ad[1] * bd[12] + ad[5] * bd[13] + ad[9] * bd[14] + ad[13] * bd[15];
+  result[14] = ad[2] * bd[12] + ad[6] * bd[13] + ad[10] * bd[14] + ad[14] * bd[15];
+  result[15] = ad[3] * bd[12] + ad[7] * bd[13] + ad[11] * bd[14] + ad[15] * bd[15];
+
+  for (int i = 0; i < 16; i++) {
+    out[i] = result[i];
+  }
+}
+
+#ifdef LARB_SIMD_X86
+SIMD_BEGIN(SIMD_AVX2_TARGET)
+
+static void multiply_kernel_avx2(const double *a, const double *b,
+                                 double *out) {
+  __m256d c0 = _mm256_loadu_pd(a);
+  __m256d c1 = _mm256_loadu_pd(a + 4);
+  __m256d c2 = _mm256_loadu_pd(a + 8);
+  __m256d c3 = _mm256_loadu_pd(a + 12);
+  __m256d r[4];
+
+  for (int j = 0; j < 4; j++) {
+    const double *bj = b + j * 4;
+    __m256d v = _mm256_mul_pd(c0, _mm256_broadcast_sd(bj));
+    v = _mm256_fmadd_pd(c1, _mm256_broadcast_sd(bj + 1), v);
+    v = _mm256_fmadd_pd(c2, _mm256_broadcast_sd(bj + 2), v);
+    r[j] = _mm256_fmadd_pd(c3, _mm256_broadcast_sd(bj + 3), v);
+  }
+  for (int j = 0; j < 4; j++) {
+    _mm256_storeu_pd(out + j * 4, r[j]);
+  }
+}
+
+static inline __m256 broadcast_column_f32(const float *a) {
+  __m128 column = _mm_loadu_ps(a);
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(column), column, 1);
+}
+
+static void multiply_kernel_f32_avx2(const float *a, const float *b,
+                                     float *out) {
+  __m256 c0 = broadcast_column_f32(a);
+  __m256 c1 = broadcast_column_f32(a + 4);
+  __m256 c2 = broadcast_column_f32(a + 8);
+  __m256 c3 = broadcast_column_f32(a + 12);
+  __m256 r[2];
+
+  for (int j = 0; j < 2; j++) {
+    __m256 bj = _mm256_loadu_ps(b + j * 8);
+    __m256 v = _mm256_mul_ps(c0, _mm256_permute_ps(bj, 0x00));
+    v = _mm256_fmadd_ps(c1, _mm256_permute_ps(bj, 0x55), v);
+    v = _mm256_fmadd_ps(c2, _mm256_permute_ps(bj, 0xAA), v);
+    r[j] = _mm256_fmadd_ps(c3, _mm256_permute_ps(bj, 0xFF), v);
+  }
+  _mm256_storeu_ps(out, r[0]);
+  _mm256_storeu_ps(out + 8, r[1]);
+}
+
+SIMD_END
+#endif
+
+void mat4_multiply_values(const double *a, const double *b, double *out) {
+#ifdef LARB_SIMD_X86
+  if (simd_level >= SIMD_AVX2) {
+    multiply_kernel_avx2(a, b, out);
+    return;
+  }
+#endif
+  multiply_kernel(a, b, out);
+}
+
+void mat4_multiply_values_f32(const float *a, const float *b, float *out) {
+#ifdef LARB_SIMD_X86
+  if (simd_level >= SIMD_AVX2) {
+    multiply_kernel_f32_avx2(a, b, out);
+    return;
+  }
+#endif
+  double ad[16];
+  double bd[16];
+  double od[16];
+  for (int i = 0; i < 16; i++) {
+    ad[i] = a[i];
+    bd[i] = b[i];
+  }
+  multiply_kernel(ad, bd, od);
+  for (int i = 0; i < 16; i++) {
+    out[i] = (float)od[i];
+  }
+}
+
+void mat4_transpose_values(const double *m, double *out) {
+  double values[16];
+  for (int col = 0; col < 4; col++) {
+    for (int row = 0; row < 4; row++) {
+      values[row * 4 + col] = m[col * 4 + row];
+    }
+  }
+  for (int i = 0; i < 16; i++) {
+    out[i] = values[i];
+  }
+}
+
+int mat4_invert_values(const double *m, double *out) {
+  const double m0 = m[0];
+  const double m1 = m[1];
+  const double m2 = m[2];
+  const double m3 = m[3];
+  const double m4 = m[4];
+  const double m5 = m[5];
+  const double m6 = m[6];
+  const double m7 = m[7];
+  const double m8 = m[8];
+  const double m9 = m[9];
+  const double m10 = m[10];
+  const double m11 = m[11];
+  const double m12 = m[12];
+  const double m13 = m[13];
+  const double m14 = m[14];
+  const double m15 = m[15];
+  double inv[16];
+
+  inv[0] = m5 * m10 * m15 - m5 * m11 * m14 - m9 * m6 * m15 +
+           m9 * m7 * m14 + m13 * m6 * m11 - m13 * m7 * m10;
+  inv[4] = -m4 * m10 * m15 + m4 * m11 * m14 + m8 * m6 * m15 -
+           m8 * m7 * m14 - m12 * m6 * m11 + m12 * m7 * m10;
+  inv[8] = m4 * m9 * m15 - m4 * m11 * m13 - m8 * m5 * m15 +
+           m8 * m7 * m13 + m12 * m5 * m11 - m12 * m7 * m9;
+  inv[12] = -m4 * m9 * m14 + m4 * m10 * m13 + m8 * m5 * m14 -
+            m8 * m6 * m13 - m12 * m5 * m10 + m12 * m6 * m9;
+
+  inv[1] = -m1 * m10 * m15 + m1 * m11 * m14 + m9 * m2 * m15 -
+           m9 * m3 * m14 - m13 * m2 * m11 + m13 * m3 * m10;
+  inv[5] = m0 * m10 * m15 - m0 * m11 * m14 - m8 * m2 * m15 +
+           m8 * m3 * m14 + m12 * m2 * m11 - m12 * m3 * m10;
+  inv[9] = -m0 * m9 * m15 + m0 * m11 * m13 + m8 * m1 * m15 -
+           m8 * m3 * m13 - m12 * m1 * m11 + m12 * m3 * m9;
+  inv[13] = m0 * m9 * m14 - m0 * m10 * m13 - m8 * m1 * m14 +
+            m8 * m2 * m13 + m12 * m1 * m10 - m12 * m2 * m9;
+
+  inv[2] = m1 * m6 * m15 - m1 * m7 * m14 - m5 * m2 * m15 +
+           m5 * m3 * m14 + m13 * m2 * m7 - m13 * m3 * m6;
+  inv[6] = -m0 * m6 * m15 + m0 * m7 * m14 + m4 * m2 * m15 -
+           m4 * m3 * m14 - m12 * m2 * m7 + m12 * m3 * m6;
+  inv[10] = m0 * m5 * m15 - m0 * m7 * m13 - m4 * m1 * m15 +
+            m4 * m3 * m13 + m12 * m1 * m7 - m12 * m3 * m5;
+  inv[14] = -m0 * m5 * m14 + m0 * m6 * m13 + m4 * m1 * m14 -
+            m4 * m2 * m13 - m12 * m1 * m6 + m12 * m2 * m5;
+
+  inv[3] = -m1 * m6 * m11 + m1 * m7 * m10 + m5 * m2 * m11 -
+           m5 * m3 * m10 - m9 * m2 * m7 + m9 * m3 * m6;
+  inv[7] = m0 * m6 * m11 - m0 * m7 * m10 - m4 * m2 * m11 +
+           m4 * m3 * m10 + m8 * m2 * m7 - m8 * m3 * m6;
+  inv[11] = -m0 * m5 * m11 + m0 * m7 * m9 + m4 * m1 * m11 -
+            m4 * m3 * m9 - m8 * m1 * m7 + m8 * m3 * m5;
+  inv[15] = m0 * m5 * m10 - m0 * m6 * m9 - m4 * m1 * m10 +
+            m4 * m2 * m9 + m8 * m1 * m6 - m8 * m2 * m5;
+
+  double det = m0 * inv[0] + m1 * inv[4] + m2 * inv[8] + m3 * inv[12];
+  if (fabs(det) < 1e-10) {
+    return 0;
+  }
+
+  det = 1.0 / det;
+  for (int i = 0; i < 16; i++) {
+    out[i] = inv[i] * det;
+  }
+  return 1;
+}
+
+double mat4_determinant_values(const double *m) {
+  double det =
+      m[0] *
+          (m[5] * (m[10] * m[15] - m[11] * m[14]) -
+           m[9] * (m[6] * m[15] - m[7] * m[14]) +
+           m[13] * (m[6] * m[11] - m[7] * m[10])) -
+      m[4] *
+          (m[1] * (m[10] * m[15] - m[11] * m[14]) -
+           m[9] * (m[2] * m[15] - m[3] * m[14]) +
+           m[13] * (m[2] * m[11] - m[3] * m[10])) +
+      m[8] *
+          (m[1] * (m[6] * m[15] - m[7] * m[14]) -
+           m[5] * (m[2] * m[15] - m[3] * m[14]) +
+           m[13] * (m[2] * m[7] - m[3] * m[6])) -
+      m[12] *
+          (m[1] * (m[6] * m[11] - m[7] * m[10]) -
+           m[5] * (m[2] * m[11] - m[3] * m[10]) +
+           m[9] * (m[2] * m[7] - m[3] * m[6]));
+  return det;
+}
+
 VALUE mat4_alloc(VALUE klass) {
-  Mat4Data *data = ALLOC(Mat4Data);
+  Mat4Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Mat4Data, &mat4_type, data);
   for (int i = 0; i < 16; i++) {
     data->data[i] = 0.0;
   }
@@ -76,10 +294,11 @@ VALUE mat4_alloc(VALUE klass) {
   data->data[5] = 1.0;
   data->data[10] = 1.0;
   data->data[15] = 1.0;
-  return TypedData_Wrap_Struct(klass, &mat4_type, data);
+  return obj;
 }
 
 VALUE mat4_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE data_arg = Qnil;
   Mat4Data *data = mat4_get(self);
 
@@ -107,17 +326,31 @@ VALUE mat4_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE mat4_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *mat4_get(self) = *mat4_get(other);
+  return self;
+}
+
+static VALUE mat4_constant(VALUE klass, VALUE constant) {
+  if (klass == cMat4) {
+    return constant;
+  }
+  VALUE obj = mat4_alloc(klass);
+  *mat4_get(obj) = *mat4_get(constant);
+  return obj;
+}
+
 static VALUE mat4_class_identity(VALUE klass) {
-  return mat4_alloc(klass);
+  return mat4_constant(klass, mat4_const_identity);
 }
 
 static VALUE mat4_class_zero(VALUE klass) {
-  return mat4_build16(klass, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
-                      0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+  return mat4_constant(klass, mat4_const_zero);
 }
 
 static VALUE mat4_class_translation(VALUE klass, VALUE x, VALUE y, VALUE z) {
-  VALUE m = mat4_class_identity(klass);
+  VALUE m = mat4_alloc(klass);
   mat4_aset(m, INT2NUM(12), x);
   mat4_aset(m, INT2NUM(13), y);
   mat4_aset(m, INT2NUM(14), z);
@@ -157,10 +390,11 @@ static VALUE mat4_class_rotation_z(VALUE klass, VALUE radians) {
 }
 
 static VALUE mat4_class_rotation(VALUE klass, VALUE axis, VALUE radians) {
-  VALUE normalized = rb_funcall(axis, rb_intern("normalize"), 0);
-  double x = value_to_double(rb_funcall(normalized, rb_intern("x"), 0));
-  double y = value_to_double(rb_funcall(normalized, rb_intern("y"), 0));
-  double z = value_to_double(rb_funcall(normalized, rb_intern("z"), 0));
+  Vec3Data *v = vec3_get(axis);
+  double x = v->x;
+  double y = v->y;
+  double z = v->z;
+  normalize3(&x, &y, &z);
   double r = value_to_double(radians);
   double c = cos(r);
   double s = sin(r);
@@ -175,27 +409,30 @@ static VALUE mat4_class_rotation(VALUE klass, VALUE axis, VALUE radians) {
 
 static VALUE mat4_class_look_at(VALUE klass, VALUE eye, VALUE target,
                                 VALUE up) {
-  double ex = value_to_double(rb_funcall(eye, rb_intern("x"), 0));
-  double ey = value_to_double(rb_funcall(eye, rb_intern("y"), 0));
-  double ez = value_to_double(rb_funcall(eye, rb_intern("z"), 0));
-  double tx = value_to_double(rb_funcall(target, rb_intern("x"), 0));
-  double ty = value_to_double(rb_funcall(target, rb_intern("y"), 0));
-  double tz = value_to_double(rb_funcall(target, rb_intern("z"), 0));
-  double ux = value_to_double(rb_funcall(up, rb_intern("x"), 0));
-  double uy = value_to_double(rb_funcall(up, rb_intern("y"), 0));
-  double uz = value_to_double(rb_funcall(up, rb_intern("z"), 0));
+  Vec3Data *e = vec3_get(eye);
+  Vec3Data *t = vec3_get(target);
+  Vec3Data *u = vec3_get(up);
+  double ex = e->x;
+  double ey = e->y;
+  double ez = e->z;
+  double tx = t->x;
+  double ty = t->y;
+  double tz = t->z;
+  double ux = u->x;
+  double uy = u->y;
+  double uz = u->z;
 
   double fx = tx - ex;
   double fy = ty - ey;
   double fz = tz - ez;
-  vec3_normalize(&fx, &fy, &fz);
+  normalize3(&fx, &fy, &fz);
 
   double rx, ry, rz;
-  vec3_cross(fx, fy, fz, ux, uy, uz, &rx, &ry, &rz);
-  vec3_normalize(&rx, &ry, &rz);
+  cross3(fx, fy, fz, ux, uy, uz, &rx, &ry, &rz);
+  normalize3(&rx, &ry, &rz);
 
   double ux2, uy2, uz2;
-  vec3_cross(rx, ry, rz, fx, fy, fz, &ux2, &uy2, &uz2);
+  cross3(rx, ry, rz, fx, fy, fz, &ux2, &uy2, &uz2);
 
   return mat4_build16(klass, rx, ux2, -fx, 0.0, ry, uy2, -fy, 0.0, rz, uz2,
                       -fz, 0.0, -(rx * ex + ry * ey + rz * ez),
@@ -251,12 +488,8 @@ static VALUE mat4_class_frustum(VALUE klass, VALUE left, VALUE right,
                       0.0, 2 * f * n * nf, 0.0);
 }
 
-static VALUE mat4_class_from_quaternion(VALUE klass, VALUE quat) {
-  double x = value_to_double(rb_funcall(quat, rb_intern("x"), 0));
-  double y = value_to_double(rb_funcall(quat, rb_intern("y"), 0));
-  double z = value_to_double(rb_funcall(quat, rb_intern("z"), 0));
-  double w = value_to_double(rb_funcall(quat, rb_intern("w"), 0));
-
+void mat4_rotation_values(double x, double y, double z, double w,
+                          double *out) {
   double x2 = x + x;
   double y2 = y + y;
   double z2 = z + z;
@@ -270,25 +503,55 @@ static VALUE mat4_class_from_quaternion(VALUE klass, VALUE quat) {
   double wy = w * y2;
   double wz = w * z2;
 
-  return mat4_build16(klass, 1 - (yy + zz), xy + wz, xz - wy, 0.0, xy - wz,
-                      1 - (xx + zz), yz + wx, 0.0, xz + wy, yz - wx,
-                      1 - (xx + yy), 0.0, 0.0, 0.0, 0.0, 1.0);
+  out[0] = 1 - (yy + zz);
+  out[1] = xy + wz;
+  out[2] = xz - wy;
+  out[3] = 0.0;
+  out[4] = xy - wz;
+  out[5] = 1 - (xx + zz);
+  out[6] = yz + wx;
+  out[7] = 0.0;
+  out[8] = xz + wy;
+  out[9] = yz - wx;
+  out[10] = 1 - (xx + yy);
+  out[11] = 0.0;
+  out[12] = 0.0;
+  out[13] = 0.0;
+  out[14] = 0.0;
+  out[15] = 1.0;
+}
+
+static VALUE mat4_class_from_quaternion(VALUE klass, VALUE quat) {
+  QuatData *q = quat_get(quat);
+  double values[16];
+  mat4_rotation_values(q->x, q->y, q->z, q->w, values);
+  return mat4_build(klass, values);
+}
+
+void mat4_trs_values(const double *t, const double *q, const double *s,
+                     double *out) {
+  mat4_rotation_values(q[0], q[1], q[2], q[3], out);
+  for (int i = 0; i < 3; i++) {
+    out[i] *= s[0];
+    out[4 + i] *= s[1];
+    out[8 + i] *= s[2];
+  }
+  for (int i = 0; i < 3; i++) {
+    out[12 + i] = out[i] * t[0] + out[4 + i] * t[1] + out[8 + i] * t[2];
+  }
 }
 
 static VALUE mat4_class_trs(VALUE klass, VALUE translation, VALUE rotation,
                             VALUE scale) {
-  VALUE rot = mat4_class_from_quaternion(klass, rotation);
-  double sx = value_to_double(rb_funcall(scale, rb_intern("x"), 0));
-  double sy = value_to_double(rb_funcall(scale, rb_intern("y"), 0));
-  double sz = value_to_double(rb_funcall(scale, rb_intern("z"), 0));
-  VALUE scale_m = mat4_class_scaling(klass, DBL2NUM(sx), DBL2NUM(sy), DBL2NUM(sz));
-  double tx = value_to_double(rb_funcall(translation, rb_intern("x"), 0));
-  double ty = value_to_double(rb_funcall(translation, rb_intern("y"), 0));
-  double tz = value_to_double(rb_funcall(translation, rb_intern("z"), 0));
-  VALUE trans_m =
-      mat4_class_translation(klass, DBL2NUM(tx), DBL2NUM(ty), DBL2NUM(tz));
-  VALUE tmp = mat4_mul(rot, scale_m);
-  return mat4_mul(tmp, trans_m);
+  Vec3Data *tv = vec3_get(translation);
+  QuatData *qv = quat_get(rotation);
+  Vec3Data *sv = vec3_get(scale);
+  double t[3] = {tv->x, tv->y, tv->z};
+  double q[4] = {qv->x, qv->y, qv->z, qv->w};
+  double s[3] = {sv->x, sv->y, sv->z};
+  double values[16];
+  mat4_trs_values(t, q, s, values);
+  return mat4_build(klass, values);
 }
 
 VALUE mat4_aref(VALUE self, VALUE index) {
@@ -301,6 +564,7 @@ VALUE mat4_aref(VALUE self, VALUE index) {
 }
 
 VALUE mat4_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Mat4Data *data = mat4_get(self);
   long idx = NUM2LONG(index);
   if (idx < 0 || idx > 15) {
@@ -310,139 +574,159 @@ VALUE mat4_aset(VALUE self, VALUE index, VALUE value) {
   return value;
 }
 
+static Mat4Data *mat4_output(VALUE klass, VALUE *out) {
+  if (NIL_P(*out)) {
+    *out = mat4_alloc(klass);
+  }
+  rb_check_frozen(*out);
+  return mat4_get(*out);
+}
+
+static VALUE mat4_class_multiply(int argc, VALUE *argv, VALUE klass) {
+  VALUE a = Qnil;
+  VALUE b = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "21", &a, &b, &out);
+  Mat4Data *ad = mat4_get(a);
+  Mat4Data *bd = mat4_get(b);
+  Mat4Data *dst = mat4_output(klass, &out);
+  mat4_multiply_values(ad->data, bd->data, dst->data);
+  return out;
+}
+
+static VALUE mat4_transform_vec4(const double *m, double x, double y,
+                                 double z, double w) {
+  return vec4_build(cVec4, m[0] * x + m[4] * y + m[8] * z + m[12] * w,
+                    m[1] * x + m[5] * y + m[9] * z + m[13] * w,
+                    m[2] * x + m[6] * y + m[10] * z + m[14] * w,
+                    m[3] * x + m[7] * y + m[11] * z + m[15] * w);
+}
+
 VALUE mat4_mul(VALUE self, VALUE other) {
   Mat4Data *a = mat4_get(self);
 
   if (rb_obj_is_kind_of(other, cMat4)) {
     Mat4Data *b = mat4_get(other);
     double result[16];
-    const double *ad = a->data;
-    const double *bd = b->data;
-
-    result[0] = ad[0] * bd[0] + ad[4] * bd[1] + ad[8] * bd[2] + ad[12] * bd[3];
-    result[1] = ad[1] * bd[0] + ad[5] * bd[1] + ad[9] * bd[2] + ad[13] * bd[3];
-    result[2] = ad[2] * bd[0] + ad[6] * bd[1] + ad[10] * bd[2] + ad[14] * bd[3];
-    result[3] = ad[3] * bd[0] + ad[7] * bd[1] + ad[11] * bd[2] + ad[15] * bd[3];
-
-    result[4] = ad[0] * bd[4] + ad[4] * bd[5] + ad[8] * bd[6] + ad[12] * bd[7];
-    result[5] = ad[1] * bd[4] + ad[5] * bd[5] + ad[9] * bd[6] + ad[13] * bd[7];
-    result[6] = ad[2] * bd[4] + ad[6] * bd[5] + ad[10] * bd[6] + ad[14] * bd[7];
-    result[7] = ad[3] * bd[4] + ad[7] * bd[5] + ad[11] * bd[6] + ad[15] * bd[7];
-
-    result[8] = ad[0] * bd[8] + ad[4] * bd[9] + ad[8] * bd[10] + ad[12] * bd[11];
-    result[9] = ad[1] * bd[8] + ad[5] * bd[9] + ad[9] * bd[10] + ad[13] * bd[11];
-    result[10] = ad[2] * bd[8] + ad[6] * bd[9] + ad[10] * bd[10] + ad[14] * bd[11];
-    result[11] = ad[3] * bd[8] + ad[7] * bd[9] + ad[11] * bd[10] + ad[15] * bd[11];
-
-    result[12] = ad[0] * bd[12] + ad[4] * bd[13] + ad[8] * bd[14] + ad[12] * bd[15];
-    result[13] = ad[1] * bd[12] + ad[5] * bd[13] + ad[9] * bd[14] + ad[13] * bd[15];
-    result[14] = ad[2] * bd[12] + ad[6] * bd[13] + ad[10] * bd[14] + ad[14] * bd[15];
-    result[15] = ad[3] * bd[12] + ad[7] * bd[13] + ad[11] * bd[14] + ad[15] * bd[15];
+    mat4_multiply_values(a->data, b->data, result);
     return mat4_build(rb_obj_class(self), result);
   }
 
   if (rb_obj_is_kind_of(other, cVec4)) {
-    double x = value_to_double(rb_funcall(other, rb_intern("x"), 0));
-    double y = value_to_double(rb_funcall(other, rb_intern("y"), 0));
-    double z = value_to_double(rb_funcall(other, rb_intern("z"), 0));
-    double w = value_to_double(rb_funcall(other, rb_intern("w"), 0));
-    VALUE vec4_class = rb_const_get(mLarb, rb_intern("Vec4"));
-    return rb_funcall(
-        vec4_class, rb_intern("new"), 4,
-        DBL2NUM(a->data[0] * x + a->data[4] * y + a->data[8] * z +
-                a->data[12] * w),
-        DBL2NUM(a->data[1] * x + a->data[5] * y + a->data[9] * z +
-                a->data[13] * w),
-        DBL2NUM(a->data[2] * x + a->data[6] * y + a->data[10] * z +
-                a->data[14] * w),
-        DBL2NUM(a->data[3] * x + a->data[7] * y + a->data[11] * z +
-                a->data[15] * w));
+    Vec4Data *v = vec4_get(other);
+    return mat4_transform_vec4(a->data, v->x, v->y, v->z, v->w);
   }
 
   if (rb_obj_is_kind_of(other, cVec3)) {
-    VALUE vec4 = rb_funcall(other, rb_intern("to_vec4"), 0);
-    return mat4_mul(self, vec4);
+    Vec3Data *v = vec3_get(other);
+    return mat4_transform_vec4(a->data, v->x, v->y, v->z, 1.0);
   }
 
   return Qnil;
 }
 
-VALUE mat4_transpose(VALUE self) {
-  Mat4Data *a = mat4_get(self);
-  return mat4_build16(rb_obj_class(self), a->data[0], a->data[4], a->data[8],
-                      a->data[12], a->data[1], a->data[5], a->data[9],
-                      a->data[13], a->data[2], a->data[6], a->data[10],
-                      a->data[14], a->data[3], a->data[7], a->data[11],
-                      a->data[15]);
+typedef struct {
+  double m[16];
+  PackedType type;
+  const void *src;
+  void *dst;
+  long length;
+  double w;
+  int divide;
+} TransformJob;
+
+static void transform_job(void *ptr, long begin, long end) {
+  TransformJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(transform_kernel_f32)
+    (job->m, (const float *)job->src + begin * 3,
+     (float *)job->dst + begin * 3, end - begin, (float)job->w, job->divide);
+  } else {
+    SIMD_SELECT(transform_kernel_f64)
+    (job->m, (const double *)job->src + begin * 3,
+     (double *)job->dst + begin * 3, end - begin, job->w, job->divide);
+  }
 }
 
-VALUE mat4_inverse(VALUE self) {
-  Mat4Data *a = mat4_get(self);
-  const double *m = a->data;
-  const double m0 = m[0];
-  const double m1 = m[1];
-  const double m2 = m[2];
-  const double m3 = m[3];
-  const double m4 = m[4];
-  const double m5 = m[5];
-  const double m6 = m[6];
-  const double m7 = m[7];
-  const double m8 = m[8];
-  const double m9 = m[9];
-  const double m10 = m[10];
-  const double m11 = m[11];
-  const double m12 = m[12];
-  const double m13 = m[13];
-  const double m14 = m[14];
-  const double m15 = m[15];
-  double inv[16];
+VALUE mat4_apply_vec3_array(const double *m, VALUE points, VALUE out,
+                            double w, int divide) {
+  Vec3ArrayData *src = vec3_array_get(points);
+  if (NIL_P(out)) {
+    out = vec3_array_build(rb_obj_class(points), src->length, src->type);
+  }
+  Vec3ArrayData *dst = vec3_array_get(out);
+  if (dst->length != src->length) {
+    rb_raise(rb_eArgError, "length mismatch (%ld for %ld)", dst->length,
+             src->length);
+  }
+  packed_type_check(src->type, dst->type);
+  packed_buffer_check_writable(out, dst->buffer);
 
-  inv[0] = m5 * m10 * m15 - m5 * m11 * m14 - m9 * m6 * m15 +
-           m9 * m7 * m14 + m13 * m6 * m11 - m13 * m7 * m10;
-  inv[4] = -m4 * m10 * m15 + m4 * m11 * m14 + m8 * m6 * m15 -
-           m8 * m7 * m14 - m12 * m6 * m11 + m12 * m7 * m10;
-  inv[8] = m4 * m9 * m15 - m4 * m11 * m13 - m8 * m5 * m15 +
-           m8 * m7 * m13 + m12 * m5 * m11 - m12 * m7 * m9;
-  inv[12] = -m4 * m9 * m14 + m4 * m10 * m13 + m8 * m5 * m14 -
-            m8 * m6 * m13 - m12 * m5 * m10 + m12 * m6 * m9;
+  TransformJob job = {{0}, src->type, src->data, dst->data, src->length, w,
+                      divide};
+  for (int i = 0; i < 16; i++) {
+    job.m[i] = m[i];
+  }
+  size_t size = (size_t)src->length * 3 * packed_type_size(src->type);
+  packed_check_overlap(src->data, size, dst->data, size);
+  PackedPin pins[2] = {packed_pin(points, src->buffer, &src->locks),
+                       packed_pin(out, dst->buffer, &dst->locks)};
+  packed_run(job.length, transform_job, &job, pins, 2);
+  return out;
+}
 
-  inv[1] = -m1 * m10 * m15 + m1 * m11 * m14 + m9 * m2 * m15 -
-           m9 * m3 * m14 - m13 * m2 * m11 + m13 * m3 * m10;
-  inv[5] = m0 * m10 * m15 - m0 * m11 * m14 - m8 * m2 * m15 +
-           m8 * m3 * m14 + m12 * m2 * m11 - m12 * m3 * m10;
-  inv[9] = -m0 * m9 * m15 + m0 * m11 * m13 + m8 * m1 * m15 -
-           m8 * m3 * m13 - m12 * m1 * m11 + m12 * m3 * m9;
-  inv[13] = m0 * m9 * m14 - m0 * m10 * m13 - m8 * m1 * m14 +
-            m8 * m2 * m13 + m12 * m1 * m10 - m12 * m2 * m9;
+static VALUE mat4_transform_array(int argc, VALUE *argv, VALUE self, double w,
+                                  int divide) {
+  VALUE points = Qnil;
+  VALUE out = Qnil;
 
-  inv[2] = m1 * m6 * m15 - m1 * m7 * m14 - m5 * m2 * m15 +
-           m5 * m3 * m14 + m13 * m2 * m7 - m13 * m3 * m6;
-  inv[6] = -m0 * m6 * m15 + m0 * m7 * m14 + m4 * m2 * m15 -
-           m4 * m3 * m14 - m12 * m2 * m7 + m12 * m3 * m6;
-  inv[10] = m0 * m5 * m15 - m0 * m7 * m13 - m4 * m1 * m15 +
-            m4 * m3 * m13 + m12 * m1 * m7 - m12 * m3 * m5;
-  inv[14] = -m0 * m5 * m14 + m0 * m6 * m13 + m4 * m1 * m14 -
-            m4 * m2 * m13 - m12 * m1 * m6 + m12 * m2 * m5;
+  rb_scan_args(argc, argv, "11", &points, &out);
+  return mat4_apply_vec3_array(mat4_get(self)->data, points, out, w, divide);
+}
 
-  inv[3] = -m1 * m6 * m11 + m1 * m7 * m10 + m5 * m2 * m11 -
-           m5 * m3 * m10 - m9 * m2 * m7 + m9 * m3 * m6;
-  inv[7] = m0 * m6 * m11 - m0 * m7 * m10 - m4 * m2 * m11 +
-           m4 * m3 * m10 + m8 * m2 * m7 - m8 * m3 * m6;
-  inv[11] = -m0 * m5 * m11 + m0 * m7 * m9 + m4 * m1 * m11 -
-            m4 * m3 * m9 - m8 * m1 * m7 + m8 * m3 * m5;
-  inv[15] = m0 * m5 * m10 - m0 * m6 * m9 - m4 * m1 * m10 +
-            m4 * m2 * m9 + m8 * m1 * m6 - m8 * m2 * m5;
+VALUE mat4_transform_points(int argc, VALUE *argv, VALUE self) {
+  return mat4_transform_array(argc, argv, self, 1.0, 0);
+}
 
-  double det = m0 * inv[0] + m1 * inv[4] + m2 * inv[8] + m3 * inv[12];
-  if (fabs(det) < 1e-10) {
+VALUE mat4_transform_directions(int argc, VALUE *argv, VALUE self) {
+  return mat4_transform_array(argc, argv, self, 0.0, 0);
+}
+
+VALUE mat4_project_points(int argc, VALUE *argv, VALUE self) {
+  return mat4_transform_array(argc, argv, self, 1.0, 1);
+}
+
+VALUE mat4_transpose(VALUE self) {
+  Mat4Data *a = mat4_get(self);
+  double values[16];
+  mat4_transpose_values(a->data, values);
+  return mat4_build(rb_obj_class(self), values);
+}
+
+VALUE mat4_inverse(VALUE self) {
+  Mat4Data *a = mat4_get(self);
+  double inv[16];
+  if (!mat4_invert_values(a->data, inv)) {
     rb_raise(rb_eRuntimeError, "Matrix is not invertible");
   }
+  return mat4_build(rb_obj_class(self), inv);
+}
 
-  det = 1.0 / det;
-  for (int i = 0; i < 16; i++) {
-    inv[i] *= det;
+VALUE mat4_invert_into(VALUE self, VALUE out) {
+  Mat4Data *a = mat4_get(self);
+  Mat4Data *dst = mat4_output(rb_obj_class(self), &out);
+  if (!mat4_invert_values(a->data, dst->data)) {
+    rb_raise(rb_eRuntimeError, "Matrix is not invertible");
   }
-  return mat4_build(rb_obj_class(self), inv);
+  return out;
+}
+
+VALUE mat4_transpose_into(VALUE self, VALUE out) {
+  Mat4Data *a = mat4_get(self);
+  Mat4Data *dst = mat4_output(rb_obj_class(self), &out);
+  mat4_transpose_values(a->data, dst->data);
+  return out;
 }
 
 VALUE mat4_to_a(VALUE self) {
@@ -460,25 +744,7 @@ VALUE mat4_data(VALUE self) {
 
 VALUE mat4_determinant(VALUE self) {
   Mat4Data *a = mat4_get(self);
-  double *m = a->data;
-  double det =
-      m[0] *
-          (m[5] * (m[10] * m[15] - m[11] * m[14]) -
-           m[9] * (m[6] * m[15] - m[7] * m[14]) +
-           m[13] * (m[6] * m[11] - m[7] * m[10])) -
-      m[4] *
-          (m[1] * (m[10] * m[15] - m[11] * m[14]) -
-           m[9] * (m[2] * m[15] - m[3] * m[14]) +
-           m[13] * (m[2] * m[11] - m[3] * m[10])) +
-      m[8] *
-          (m[1] * (m[6] * m[15] - m[7] * m[14]) -
-           m[5] * (m[2] * m[15] - m[3] * m[14]) +
-           m[13] * (m[2] * m[7] - m[3] * m[6])) -
-      m[12] *
-          (m[1] * (m[6] * m[11] - m[7] * m[10]) -
-           m[5] * (m[2] * m[11] - m[3] * m[10]) +
-           m[9] * (m[2] * m[7] - m[3] * m[6]));
-  return DBL2NUM(det);
+  return DBL2NUM(mat4_determinant_values(a->data));
 }
 
 VALUE mat4_add(VALUE self, VALUE other) {
@@ -534,30 +800,27 @@ VALUE mat4_near(int argc, VALUE *argv, VALUE self) {
 
 VALUE mat4_extract_translation(VALUE self) {
   Mat4Data *a = mat4_get(self);
-  VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
-  return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(a->data[12]),
-                    DBL2NUM(a->data[13]), DBL2NUM(a->data[14]));
+  return vec3_build(cVec3, a->data[12], a->data[13], a->data[14]);
+}
+
+static void mat4_scale_values(const double *m, double *sx, double *sy,
+                              double *sz) {
+  *sx = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+  *sy = sqrt(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]);
+  *sz = sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10]);
 }
 
 VALUE mat4_extract_scale(VALUE self) {
   Mat4Data *a = mat4_get(self);
-  double sx = sqrt(a->data[0] * a->data[0] + a->data[1] * a->data[1] +
-                   a->data[2] * a->data[2]);
-  double sy = sqrt(a->data[4] * a->data[4] + a->data[5] * a->data[5] +
-                   a->data[6] * a->data[6]);
-  double sz = sqrt(a->data[8] * a->data[8] + a->data[9] * a->data[9] +
-                   a->data[10] * a->data[10]);
-  VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
-  return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(sx), DBL2NUM(sy),
-                    DBL2NUM(sz));
+  double sx, sy, sz;
+  mat4_scale_values(a->data, &sx, &sy, &sz);
+  return vec3_build(cVec3, sx, sy, sz);
 }
 
 VALUE mat4_extract_rotation(VALUE self) {
   Mat4Data *a = mat4_get(self);
-  VALUE scale = mat4_extract_scale(self);
-  double sx = value_to_double(rb_funcall(scale, rb_intern("x"), 0));
-  double sy = value_to_double(rb_funcall(scale, rb_intern("y"), 0));
-  double sz = value_to_double(rb_funcall(scale, rb_intern("z"), 0));
+  double sx, sy, sz;
+  mat4_scale_values(a->data, &sx, &sy, &sz);
 
   double m00 = a->data[0] / sx;
   double m01 = a->data[1] / sx;
@@ -572,30 +835,22 @@ VALUE mat4_extract_rotation(VALUE self) {
   double trace = m00 + m11 + m22;
   if (trace > 0.0) {
     double s = 0.5 / sqrt(trace + 1.0);
-    return rb_funcall(cQuat, rb_intern("new"), 4,
-                      DBL2NUM((m12 - m21) * s),
-                      DBL2NUM((m20 - m02) * s),
-                      DBL2NUM((m01 - m10) * s), DBL2NUM(0.25 / s));
+    return quat_build(cQuat, (m12 - m21) * s, (m20 - m02) * s,
+                      (m01 - m10) * s, 0.25 / s);
   }
   if (m00 > m11 && m00 > m22) {
     double s = 2.0 * sqrt(1.0 + m00 - m11 - m22);
-    return rb_funcall(cQuat, rb_intern("new"), 4, DBL2NUM(0.25 * s),
-                      DBL2NUM((m10 + m01) / s),
-                      DBL2NUM((m20 + m02) / s),
-                      DBL2NUM((m12 - m21) / s));
+    return quat_build(cQuat, 0.25 * s, (m10 + m01) / s, (m20 + m02) / s,
+                      (m12 - m21) / s);
   }
   if (m11 > m22) {
     double s = 2.0 * sqrt(1.0 + m11 - m00 - m22);
-    return rb_funcall(cQuat, rb_intern("new"), 4,
-                      DBL2NUM((m10 + m01) / s), DBL2NUM(0.25 * s),
-                      DBL2NUM((m21 + m12) / s),
-                      DBL2NUM((m20 - m02) / s));
+    return quat_build(cQuat, (m10 + m01) / s, 0.25 * s, (m21 + m12) / s,
+                      (m20 - m02) / s);
   }
   double s = 2.0 * sqrt(1.0 + m22 - m00 - m11);
-  return rb_funcall(cQuat, rb_intern("new"), 4,
-                    DBL2NUM((m20 + m02) / s),
-                    DBL2NUM((m21 + m12) / s), DBL2NUM(0.25 * s),
-                    DBL2NUM((m01 - m10) / s));
+  return quat_build(cQuat, (m20 + m02) / s, (m21 + m12) / s, 0.25 * s,
+                    (m01 - m10) / s);
 }
 
 static VALUE mat4_format_value(double value) {
@@ -626,17 +881,37 @@ VALUE mat4_inspect(VALUE self) {
   return str;
 }
 
+static bool mat4_view_get(VALUE obj, rb_memory_view_t *view, int flags) {
+  return view_fill(view, obj, mat4_get(obj)->data, -1, OBJ_FROZEN(obj), flags,
+                   &mat4_layout);
+}
+
+static bool mat4_view_release(VALUE obj, rb_memory_view_t *view) {
+  view_release(view);
+  return true;
+}
+
+static bool mat4_view_available(VALUE obj) {
+  return true;
+}
+
+static const rb_memory_view_entry_t mat4_view_entry = {
+    mat4_view_get,
+    mat4_view_release,
+    mat4_view_available,
+};
+
 void Init_mat4(VALUE module) {
   cMat4 = rb_define_class_under(module, "Mat4", rb_cObject);
-  cVec3 = rb_const_get(mLarb, rb_intern("Vec3"));
-  cVec4 = rb_const_get(mLarb, rb_intern("Vec4"));
-  cQuat = rb_const_get(mLarb, rb_intern("Quat"));
+  rb_memory_view_register(cMat4, &mat4_view_entry);
 
   rb_define_alloc_func(cMat4, mat4_alloc);
   rb_define_method(cMat4, "initialize", mat4_initialize, -1);
+  rb_define_method(cMat4, "initialize_copy", mat4_initialize_copy, 1);
 
   rb_define_singleton_method(cMat4, "identity", mat4_class_identity, 0);
   rb_define_singleton_method(cMat4, "zero", mat4_class_zero, 0);
+
   rb_define_singleton_method(cMat4, "translation", mat4_class_translation, 3);
   rb_define_singleton_method(cMat4, "scaling", mat4_class_scaling, 3);
   rb_define_singleton_method(cMat4, "rotation_x", mat4_class_rotation_x, 1);
@@ -651,13 +926,20 @@ void Init_mat4(VALUE module) {
   rb_define_singleton_method(cMat4, "from_quaternion",
                              mat4_class_from_quaternion, 1);
   rb_define_singleton_method(cMat4, "trs", mat4_class_trs, 3);
+  rb_define_singleton_method(cMat4, "multiply", mat4_class_multiply, -1);
 
   rb_define_method(cMat4, "data", mat4_data, 0);
   rb_define_method(cMat4, "[]", mat4_aref, 1);
   rb_define_method(cMat4, "[]=", mat4_aset, 2);
   rb_define_method(cMat4, "*", mat4_mul, 1);
+  rb_define_method(cMat4, "transform_points", mat4_transform_points, -1);
+  rb_define_method(cMat4, "transform_directions", mat4_transform_directions,
+                   -1);
+  rb_define_method(cMat4, "project_points", mat4_project_points, -1);
   rb_define_method(cMat4, "transpose", mat4_transpose, 0);
   rb_define_method(cMat4, "inverse", mat4_inverse, 0);
+  rb_define_method(cMat4, "invert_into", mat4_invert_into, 1);
+  rb_define_method(cMat4, "transpose_into", mat4_transpose_into, 1);
   rb_define_method(cMat4, "to_a", mat4_to_a, 0);
   rb_define_method(cMat4, "determinant", mat4_determinant, 0);
   rb_define_method(cMat4, "+", mat4_add, 1);
@@ -668,4 +950,11 @@ void Init_mat4(VALUE module) {
   rb_define_method(cMat4, "extract_scale", mat4_extract_scale, 0);
   rb_define_method(cMat4, "extract_rotation", mat4_extract_rotation, 0);
   rb_define_method(cMat4, "inspect", mat4_inspect, 0);
+
+  larb_define_constant(cMat4, "IDENTITY", &mat4_const_identity,
+                       mat4_alloc(cMat4));
+  larb_define_constant(cMat4, "ZERO", &mat4_const_zero,
+                       mat4_build16(cMat4, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                    0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                    0.0));
 }
@@ -7,15 +7,36 @@ typedef struct {
   double data[16];
 } Mat4Data;
 
+extern VALUE cMat4;
+
 void Init_mat4(VALUE module);
 VALUE mat4_alloc(VALUE klass);
 VALUE mat4_initialize(int argc, VALUE *argv, VALUE self);
+Mat4Data *mat4_get(VALUE obj);
+VALUE mat4_build(VALUE klass, const double *values);
+
+void mat4_multiply_values(const double *a, const double *b, double *out);
+void mat4_multiply_values_f32(const float *a, const float *b, float *out);
+void mat4_rotation_values(double x, double y, double z, double w,
+                          double *out);
+void mat4_trs_values(const double *t, const double *q, const double *s,
+                     double *out);
+VALUE mat4_apply_vec3_array(const double *m, VALUE points, VALUE out,
+                            double w, int divide);
+void mat4_transpose_values(const double *m, double *out);
+int mat4_invert_values(const double *m, double *out);
+double mat4_determinant_values(const double *m);
 
 VALUE mat4_aref(VALUE self, VALUE index);
 VALUE mat4_aset(VALUE self, VALUE index, VALUE value);
 VALUE mat4_mul(VALUE self, VALUE other);
+VALUE mat4_transform_points(int argc, VALUE *argv, VALUE self);
+VALUE mat4_transform_directions(int argc, VALUE *argv, VALUE self);
+VALUE mat4_project_points(int argc, VALUE *argv, VALUE self);
 VALUE mat4_transpose(VALUE self);
 VALUE mat4_inverse(VALUE self);
+VALUE mat4_invert_into(VALUE self, VALUE out);
+VALUE mat4_transpose_into(VALUE self, VALUE out);
 VALUE mat4_to_a(VALUE self);
 VALUE mat4_determinant(VALUE self);
 VALUE mat4_add(VALUE self, VALUE other);
@@ -0,0 +1,568 @@
+#include "mat4_array.h"
+
+#include <ruby/io/buffer.h>
+
+#include "mat4.h"
+#include "packed_buffer.h"
+#include "quat_array.h"
+#include "simd.h"
+#include "vec3.h"
+#include "vec3_array.h"
+
+#define MAT4_ARRAY_LANES 8
+#define MAT4_ARRAY_EPSILON 1e-10
+
+#define SIMD_KERNELS_HEADER "mat4_array_kernels.h"
+#include "simd_kernels.h"
+#undef SIMD_KERNELS_HEADER
+
+static const double identity[16] = {1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
+                                    0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+
+static const PackedArrayClass mat4_array_class;
+
+static const rb_data_type_t mat4_array_type = {
+    "Mat4Array",
+    {packed_array_mark, RUBY_TYPED_DEFAULT_FREE, packed_array_memsize},
+    0,
+    (void *)&mat4_array_class,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
+};
+
+static const PackedArrayClass mat4_array_class = {
+    &mat4_array_type,
+    16,
+    true,
+    PACKED_FLOAT64,
+    identity,
+    {{"d", 8, 128, 2, {4, 4}, {8, 32}}, {"f", 4, 64, 2, {4, 4}, {4, 16}}},
+};
+
+static VALUE cMat4Array = Qnil;
+
+static size_t element_size(PackedType type) {
+  return packed_array_element_size(&mat4_array_class, type);
+}
+
+Mat4ArrayData *mat4_array_get(VALUE obj) {
+  return packed_array_get(obj, &mat4_array_class);
+}
+
+VALUE mat4_array_build(VALUE klass, long length, PackedType type) {
+  return packed_array_build(klass, &mat4_array_class, length, type);
+}
+
+static VALUE mat4_array_element(Mat4ArrayData *data, long index) {
+  double scratch[16];
+  return mat4_build(cMat4,
+                    packed_read(data->data, data->type, index, 16, scratch));
+}
+
+static double *element_target(void *data, PackedType type, long index,
+                              double *scratch) {
+  if (type == PACKED_FLOAT64) {
+    return (double *)data + index * 16;
+  }
+  return scratch;
+}
+
+static void element_commit(void *data, PackedType type, long index,
+                           const double *scratch) {
+  if (type == PACKED_FLOAT32) {
+    packed_write(data, type, index, 16, scratch);
+  }
+}
+
+static VALUE mat4_array_output(VALUE klass, VALUE out, long length,
+                               PackedType type) {
+  if (NIL_P(out)) {
+    return mat4_array_build(klass, length, type);
+  }
+  if (!rb_obj_is_kind_of(out, cMat4Array)) {
+    rb_raise(rb_eTypeError, "expected Mat4Array for output");
+  }
+  Mat4ArrayData *data = mat4_array_get(out);
+  packed_check_length(length, data->length);
+  packed_type_check(type, data->type);
+  packed_buffer_check_writable(out, data->buffer);
+  return out;
+}
+
+typedef struct {
+  const void *data;
+  PackedType type;
+  long stride;
+  long length;
+  double scratch[16];
+  float narrow[16];
+} Mat4Operand;
+
+static void mat4_array_operand(VALUE value, Mat4Operand *operand) {
+  if (rb_obj_is_kind_of(value, cMat4Array)) {
+    Mat4ArrayData *data = mat4_array_get(value);
+    operand->data = data->data;
+    operand->type = data->type;
+    operand->stride = 1;
+    operand->length = data->length;
+    return;
+  }
+  if (rb_obj_is_kind_of(value, cMat4)) {
+    Mat4Data *m = mat4_get(value);
+    for (int i = 0; i < 16; i++) {
+      operand->scratch[i] = m->data[i];
+      operand->narrow[i] = (float)m->data[i];
+    }
+    operand->data = operand->scratch;
+    operand->type = PACKED_FLOAT64;
+    operand->stride = 0;
+    operand->length = -1;
+    return;
+  }
+  rb_raise(rb_eTypeError, "expected Mat4Array or Mat4");
+}
+
+static const double *mat4_operand_read(const Mat4Operand *operand, long index,
+                                       double *scratch) {
+  return packed_read(operand->data, operand->type, index * operand->stride, 16,
+                     scratch);
+}
+
+static const float *mat4_operand_f32(const Mat4Operand *operand, long index) {
+  if (operand->type == PACKED_FLOAT32) {
+    return (const float *)operand->data + index * operand->stride * 16;
+  }
+  return operand->narrow;
+}
+
+typedef struct {
+  PackedType type;
+  const void *a;
+  const Mat4Operand *lhs;
+  const Mat4Operand *rhs;
+  void *out;
+  long length;
+  long failed;
+  unsigned char *mask;
+} Mat4ArrayJob;
+
+static void multiply_job(void *ptr, long begin, long end) {
+  Mat4ArrayJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    for (long i = begin; i < end; i++) {
+      mat4_multiply_values_f32(mat4_operand_f32(job->lhs, i),
+                               mat4_operand_f32(job->rhs, i),
+                               (float *)job->out + i * 16);
+    }
+    return;
+  }
+  for (long i = begin; i < end; i++) {
+    double as[16];
+    double bs[16];
+    double os[16];
+    mat4_multiply_values(mat4_operand_read(job->lhs, i, as),
+                         mat4_operand_read(job->rhs, i, bs),
+                         element_target(job->out, job->type, i, os));
+    element_commit(job->out, job->type, i, os);
+  }
+}
+
+static void transpose_job(void *ptr, long begin, long end) {
+  Mat4ArrayJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double as[16];
+    double os[16];
+    mat4_transpose_values(packed_read(job->a, job->type, i, 16, as),
+                          element_target(job->out, job->type, i, os));
+    element_commit(job->out, job->type, i, os);
+  }
+}
+
+static void inverse_failed(Mat4ArrayJob *job, long index) {
+  long failed = __atomic_load_n(&job->failed, __ATOMIC_RELAXED);
+  while ((failed < 0 || index < failed) &&
+         !__atomic_compare_exchange_n(&job->failed, &failed, index, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+static void inverse_job(void *ptr, long begin, long end) {
+  Mat4ArrayJob *job = ptr;
+  unsigned char *mask = job->mask == NULL ? NULL : job->mask + begin;
+  long index = 0;
+  if (job->type == PACKED_FLOAT32) {
+    index = SIMD_SELECT(inverse_kernel_f32)((const float *)job->a + begin * 16,
+                                            (float *)job->out + begin * 16,
+                                            mask, end - begin);
+  } else {
+    index = SIMD_SELECT(inverse_kernel_f64)(
+        (const double *)job->a + begin * 16, (double *)job->out + begin * 16,
+        mask, end - begin);
+  }
+  if (index >= 0) {
+    inverse_failed(job, begin + index);
+  }
+}
+
+static void singular_job(void *ptr, long begin, long end) {
+  Mat4ArrayJob *job = ptr;
+  long index = 0;
+  if (job->type == PACKED_FLOAT32) {
+    index = SIMD_SELECT(singular_kernel_f32)(
+        (const float *)job->a + begin * 16, end - begin);
+  } else {
+    index = SIMD_SELECT(singular_kernel_f64)(
+        (const double *)job->a + begin * 16, end - begin);
+  }
+  if (index >= 0) {
+    inverse_failed(job, begin + index);
+  }
+}
+
+static PackedPin mat4_array_pin(VALUE obj) {
+  if (!rb_obj_is_kind_of(obj, cMat4Array)) {
+    return packed_pin(Qnil, Qnil, NULL);
+  }
+  Mat4ArrayData *data = mat4_array_get(obj);
+  return packed_pin(obj, data->buffer, &data->locks);
+}
+
+static void mat4_array_run(PackedJob run, Mat4ArrayJob *job, VALUE a,
+                           VALUE b, VALUE result) {
+  size_t size = (size_t)job->length * element_size(job->type);
+  packed_check_overlap(job->a, size, job->out, size);
+  if (job->lhs != NULL) {
+    packed_check_overlap(job->lhs->data, job->lhs->stride ? size : 0,
+                         job->out, size);
+    packed_check_overlap(job->rhs->data, job->rhs->stride ? size : 0,
+                         job->out, size);
+  }
+  PackedPin pins[3] = {mat4_array_pin(a), mat4_array_pin(b),
+                       mat4_array_pin(result)};
+  packed_run(job->length, run, job, pins, 3);
+}
+
+static void mat4_array_unary(PackedJob run, Mat4ArrayJob *job, VALUE self,
+                             VALUE result) {
+  Mat4ArrayData *a = mat4_array_get(self);
+  job->type = a->type;
+  job->a = a->data;
+  job->out = mat4_array_get(result)->data;
+  job->length = a->length;
+  job->lhs = NULL;
+  job->rhs = NULL;
+  job->failed = -1;
+  job->mask = NULL;
+  mat4_array_run(run, job, self, Qnil, result);
+}
+
+typedef struct {
+  PackedType type;
+  const void *translations;
+  const void *rotations;
+  const void *scales;
+  PackedType scale_type;
+  long scale_stride;
+  void *out;
+  long length;
+} TrsJob;
+
+static void trs_job(void *ptr, long begin, long end) {
+  TrsJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double ts[3];
+    double qs[4];
+    double ss[3];
+    double os[16];
+    mat4_trs_values(
+        packed_read(job->translations, job->type, i, 3, ts),
+        packed_read(job->rotations, job->type, i, 4, qs),
+        packed_read(job->scales, job->scale_type, i * job->scale_stride, 3,
+                    ss),
+        element_target(job->out, job->type, i, os));
+    element_commit(job->out, job->type, i, os);
+  }
+}
+
+VALUE mat4_array_alloc(VALUE klass) {
+  return packed_array_alloc(klass, &mat4_array_class);
+}
+
+static VALUE mat4_array_class_from(int argc, VALUE *argv, VALUE klass) {
+  VALUE matrices = Qnil;
+  VALUE opts = Qnil;
+
+  rb_scan_args(argc, argv, "1:", &matrices, &opts);
+  VALUE ary = rb_check_array_type(matrices);
+  if (NIL_P(ary)) {
+    rb_raise(rb_eTypeError, "expected Array");
+  }
+
+  long length = RARRAY_LEN(ary);
+  VALUE obj = mat4_array_build(klass, length, packed_type_option(opts));
+  Mat4ArrayData *data = mat4_array_get(obj);
+  for (long i = 0; i < length; i++) {
+    Mat4Data *m = mat4_get(rb_ary_entry(ary, i));
+    packed_write(data->data, data->type, i, 16, m->data);
+  }
+  return obj;
+}
+
+static VALUE mat4_array_class_multiply(int argc, VALUE *argv, VALUE klass) {
+  VALUE a = Qnil;
+  VALUE b = Qnil;
+  VALUE out = Qnil;
+  Mat4Operand ad;
+  Mat4Operand bd;
+
+  rb_scan_args(argc, argv, "21", &a, &b, &out);
+  mat4_array_operand(a, &ad);
+  mat4_array_operand(b, &bd);
+  if (ad.length < 0 && bd.length < 0) {
+    rb_raise(rb_eTypeError, "expected at least one Mat4Array");
+  }
+  if (ad.length >= 0 && bd.length >= 0) {
+    packed_check_length(ad.length, bd.length);
+    packed_type_check(ad.type, bd.type);
+  }
+
+  long length = ad.length >= 0 ? ad.length : bd.length;
+  PackedType type = ad.length >= 0 ? ad.type : bd.type;
+  VALUE result = mat4_array_output(klass, out, length, type);
+  Mat4ArrayJob job = {type, NULL, &ad, &bd, mat4_array_get(result)->data,
+                      length, -1, NULL};
+  mat4_array_run(multiply_job, &job, a, b, result);
+  return result;
+}
+
+static VALUE mat4_array_class_trs(int argc, VALUE *argv, VALUE klass) {
+  VALUE translations = Qnil;
+  VALUE rotations = Qnil;
+  VALUE scales = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "31", &translations, &rotations, &scales, &out);
+  Vec3ArrayData *t = vec3_array_get(translations);
+  QuatArrayData *q = quat_array_get(rotations);
+  packed_check_length(t->length, q->length);
+  packed_type_check(t->type, q->type);
+
+  double uniform[3];
+  TrsJob job = {t->type, t->data, q->data, uniform, PACKED_FLOAT64, 0, NULL,
+                t->length};
+  PackedPin scale_pin = packed_pin(Qnil, Qnil, NULL);
+  if (rb_obj_is_kind_of(scales, cVec3)) {
+    Vec3Data *v = vec3_get(scales);
+    uniform[0] = v->x;
+    uniform[1] = v->y;
+    uniform[2] = v->z;
+  } else {
+    Vec3ArrayData *sa = vec3_array_get(scales);
+    packed_check_length(t->length, sa->length);
+    packed_type_check(t->type, sa->type);
+    job.scales = sa->data;
+    job.scale_type = sa->type;
+    job.scale_stride = 1;
+    scale_pin = packed_pin(scales, sa->buffer, &sa->locks);
+  }
+
+  VALUE result = mat4_array_output(klass, out, t->length, t->type);
+  job.out = mat4_array_get(result)->data;
+  size_t scalar = packed_type_size(t->type);
+  size_t size = (size_t)t->length * scalar;
+  packed_check_overlap(job.translations, size * 3, job.out, size * 16);
+  packed_check_overlap(job.rotations, size * 4, job.out, size * 16);
+  packed_check_overlap(job.scales, size * 3 * job.scale_stride, job.out,
+                       size * 16);
+  PackedPin pins[4] = {packed_pin(translations, t->buffer, &t->locks),
+                       packed_pin(rotations, q->buffer, &q->locks), scale_pin,
+                       mat4_array_pin(result)};
+  packed_run(job.length, trs_job, &job, pins, 4);
+  return result;
+}
+
+VALUE mat4_array_aref(VALUE self, VALUE index) {
+  Mat4ArrayData *data = mat4_array_get(self);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    return Qnil;
+  }
+  return mat4_array_element(data, idx);
+}
+
+VALUE mat4_array_aset(VALUE self, VALUE index, VALUE value) {
+  Mat4ArrayData *data = mat4_array_get(self);
+  packed_buffer_check_writable(self, data->buffer);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    rb_raise(rb_eIndexError, "index %ld out of range", NUM2LONG(index));
+  }
+  packed_write(data->data, data->type, idx, 16, mat4_get(value)->data);
+  return value;
+}
+
+VALUE mat4_array_each(VALUE self) {
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, packed_array_length);
+  for (long i = 0; i < mat4_array_get(self)->length; i++) {
+    rb_yield(mat4_array_element(mat4_array_get(self), i));
+  }
+  return self;
+}
+
+VALUE mat4_array_to_a(VALUE self) {
+  Mat4ArrayData *data = mat4_array_get(self);
+  VALUE ary = rb_ary_new_capa(data->length);
+  for (long i = 0; i < data->length; i++) {
+    rb_ary_push(ary, mat4_array_element(data, i));
+  }
+  return ary;
+}
+
+VALUE mat4_array_multiply(int argc, VALUE *argv, VALUE self) {
+  VALUE other = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &other, &out);
+  VALUE args[3] = {self, other, out};
+  return mat4_array_class_multiply(3, args, rb_obj_class(self));
+}
+
+VALUE mat4_array_transpose(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  Mat4ArrayData *a = mat4_array_get(self);
+  VALUE result =
+      mat4_array_output(rb_obj_class(self), out, a->length, a->type);
+  Mat4ArrayJob job;
+  mat4_array_unary(transpose_job, &job, self, result);
+  return result;
+}
+
+static unsigned char *mat4_array_mask(VALUE mask, long length) {
+  void *base = NULL;
+  size_t size = 0;
+
+  if (NIL_P(mask)) {
+    return NULL;
+  }
+  if (!rb_obj_is_kind_of(mask, rb_cIOBuffer)) {
+    rb_raise(rb_eTypeError, "expected IO::Buffer for mask");
+  }
+  rb_io_buffer_get_bytes_for_writing(mask, &base, &size);
+  if (size < (size_t)length) {
+    rb_raise(rb_eArgError, "mask is too small (%zu for %ld)", size, length);
+  }
+  return base;
+}
+
+VALUE mat4_array_inverse(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+  VALUE opts = Qnil;
+  VALUE mask = Qnil;
+  long mask_locks = 0;
+  ID keys[1];
+  VALUE values[1];
+
+  rb_scan_args(argc, argv, "01:", &out, &opts);
+  if (!NIL_P(opts)) {
+    keys[0] = rb_intern("mask");
+    rb_get_kwargs(opts, keys, 0, 1, values);
+    mask = values[0] == Qundef ? Qnil : values[0];
+  }
+  Mat4ArrayData *a = mat4_array_get(self);
+  VALUE result =
+      mat4_array_output(rb_obj_class(self), out, a->length, a->type);
+  Mat4ArrayJob job = {a->type, a->data, NULL, NULL,
+                      mat4_array_get(result)->data, a->length, -1,
+                      mat4_array_mask(mask, a->length)};
+  size_t size = (size_t)a->length * element_size(a->type);
+  packed_check_overlap(job.a, size, job.out, size);
+  packed_check_overlap(job.a, size, job.mask, (size_t)a->length);
+  packed_check_overlap(job.out, size, job.mask, (size_t)a->length);
+  PackedPin pins[3] = {mat4_array_pin(self), mat4_array_pin(result),
+                       packed_pin(Qnil, mask, &mask_locks)};
+  if (job.mask == NULL && job.a == job.out) {
+    packed_run(job.length, singular_job, &job, pins, 3);
+  }
+  if (job.failed < 0) {
+    packed_run(job.length, inverse_job, &job, pins, 3);
+  }
+  if (NIL_P(mask) && job.failed >= 0) {
+    rb_raise(rb_eRuntimeError, "Matrix at index %ld is not invertible",
+             job.failed);
+  }
+  return result;
+}
+
+VALUE mat4_array_determinant(VALUE self) {
+  Mat4ArrayData *a = mat4_array_get(self);
+  VALUE ary = rb_ary_new_capa(a->length);
+  for (long i = 0; i < a->length; i++) {
+    double scratch[16];
+    const double *m = packed_read(a->data, a->type, i, 16, scratch);
+    rb_ary_push(ary, DBL2NUM(mat4_determinant_values(m)));
+  }
+  return ary;
+}
+
+VALUE mat4_array_equal(VALUE self, VALUE other) {
+  if (!rb_obj_is_kind_of(other, cMat4Array)) {
+    return Qfalse;
+  }
+  Mat4ArrayData *a = mat4_array_get(self);
+  Mat4ArrayData *b = mat4_array_get(other);
+  if (a->length != b->length) {
+    return Qfalse;
+  }
+  for (long i = 0; i < a->length; i++) {
+    double as[16];
+    double bs[16];
+    const double *am = packed_read(a->data, a->type, i, 16, as);
+    const double *bm = packed_read(b->data, b->type, i, 16, bs);
+    for (int j = 0; j < 16; j++) {
+      if (am[j] != bm[j]) {
+        return Qfalse;
+      }
+    }
+  }
+  return Qtrue;
+}
+
+VALUE mat4_array_inspect(VALUE self) {
+  Mat4ArrayData *a = mat4_array_get(self);
+  VALUE str = rb_str_new_cstr("Mat4Array[");
+  for (long i = 0; i < a->length; i++) {
+    if (i > 0) {
+      rb_str_cat_cstr(str, ", ");
+    }
+    rb_str_concat(str, rb_inspect(mat4_array_element(a, i)));
+  }
+  rb_str_cat_cstr(str, "]");
+  return str;
+}
+
+void Init_mat4_array(VALUE module) {
+  cMat4Array = rb_define_class_under(module, "Mat4Array", rb_cObject);
+  rb_define_alloc_func(cMat4Array, mat4_array_alloc);
+  packed_array_define(cMat4Array, &mat4_array_class);
+
+  rb_define_singleton_method(cMat4Array, "from", mat4_array_class_from, -1);
+  rb_define_singleton_method(cMat4Array, "multiply", mat4_array_class_multiply,
+                             -1);
+
+  rb_define_singleton_method(cMat4Array, "trs", mat4_array_class_trs, -1);
+
+  rb_define_method(cMat4Array, "[]", mat4_array_aref, 1);
+  rb_define_method(cMat4Array, "[]=", mat4_array_aset, 2);
+  rb_define_method(cMat4Array, "each", mat4_array_each, 0);
+  rb_define_method(cMat4Array, "to_a", mat4_array_to_a, 0);
+
+  rb_define_method(cMat4Array, "multiply", mat4_array_multiply, -1);
+  rb_define_method(cMat4Array, "transpose", mat4_array_transpose, -1);
+  rb_define_method(cMat4Array, "inverse", mat4_array_inverse, -1);
+  rb_define_method(cMat4Array, "determinant", mat4_array_determinant, 0);
+  rb_define_method(cMat4Array, "==", mat4_array_equal, 1);
+  rb_define_method(cMat4Array, "inspect", mat4_array_inspect, 0);
+  rb_define_alias(cMat4Array, "to_s", "inspect");
+}
@@ -0,0 +1,25 @@
+#ifndef MAT4_ARRAY_H
+#define MAT4_ARRAY_H
+
+#include "larb.h"
+#include "packed_buffer.h"
+
+typedef PackedArray Mat4ArrayData;
+
+void Init_mat4_array(VALUE module);
+VALUE mat4_array_alloc(VALUE klass);
+Mat4ArrayData *mat4_array_get(VALUE obj);
+VALUE mat4_array_build(VALUE klass, long length, PackedType type);
+
+VALUE mat4_array_aref(VALUE self, VALUE index);
+VALUE mat4_array_aset(VALUE self, VALUE index, VALUE value);
+VALUE mat4_array_each(VALUE self);
+VALUE mat4_array_to_a(VALUE self);
+VALUE mat4_array_multiply(int argc, VALUE *argv, VALUE self);
+VALUE mat4_array_transpose(int argc, VALUE *argv, VALUE self);
+VALUE mat4_array_inverse(int argc, VALUE *argv, VALUE self);
+VALUE mat4_array_determinant(VALUE self);
+VALUE mat4_array_equal(VALUE self, VALUE other);
+VALUE mat4_array_inspect(VALUE self);
+
+#endif
@@ -0,0 +1,120 @@
+static inline void KERNEL(load)(const SCALAR *src, long base, long lanes,
+                                SCALAR m[16][MAT4_ARRAY_LANES]) {
+  for (int k = 0; k < MAT4_ARRAY_LANES; k++) {
+    const SCALAR *s = src + (base + (k < lanes ? k : 0)) * 16;
+    for (int e = 0; e < 16; e++) {
+      m[e][k] = s[e];
+    }
+  }
+}
+
+static inline SCALAR KERNEL(cofactors)(SCALAR m[16][MAT4_ARRAY_LANES], int k,
+                                       SCALAR *b) {
+  b[0] = m[0][k] * m[5][k] - m[1][k] * m[4][k];
+  b[1] = m[0][k] * m[6][k] - m[2][k] * m[4][k];
+  b[2] = m[0][k] * m[7][k] - m[3][k] * m[4][k];
+  b[3] = m[1][k] * m[6][k] - m[2][k] * m[5][k];
+  b[4] = m[1][k] * m[7][k] - m[3][k] * m[5][k];
+  b[5] = m[2][k] * m[7][k] - m[3][k] * m[6][k];
+  b[6] = m[8][k] * m[13][k] - m[9][k] * m[12][k];
+  b[7] = m[8][k] * m[14][k] - m[10][k] * m[12][k];
+  b[8] = m[8][k] * m[15][k] - m[11][k] * m[12][k];
+  b[9] = m[9][k] * m[14][k] - m[10][k] * m[13][k];
+  b[10] = m[9][k] * m[15][k] - m[11][k] * m[13][k];
+  b[11] = m[10][k] * m[15][k] - m[11][k] * m[14][k];
+  return b[0] * b[11] - b[1] * b[10] + b[2] * b[9] + b[3] * b[8] -
+         b[4] * b[7] + b[5] * b[6];
+}
+
+static long KERNEL(singular)(const SCALAR *src, long n) {
+  for (long base = 0; base < n; base += MAT4_ARRAY_LANES) {
+    long lanes = n - base < MAT4_ARRAY_LANES ? n - base : MAT4_ARRAY_LANES;
+    SCALAR m[16][MAT4_ARRAY_LANES];
+    int singular[MAT4_ARRAY_LANES];
+
+    KERNEL(load)(src, base, lanes, m);
+    for (int k = 0; k < MAT4_ARRAY_LANES; k++) {
+      SCALAR b[12];
+      SCALAR det = KERNEL(cofactors)(m, k, b);
+      singular[k] = det < MAT4_ARRAY_EPSILON && det > -MAT4_ARRAY_EPSILON;
+    }
+    for (long k = 0; k < lanes; k++) {
+      if (singular[k]) {
+        return base + k;
+      }
+    }
+  }
+  return -1;
+}
+
+static long KERNEL(inverse)(const SCALAR *src, SCALAR *dst,
+                            unsigned char *mask, long n) {
+  long failed = -1;
+
+  for (long base = 0; base < n; base += MAT4_ARRAY_LANES) {
+    long lanes = n - base < MAT4_ARRAY_LANES ? n - base : MAT4_ARRAY_LANES;
+    SCALAR m[16][MAT4_ARRAY_LANES];
+    SCALAR inv[16][MAT4_ARRAY_LANES];
+    int singular[MAT4_ARRAY_LANES];
+
+    KERNEL(load)(src, base, lanes, m);
+
+    for (int k = 0; k < MAT4_ARRAY_LANES; k++) {
+      SCALAR a00 = m[0][k];
+      SCALAR a01 = m[1][k];
+      SCALAR a02 = m[2][k];
+      SCALAR a03 = m[3][k];
+      SCALAR a10 = m[4][k];
+      SCALAR a11 = m[5][k];
+      SCALAR a12 = m[6][k];
+      SCALAR a13 = m[7][k];
+      SCALAR a20 = m[8][k];
+      SCALAR a21 = m[9][k];
+      SCALAR a22 = m[10][k];
+      SCALAR a23 = m[11][k];
+      SCALAR a30 = m[12][k];
+      SCALAR a31 = m[13][k];
+      SCALAR a32 = m[14][k];
+      SCALAR a33 = m[15][k];
+
+      SCALAR b[12];
+      SCALAR det = KERNEL(cofactors)(m, k, b);
+      singular[k] = det < MAT4_ARRAY_EPSILON && det > -MAT4_ARRAY_EPSILON;
+      double r = singular[k] ? 0.0 : 1.0 / det;
+
+      inv[0][k] = (SCALAR)((a11 * b[11] - a12 * b[10] + a13 * b[9]) * r);
+      inv[1][k] = (SCALAR)((a02 * b[10] - a01 * b[11] - a03 * b[9]) * r);
+      inv[2][k] = (SCALAR)((a31 * b[5] - a32 * b[4] + a33 * b[3]) * r);
+      inv[3][k] = (SCALAR)((a22 * b[4] - a21 * b[5] - a23 * b[3]) * r);
+      inv[4][k] = (SCALAR)((a12 * b[8] - a10 * b[11] - a13 * b[7]) * r);
+      inv[5][k] = (SCALAR)((a00 * b[11] - a02 * b[8] + a03 * b[7]) * r);
+      inv[6][k] = (SCALAR)((a32 * b[2] - a30 * b[5] - a33 * b[1]) * r);
+      inv[7][k] = (SCALAR)((a20 * b[5] - a22 * b[2] + a23 * b[1]) * r);
+      inv[8][k] = (SCALAR)((a10 * b[10] - a11 * b[8] + a13 * b[6]) * r);
+      inv[9][k] = (SCALAR)((a01 * b[8] - a00 * b[10] - a03 * b[6]) * r);
+      inv[10][k] = (SCALAR)((a30 * b[4] - a31 * b[2] + a33 * b[0]) * r);
+      inv[11][k] = (SCALAR)((a21 * b[2] - a20 * b[4] - a23 * b[0]) * r);
+      inv[12][k] = (SCALAR)((a11 * b[7] - a10 * b[9] - a12 * b[6]) * r);
+      inv[13][k] = (SCALAR)((a00 * b[9] - a01 * b[7] + a02 * b[6]) * r);
+      inv[14][k] = (SCALAR)((a31 * b[1] - a30 * b[3] - a32 * b[0]) * r);
+      inv[15][k] = (SCALAR)((a20 * b[3] - a21 * b[1] + a22 * b[0]) * r);
+    }
+
+    for (long k = 0; k < lanes; k++) {
+      if (mask != NULL) {
+        mask[base + k] = (unsigned char)singular[k];
+      }
+      if (singular[k]) {
+        if (failed < 0) {
+          failed = base + k;
+        }
+        continue;
+      }
+      SCALAR *d = dst + (base + k) * 16;
+      for (int e = 0; e < 16; e++) {
+        d[e] = inv[e][k];
+      }
+    }
+  }
+  return failed;
+}
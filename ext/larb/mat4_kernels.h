@@ -0,0 +1,25 @@
+static void KERNEL(transform)(const double *matrix, const SCALAR *src,
+                              SCALAR *dst, long n, SCALAR w, int divide) {
+  SCALAR m[16];
+  for (int i = 0; i < 16; i++) {
+    m[i] = (SCALAR)matrix[i];
+  }
+  for (long i = 0; i < n; i++) {
+    const SCALAR *v = src + i * 3;
+    SCALAR *o = dst + i * 3;
+    SCALAR x = m[0] * v[0] + m[4] * v[1] + m[8] * v[2] + m[12] * w;
+    SCALAR y = m[1] * v[0] + m[5] * v[1] + m[9] * v[2] + m[13] * w;
+    SCALAR z = m[2] * v[0] + m[6] * v[1] + m[10] * v[2] + m[14] * w;
+    if (divide) {
+      SCALAR rw = m[3] * v[0] + m[7] * v[1] + m[11] * v[2] + m[15] * w;
+      if (rw != 0 && rw != 1) {
+        x /= rw;
+        y /= rw;
+        z /= rw;
+      }
+    }
+    o[0] = x;
+    o[1] = y;
+    o[2] = z;
+  }
+}
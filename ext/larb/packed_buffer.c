@@ -0,0 +1,652 @@
+#include "packed_buffer.h"
+
+#include <ruby/io/buffer.h>
+#include <ruby/thread.h>
+#include <stdint.h>
+
+#include "task.h"
+#include "thread_pool.h"
+
+static long gvl_threshold = 65536;
+static ID id_parent;
+
+static VALUE packed_buffer_parent(VALUE buffer) {
+  if (NIL_P(buffer) || RB_TYPE_P(buffer, T_STRING)) {
+    return Qnil;
+  }
+  return rb_ivar_get(buffer, id_parent);
+}
+
+VALUE packed_buffer_new(long count, size_t element_size) {
+  if ((size_t)count > SIZE_MAX / element_size) {
+    rb_raise(rb_eArgError, "array size too big");
+  }
+  return rb_io_buffer_new(NULL, (size_t)count * element_size,
+                          RB_IO_BUFFER_INTERNAL);
+}
+
+void *packed_buffer_pointer(VALUE buffer, long count, size_t element_size) {
+  void *base = NULL;
+  size_t available = 0;
+  size_t size = (size_t)count * element_size;
+
+  if (RB_TYPE_P(buffer, T_STRING)) {
+    base = RSTRING_PTR(buffer);
+    available = (size_t)RSTRING_LEN(buffer);
+  } else {
+    rb_io_buffer_get_bytes(buffer, &base, &available);
+  }
+  if (available < size) {
+    rb_raise(rb_eRuntimeError, "backing buffer is too small (%zu for %zu)",
+             available, size);
+  }
+  return base;
+}
+
+void packed_buffer_check_writable(VALUE owner, VALUE buffer) {
+  void *base = NULL;
+  size_t size = 0;
+
+  rb_check_frozen(owner);
+  if (NIL_P(buffer) || RB_TYPE_P(buffer, T_STRING)) {
+    return;
+  }
+  rb_io_buffer_get_bytes_for_writing(buffer, &base, &size);
+}
+
+bool packed_buffer_readonly(VALUE buffer) {
+  void *base = NULL;
+  size_t size = 0;
+
+  if (NIL_P(buffer)) {
+    return false;
+  }
+  if (RB_TYPE_P(buffer, T_STRING)) {
+    return true;
+  }
+  return (rb_io_buffer_get_bytes(buffer, &base, &size) &
+          RB_IO_BUFFER_READONLY) != 0;
+}
+
+bool packed_buffer_lock(VALUE buffer, long *locks) {
+  void *base = NULL;
+  size_t size = 0;
+
+  if (NIL_P(buffer) || RB_TYPE_P(buffer, T_STRING)) {
+    return true;
+  }
+  if (*locks == 0) {
+    if (rb_io_buffer_get_bytes(buffer, &base, &size) & RB_IO_BUFFER_LOCKED) {
+      return false;
+    }
+    rb_io_buffer_lock(buffer);
+  }
+  (*locks)++;
+  return true;
+}
+
+void packed_buffer_unlock(VALUE buffer, long *locks) {
+  if (NIL_P(buffer) || RB_TYPE_P(buffer, T_STRING) || *locks == 0) {
+    return;
+  }
+  (*locks)--;
+  if (*locks == 0) {
+    rb_io_buffer_unlock(buffer);
+  }
+}
+
+void packed_buffer_check_unlocked(long locks) {
+  if (locks > 0) {
+    rb_raise(rb_eRuntimeError, "can't reallocate an exported array");
+  }
+}
+
+void *packed_buffer_freeze(VALUE owner, VALUE *buffer, long locks,
+                           const void *data, size_t size) {
+  if (RB_TYPE_P(*buffer, T_STRING)) {
+    return (void *)data;
+  }
+  packed_buffer_check_unlocked(locks);
+  VALUE str = rb_obj_freeze(rb_str_new(data, (long)size));
+  RB_OBJ_WRITE(owner, buffer, str);
+  return RSTRING_PTR(str);
+}
+
+VALUE packed_buffer_export(VALUE buffer) {
+  if (RB_TYPE_P(buffer, T_STRING)) {
+    return rb_funcall(rb_cIOBuffer, rb_intern("for"), 1, buffer);
+  }
+  return buffer;
+}
+
+VALUE packed_buffer_view(VALUE buffer, long length, VALUE offset, VALUE count,
+                         size_t element_size, long *view_length) {
+  long first = NUM2LONG(offset);
+  long size = NUM2LONG(count);
+
+  if (first < 0 || first > length) {
+    rb_raise(rb_eIndexError, "offset %ld out of range", first);
+  }
+  if (size < 0) {
+    rb_raise(rb_eArgError, "negative view length");
+  }
+  if (size > length - first) {
+    size = length - first;
+  }
+  *view_length = size;
+  if (NIL_P(buffer)) {
+    return packed_buffer_new(0, element_size);
+  }
+  VALUE start = SIZET2NUM((size_t)first * element_size);
+  VALUE bytes = SIZET2NUM((size_t)size * element_size);
+  if (!packed_buffer_readonly(buffer)) {
+    VALUE parent = packed_buffer_parent(buffer);
+    VALUE slice = rb_funcall(buffer, rb_intern("slice"), 2, start, bytes);
+    rb_ivar_set(slice, id_parent, NIL_P(parent) ? buffer : parent);
+    return slice;
+  }
+  VALUE string = RB_TYPE_P(buffer, T_STRING)
+                     ? rb_str_substr(buffer, NUM2LONG(start), NUM2LONG(bytes))
+                     : rb_funcall(buffer, rb_intern("get_string"), 2, start,
+                                  bytes);
+  return packed_buffer_export(rb_str_freeze(string));
+}
+
+void packed_check_overlap(const void *src, size_t src_size, const void *dst,
+                          size_t dst_size) {
+  uintptr_t from = (uintptr_t)src;
+  uintptr_t to = (uintptr_t)dst;
+
+  if (src == NULL || src_size == 0 || dst_size == 0 ||
+      (src == dst && src_size == dst_size)) {
+    return;
+  }
+  if (from < to + dst_size && to < from + src_size) {
+    rb_raise(rb_eArgError, "output overlaps an input");
+  }
+}
+
+PackedPin packed_pin(VALUE owner, VALUE buffer, long *locks) {
+  PackedPin pin = {owner, buffer, packed_buffer_parent(buffer), locks, false,
+                   false};
+  return pin;
+}
+
+static bool packed_pin_shared(PackedPin *pins, int index) {
+  for (int i = 0; i < index; i++) {
+    if (pins[i].locked && pins[i].buffer == pins[index].buffer) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool packed_parent_shared(PackedPin *pins, int count, int index) {
+  for (int i = 0; i < count; i++) {
+    if (pins[i].buffer == pins[index].parent ||
+        (i < index && pins[i].parent_locked &&
+         pins[i].parent == pins[index].parent)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void packed_unpin(PackedPin *pins, int count) {
+  for (int i = count - 1; i >= 0; i--) {
+    if (pins[i].parent_locked) {
+      rb_io_buffer_unlock(pins[i].parent);
+      pins[i].parent_locked = false;
+    }
+    if (pins[i].locked) {
+      packed_buffer_unlock(pins[i].buffer, pins[i].locks);
+      pins[i].locked = false;
+    }
+  }
+}
+
+static bool packed_pin_all(PackedPin *pins, int count) {
+  for (int i = 0; i < count; i++) {
+    if (NIL_P(pins[i].buffer) || packed_pin_shared(pins, i)) {
+      continue;
+    }
+    if (!packed_buffer_lock(pins[i].buffer, pins[i].locks)) {
+      packed_unpin(pins, i);
+      return false;
+    }
+    pins[i].locked = true;
+  }
+  for (int i = 0; i < count; i++) {
+    void *base = NULL;
+    size_t size = 0;
+
+    if (NIL_P(pins[i].parent) || packed_parent_shared(pins, count, i)) {
+      continue;
+    }
+    if (rb_io_buffer_get_bytes(pins[i].parent, &base, &size) &
+        RB_IO_BUFFER_LOCKED) {
+      packed_unpin(pins, count);
+      return false;
+    }
+    rb_io_buffer_lock(pins[i].parent);
+    pins[i].parent_locked = true;
+  }
+  return true;
+}
+
+typedef struct {
+  PackedJob job;
+  void *arg;
+  long length;
+  PackedPin *pins;
+  int count;
+} PackedRun;
+
+static void *packed_run_job(void *ptr) {
+  PackedRun *run = ptr;
+  thread_pool_run(run->job, run->arg, run->length);
+  return NULL;
+}
+
+static VALUE packed_run_without_gvl(VALUE ptr) {
+  rb_thread_call_without_gvl(packed_run_job, (void *)ptr, NULL, NULL);
+  return Qnil;
+}
+
+static VALUE packed_run_unpin(VALUE ptr) {
+  PackedRun *run = (PackedRun *)ptr;
+  packed_unpin(run->pins, run->count);
+  return Qnil;
+}
+
+void packed_run(long length, PackedJob job, void *arg, PackedPin *pins,
+                int count) {
+  if (((gvl_threshold < 0 || length < gvl_threshold) && !task_current_p()) ||
+      !packed_pin_all(pins, count)) {
+    thread_pool_run(job, arg, length);
+    return;
+  }
+  PackedRun run = {job, arg, length, pins, count};
+  rb_ensure(packed_run_without_gvl, (VALUE)&run, packed_run_unpin,
+            (VALUE)&run);
+}
+
+long packed_buffer_wrap_length(VALUE buffer, VALUE length,
+                               size_t element_size) {
+  void *base = NULL;
+  size_t size = 0;
+
+  if (!rb_obj_is_kind_of(buffer, rb_cIOBuffer)) {
+    rb_raise(rb_eTypeError, "expected IO::Buffer");
+  }
+  rb_io_buffer_get_bytes(buffer, &base, &size);
+  if ((uintptr_t)base % sizeof(double) != 0) {
+    rb_raise(rb_eArgError, "buffer is not aligned to %zu bytes",
+             sizeof(double));
+  }
+
+  if (NIL_P(length)) {
+    if (size % element_size != 0) {
+      rb_raise(rb_eArgError, "buffer size %zu is not a multiple of %zu", size,
+               element_size);
+    }
+    return (long)(size / element_size);
+  }
+
+  long count = NUM2LONG(length);
+  if (count < 0) {
+    rb_raise(rb_eArgError, "negative array size");
+  }
+  if ((size_t)count > size / element_size) {
+    rb_raise(rb_eArgError, "buffer is too small (%zu for %zu)", size,
+             (size_t)count * element_size);
+  }
+  return count;
+}
+
+size_t packed_type_size(PackedType type) {
+  return type == PACKED_FLOAT32 ? sizeof(float) : sizeof(double);
+}
+
+PackedType packed_type_parse(VALUE type) {
+  if (NIL_P(type)) {
+    return PACKED_FLOAT64;
+  }
+  if (SYMBOL_P(type)) {
+    ID id = SYM2ID(type);
+    if (id == rb_intern("float64")) {
+      return PACKED_FLOAT64;
+    }
+    if (id == rb_intern("float32")) {
+      return PACKED_FLOAT32;
+    }
+  }
+  rb_raise(rb_eArgError, "unknown element type %+" PRIsVALUE
+                         " (expected :float64 or :float32)",
+           type);
+  return PACKED_FLOAT64;
+}
+
+PackedType packed_type_option(VALUE opts) {
+  ID keys[1];
+  VALUE values[1];
+
+  if (NIL_P(opts)) {
+    return PACKED_FLOAT64;
+  }
+  keys[0] = rb_intern("type");
+  rb_get_kwargs(opts, keys, 0, 1, values);
+  return packed_type_parse(values[0] == Qundef ? Qnil : values[0]);
+}
+
+VALUE packed_type_symbol(PackedType type) {
+  return ID2SYM(rb_intern(type == PACKED_FLOAT32 ? "float32" : "float64"));
+}
+
+void packed_type_check(PackedType expected, PackedType actual) {
+  if (expected != actual) {
+    rb_raise(rb_eArgError, "element type mismatch (%" PRIsVALUE
+                           " for %" PRIsVALUE ")",
+             packed_type_symbol(actual), packed_type_symbol(expected));
+  }
+}
+
+void packed_convert(const void *src, PackedType src_type, void *dst,
+                    PackedType dst_type, long count) {
+  if (src_type == dst_type) {
+    memmove(dst, src, packed_type_size(src_type) * (size_t)count);
+    return;
+  }
+  if (src_type == PACKED_FLOAT64) {
+    const double *from = src;
+    float *to = dst;
+    for (long i = 0; i < count; i++) {
+      to[i] = (float)from[i];
+    }
+    return;
+  }
+  const float *from = src;
+  double *to = dst;
+  for (long i = 0; i < count; i++) {
+    to[i] = from[i];
+  }
+}
+
+void packed_array_mark(void *ptr) {
+  PackedArray *data = ptr;
+  rb_gc_mark(data->buffer);
+}
+
+size_t packed_array_memsize(const void *ptr) {
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(PackedArray);
+}
+
+static const PackedArrayClass *packed_array_class_of(VALUE obj) {
+  if (!RB_TYPE_P(obj, T_DATA) || !RTYPEDDATA_P(obj) ||
+      RTYPEDDATA_TYPE(obj)->function.dmark != packed_array_mark) {
+    rb_raise(rb_eTypeError, "expected a packed array");
+  }
+  return RTYPEDDATA_TYPE(obj)->data;
+}
+
+size_t packed_array_element_size(const PackedArrayClass *klass,
+                                 PackedType type) {
+  return (size_t)klass->width * packed_type_size(type);
+}
+
+PackedArray *packed_array_get(VALUE obj, const PackedArrayClass *klass) {
+  PackedArray *data = rb_check_typeddata(obj, klass->data_type);
+  if (!NIL_P(data->buffer)) {
+    data->data = packed_buffer_pointer(
+        data->buffer, data->length,
+        packed_array_element_size(klass, data->type));
+  }
+  return data;
+}
+
+VALUE packed_array_alloc(VALUE klass, const PackedArrayClass *type) {
+  PackedArray *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, PackedArray, type->data_type, data);
+  data->data = NULL;
+  data->length = 0;
+  data->buffer = Qnil;
+  data->locks = 0;
+  data->type = type->type;
+  return obj;
+}
+
+void packed_array_resize(VALUE obj, PackedArray *data, long length,
+                         PackedType type) {
+  const PackedArrayClass *klass = packed_array_class_of(obj);
+  size_t size = packed_array_element_size(klass, type);
+
+  if (length < 0) {
+    rb_raise(rb_eArgError, "negative array size");
+  }
+  rb_check_frozen(obj);
+  packed_buffer_check_unlocked(data->locks);
+  VALUE buffer = packed_buffer_new(length, size);
+  RB_OBJ_WRITE(obj, &data->buffer, buffer);
+  data->length = length;
+  data->type = type;
+  data->data = packed_buffer_pointer(data->buffer, length, size);
+  if (klass->fill != NULL) {
+    for (long i = 0; i < length; i++) {
+      packed_write(data->data, type, i, klass->width, klass->fill);
+    }
+  }
+}
+
+VALUE packed_array_build(VALUE klass, const PackedArrayClass *type,
+                         long length, PackedType element) {
+  VALUE obj = packed_array_alloc(klass, type);
+  packed_array_resize(obj, packed_array_get(obj, type), length, element);
+  return obj;
+}
+
+PackedType packed_array_type_option(const PackedArrayClass *klass,
+                                    VALUE opts) {
+  if (klass->typed) {
+    return packed_type_option(opts);
+  }
+  ID keys[1] = {0};
+  if (!NIL_P(opts)) {
+    rb_get_kwargs(opts, keys, 0, 0, NULL);
+  }
+  return klass->type;
+}
+
+long packed_array_index(const PackedArray *data, VALUE index) {
+  long idx = NUM2LONG(index);
+  if (idx < 0) {
+    idx += data->length;
+  }
+  return idx;
+}
+
+void packed_check_length(long expected, long actual) {
+  if (expected != actual) {
+    rb_raise(rb_eArgError, "length mismatch (%ld for %ld)", actual, expected);
+  }
+}
+
+static VALUE packed_array_wrap(VALUE obj, VALUE buffer, long count,
+                               PackedType type) {
+  const PackedArrayClass *klass = packed_array_class_of(obj);
+  PackedArray *data = packed_array_get(obj, klass);
+  RB_OBJ_WRITE(obj, &data->buffer, buffer);
+  data->length = count;
+  data->type = type;
+  data->data = packed_buffer_pointer(
+      buffer, count, packed_array_element_size(klass, type));
+  return obj;
+}
+
+static VALUE packed_array_initialize(int argc, VALUE *argv, VALUE self) {
+  VALUE length = Qnil;
+  VALUE opts = Qnil;
+  const PackedArrayClass *klass = packed_array_class_of(self);
+
+  rb_scan_args(argc, argv, "01:", &length, &opts);
+  PackedType type = packed_array_type_option(klass, opts);
+  packed_array_resize(self, packed_array_get(self, klass),
+                      NIL_P(length) ? 0 : NUM2LONG(length), type);
+  return self;
+}
+
+static VALUE packed_array_initialize_copy(VALUE self, VALUE other) {
+  const PackedArrayClass *klass = packed_array_class_of(self);
+  PackedArray *data = packed_array_get(self, klass);
+  PackedArray *src = packed_array_get(other, klass);
+  if (data == src) {
+    return self;
+  }
+  packed_array_resize(self, data, src->length, src->type);
+  packed_convert(src->data, src->type, data->data, data->type,
+                 klass->width * src->length);
+  return self;
+}
+
+static VALUE packed_array_class_from_io_buffer(int argc, VALUE *argv,
+                                               VALUE klass) {
+  VALUE buffer = Qnil;
+  VALUE length = Qnil;
+  VALUE opts = Qnil;
+
+  rb_scan_args(argc, argv, "11:", &buffer, &length, &opts);
+  VALUE obj = rb_obj_alloc(klass);
+  const PackedArrayClass *type = packed_array_class_of(obj);
+  PackedType element = packed_array_type_option(type, opts);
+  long count = packed_buffer_wrap_length(
+      buffer, length, packed_array_element_size(type, element));
+  return packed_array_wrap(obj, buffer, count, element);
+}
+
+static VALUE packed_array_freeze(VALUE self) {
+  if (!OBJ_FROZEN(self)) {
+    const PackedArrayClass *klass = packed_array_class_of(self);
+    PackedArray *data = packed_array_get(self, klass);
+    size_t size =
+        (size_t)data->length * packed_array_element_size(klass, data->type);
+    data->data = packed_buffer_freeze(self, &data->buffer, data->locks,
+                                      data->data, size);
+  }
+  return rb_obj_freeze(self);
+}
+
+static VALUE packed_array_view(VALUE self, VALUE offset, VALUE length) {
+  const PackedArrayClass *klass = packed_array_class_of(self);
+  PackedArray *a = packed_array_get(self, klass);
+  long count = 0;
+  VALUE buffer =
+      packed_buffer_view(a->buffer, a->length, offset, length,
+                         packed_array_element_size(klass, a->type), &count);
+  return packed_array_wrap(packed_array_alloc(rb_obj_class(self), klass),
+                           buffer, count, a->type);
+}
+
+static VALUE packed_array_to_io_buffer(VALUE self) {
+  PackedArray *data = packed_array_get(self, packed_array_class_of(self));
+  if (NIL_P(data->buffer)) {
+    packed_array_resize(self, data, 0, data->type);
+  }
+  return packed_buffer_export(data->buffer);
+}
+
+VALUE packed_array_length(VALUE self) {
+  return LONG2NUM(packed_array_get(self, packed_array_class_of(self))->length);
+}
+
+static VALUE packed_array_element_type(VALUE self) {
+  return packed_type_symbol(
+      packed_array_get(self, packed_array_class_of(self))->type);
+}
+
+static VALUE packed_array_convert(VALUE self, VALUE type) {
+  const PackedArrayClass *klass = packed_array_class_of(self);
+  PackedArray *a = packed_array_get(self, klass);
+  VALUE result = packed_array_build(rb_obj_class(self), klass, a->length,
+                                    packed_type_parse(type));
+  PackedArray *data = packed_array_get(result, klass);
+  packed_convert(a->data, a->type, data->data, data->type,
+                 klass->width * a->length);
+  return result;
+}
+
+static bool packed_array_view_get(VALUE obj, rb_memory_view_t *view,
+                                  int flags) {
+  const PackedArrayClass *klass = packed_array_class_of(obj);
+  PackedArray *data = packed_array_get(obj, klass);
+  if (!packed_buffer_lock(data->buffer, &data->locks)) {
+    return false;
+  }
+  bool readonly = packed_buffer_readonly(data->buffer);
+  if (!view_fill(view, obj, data->data, data->length, readonly, flags,
+                 &klass->layouts[data->type])) {
+    packed_buffer_unlock(data->buffer, &data->locks);
+    return false;
+  }
+  return true;
+}
+
+static bool packed_array_view_release(VALUE obj, rb_memory_view_t *view) {
+  PackedArray *data = packed_array_get(obj, packed_array_class_of(obj));
+  packed_buffer_unlock(data->buffer, &data->locks);
+  view_release(view);
+  return true;
+}
+
+static bool packed_array_view_available(VALUE obj) {
+  return true;
+}
+
+static const rb_memory_view_entry_t packed_array_view_entry = {
+    packed_array_view_get,
+    packed_array_view_release,
+    packed_array_view_available,
+};
+
+void packed_array_define(VALUE klass, const PackedArrayClass *type) {
+  rb_include_module(klass, rb_mEnumerable);
+  rb_memory_view_register(klass, &packed_array_view_entry);
+
+  rb_define_method(klass, "initialize", packed_array_initialize, -1);
+  rb_define_method(klass, "initialize_copy", packed_array_initialize_copy, 1);
+  rb_define_singleton_method(klass, "from_io_buffer",
+                             packed_array_class_from_io_buffer, -1);
+
+  rb_define_method(klass, "length", packed_array_length, 0);
+  rb_define_alias(klass, "size", "length");
+  if (type->typed) {
+    rb_define_method(klass, "type", packed_array_element_type, 0);
+    rb_define_method(klass, "convert", packed_array_convert, 1);
+  }
+  rb_define_method(klass, "to_io_buffer", packed_array_to_io_buffer, 0);
+  rb_define_method(klass, "freeze", packed_array_freeze, 0);
+  rb_define_method(klass, "view", packed_array_view, 2);
+}
+
+static VALUE larb_gvl_threshold(VALUE self) {
+  return gvl_threshold < 0 ? Qnil : LONG2NUM(gvl_threshold);
+}
+
+static VALUE larb_set_gvl_threshold(VALUE self, VALUE threshold) {
+  larb_check_main_ractor("Larb.gvl_threshold");
+  if (NIL_P(threshold)) {
+    gvl_threshold = -1;
+    return threshold;
+  }
+  long value = NUM2LONG(threshold);
+  if (value < 0) {
+    rb_raise(rb_eArgError, "negative threshold");
+  }
+  gvl_threshold = value;
+  return threshold;
+}
+
+void Init_packed_buffer(VALUE module) {
+  id_parent = rb_intern("__larb_parent__");
+  rb_define_singleton_method(module, "gvl_threshold", larb_gvl_threshold, 0);
+  rb_define_singleton_method(module, "gvl_threshold=", larb_set_gvl_threshold,
+                             1);
+}
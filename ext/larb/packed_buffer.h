@@ -0,0 +1,115 @@
+#ifndef PACKED_BUFFER_H
+#define PACKED_BUFFER_H
+
+#include "larb.h"
+#include "view.h"
+
+typedef enum {
+  PACKED_FLOAT64,
+  PACKED_FLOAT32,
+} PackedType;
+
+typedef struct {
+  VALUE owner;
+  VALUE buffer;
+  VALUE parent;
+  long *locks;
+  bool locked;
+  bool parent_locked;
+} PackedPin;
+
+typedef void (*PackedJob)(void *arg, long begin, long end);
+
+typedef struct {
+  void *data;
+  long length;
+  VALUE buffer;
+  long locks;
+  PackedType type;
+} PackedArray;
+
+typedef struct {
+  const rb_data_type_t *data_type;
+  int width;
+  bool typed;
+  PackedType type;
+  const double *fill;
+  ViewLayout layouts[2];
+} PackedArrayClass;
+
+void Init_packed_buffer(VALUE module);
+
+VALUE packed_buffer_new(long count, size_t element_size);
+void *packed_buffer_pointer(VALUE buffer, long count, size_t element_size);
+void packed_buffer_check_writable(VALUE owner, VALUE buffer);
+bool packed_buffer_readonly(VALUE buffer);
+bool packed_buffer_lock(VALUE buffer, long *locks);
+void packed_buffer_unlock(VALUE buffer, long *locks);
+void packed_buffer_check_unlocked(long locks);
+void *packed_buffer_freeze(VALUE owner, VALUE *buffer, long locks,
+                           const void *data, size_t size);
+VALUE packed_buffer_export(VALUE buffer);
+VALUE packed_buffer_view(VALUE buffer, long length, VALUE offset, VALUE count,
+                         size_t element_size, long *view_length);
+void packed_check_overlap(const void *src, size_t src_size, const void *dst,
+                          size_t dst_size);
+PackedPin packed_pin(VALUE owner, VALUE buffer, long *locks);
+void packed_run(long length, PackedJob job, void *arg, PackedPin *pins,
+                int count);
+long packed_buffer_wrap_length(VALUE buffer, VALUE length,
+                               size_t element_size);
+
+void packed_array_mark(void *ptr);
+size_t packed_array_memsize(const void *ptr);
+size_t packed_array_element_size(const PackedArrayClass *klass,
+                                 PackedType type);
+PackedArray *packed_array_get(VALUE obj, const PackedArrayClass *klass);
+VALUE packed_array_alloc(VALUE klass, const PackedArrayClass *type);
+void packed_array_resize(VALUE obj, PackedArray *data, long length,
+                         PackedType type);
+VALUE packed_array_build(VALUE klass, const PackedArrayClass *type,
+                         long length, PackedType element);
+PackedType packed_array_type_option(const PackedArrayClass *klass,
+                                    VALUE opts);
+long packed_array_index(const PackedArray *data, VALUE index);
+void packed_check_length(long expected, long actual);
+VALUE packed_array_length(VALUE self);
+void packed_array_define(VALUE klass, const PackedArrayClass *type);
+
+size_t packed_type_size(PackedType type);
+PackedType packed_type_option(VALUE opts);
+PackedType packed_type_parse(VALUE type);
+VALUE packed_type_symbol(PackedType type);
+void packed_type_check(PackedType expected, PackedType actual);
+void packed_convert(const void *src, PackedType src_type, void *dst,
+                    PackedType dst_type, long count);
+
+static inline const double *packed_read(const void *data, PackedType type,
+                                        long index, int width,
+                                        double *scratch) {
+  if (type == PACKED_FLOAT64) {
+    return (const double *)data + index * width;
+  }
+  const float *src = (const float *)data + index * width;
+  for (int i = 0; i < width; i++) {
+    scratch[i] = src[i];
+  }
+  return scratch;
+}
+
+static inline void packed_write(void *data, PackedType type, long index,
+                                int width, const double *values) {
+  if (type == PACKED_FLOAT64) {
+    double *dst = (double *)data + index * width;
+    for (int i = 0; i < width; i++) {
+      dst[i] = values[i];
+    }
+    return;
+  }
+  float *dst = (float *)data + index * width;
+  for (int i = 0; i < width; i++) {
+    dst[i] = (float)values[i];
+  }
+}
+
+#endif
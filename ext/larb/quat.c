@@ -2,37 +2,32 @@
 
 #include <math.h>
 
-static void quat_free(void *ptr) {
-  xfree(ptr);
-}
+#include "mat4.h"
+#include "vec3.h"
 
 static size_t quat_memsize(const void *ptr) {
-  return sizeof(QuatData);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(QuatData);
 }
 
 static const rb_data_type_t quat_type = {
     "Quat",
-    {0, quat_free, quat_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, quat_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cQuat = Qnil;
-static VALUE cVec3 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cQuat = Qnil;
+static VALUE quat_const_identity = Qnil;
 
-static QuatData *quat_get(VALUE obj) {
+QuatData *quat_get(VALUE obj) {
   QuatData *data = NULL;
   TypedData_Get_Struct(obj, QuatData, &quat_type, data);
   return data;
 }
 
-static VALUE quat_build(VALUE klass, double x, double y, double z, double w) {
+VALUE quat_build(VALUE klass, double x, double y, double z, double w) {
   VALUE obj = quat_alloc(klass);
   QuatData *data = quat_get(obj);
   data->x = x;
@@ -52,6 +47,20 @@ static double clamp_double(double value, double min, double max) {
   return value;
 }
 
+static void quat_values(const QuatData *q, double *out) {
+  out[0] = q->x;
+  out[1] = q->y;
+  out[2] = q->z;
+  out[3] = q->w;
+}
+
+static void quat_store(QuatData *q, const double *values) {
+  q->x = values[0];
+  q->y = values[1];
+  q->z = values[2];
+  q->w = values[3];
+}
+
 static void normalize_quat(double *x, double *y, double *z, double *w) {
   double len = sqrt((*x) * (*x) + (*y) * (*y) + (*z) * (*z) + (*w) * (*w));
   *x /= len;
@@ -60,16 +69,88 @@ static void normalize_quat(double *x, double *y, double *z, double *w) {
   *w /= len;
 }
 
+void quat_multiply_values(const double *a, const double *b, double *out) {
+  double x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+  double y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+  double z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+  double w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = w;
+}
+
+void quat_lerp_values(const double *a, const double *b, double t,
+                      double *out) {
+  double x = a[0] + (b[0] - a[0]) * t;
+  double y = a[1] + (b[1] - a[1]) * t;
+  double z = a[2] + (b[2] - a[2]) * t;
+  double w = a[3] + (b[3] - a[3]) * t;
+  normalize_quat(&x, &y, &z, &w);
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = w;
+}
+
+void quat_slerp_values(const double *a, const double *b, double t,
+                       double *out) {
+  double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+
+  double ox = b[0];
+  double oy = b[1];
+  double oz = b[2];
+  double ow = b[3];
+  if (dot < 0.0) {
+    dot = -dot;
+    ox = -ox;
+    oy = -oy;
+    oz = -oz;
+    ow = -ow;
+  }
+
+  if (dot > 0.9995) {
+    double x = a[0] + (ox - a[0]) * t;
+    double y = a[1] + (oy - a[1]) * t;
+    double z = a[2] + (oz - a[2]) * t;
+    double w = a[3] + (ow - a[3]) * t;
+    normalize_quat(&x, &y, &z, &w);
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+    return;
+  }
+
+  double theta0 = acos(clamp_double(dot, -1.0, 1.0));
+  double theta = theta0 * t;
+  double sin_theta = sin(theta);
+  double sin_theta0 = sin(theta0);
+  double s0 = cos(theta) - dot * sin_theta / sin_theta0;
+  double s1 = sin_theta / sin_theta0;
+
+  double x = a[0] * s0 + ox * s1;
+  double y = a[1] * s0 + oy * s1;
+  double z = a[2] * s0 + oz * s1;
+  double w = a[3] * s0 + ow * s1;
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = w;
+}
+
 VALUE quat_alloc(VALUE klass) {
-  QuatData *data = ALLOC(QuatData);
+  QuatData *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, QuatData, &quat_type, data);
   data->x = 0.0;
   data->y = 0.0;
   data->z = 0.0;
   data->w = 1.0;
-  return TypedData_Wrap_Struct(klass, &quat_type, data);
+  return obj;
 }
 
 VALUE quat_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE vx = Qnil;
   VALUE vy = Qnil;
   VALUE vz = Qnil;
@@ -85,25 +166,52 @@ VALUE quat_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE quat_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *quat_get(self) = *quat_get(other);
+  return self;
+}
+
 static VALUE quat_class_bracket(VALUE klass, VALUE x, VALUE y, VALUE z,
                                 VALUE w) {
   return quat_build(klass, value_to_double(x), value_to_double(y),
                     value_to_double(z), value_to_double(w));
 }
 
+static VALUE quat_constant(VALUE klass, VALUE constant) {
+  if (klass == cQuat) {
+    return constant;
+  }
+  VALUE obj = quat_alloc(klass);
+  *quat_get(obj) = *quat_get(constant);
+  return obj;
+}
+
 static VALUE quat_class_identity(VALUE klass) {
-  return quat_build(klass, 0.0, 0.0, 0.0, 1.0);
+  return quat_constant(klass, quat_const_identity);
+}
+
+static void normalize3(double *v) {
+  double len = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  v[0] /= len;
+  v[1] /= len;
+  v[2] /= len;
+}
+
+static void cross3(const double *a, const double *b, double *out) {
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
 }
 
 static VALUE quat_class_from_axis_angle(VALUE klass, VALUE axis,
                                         VALUE radians) {
   double half = value_to_double(radians) * 0.5;
   double s = sin(half);
-  VALUE normalized = rb_funcall(axis, rb_intern("normalize"), 0);
-  double x = value_to_double(rb_funcall(normalized, rb_intern("x"), 0));
-  double y = value_to_double(rb_funcall(normalized, rb_intern("y"), 0));
-  double z = value_to_double(rb_funcall(normalized, rb_intern("z"), 0));
-  return quat_build(klass, x * s, y * s, z * s, cos(half));
+  Vec3Data *v = vec3_get(axis);
+  double n[3] = {v->x, v->y, v->z};
+  normalize3(n);
+  return quat_build(klass, n[0] * s, n[1] * s, n[2] * s, cos(half));
 }
 
 static VALUE quat_class_from_euler(VALUE klass, VALUE x, VALUE y, VALUE z) {
@@ -128,23 +236,31 @@ static VALUE quat_class_look_rotation(int argc, VALUE *argv, VALUE klass) {
   VALUE up = Qnil;
   rb_scan_args(argc, argv, "11", &forward, &up);
 
-  VALUE forward_norm = rb_funcall(forward, rb_intern("normalize"), 0);
-  VALUE up_vec = NIL_P(up) ? rb_funcall(cVec3, rb_intern("up"), 0) : up;
-  VALUE right =
-      rb_funcall(rb_funcall(up_vec, rb_intern("cross"), 1, forward_norm),
-                 rb_intern("normalize"), 0);
-  VALUE up_final =
-      rb_funcall(forward_norm, rb_intern("cross"), 1, right);
-
-  double m00 = value_to_double(rb_funcall(right, rb_intern("x"), 0));
-  double m01 = value_to_double(rb_funcall(up_final, rb_intern("x"), 0));
-  double m02 = value_to_double(rb_funcall(forward_norm, rb_intern("x"), 0));
-  double m10 = value_to_double(rb_funcall(right, rb_intern("y"), 0));
-  double m11 = value_to_double(rb_funcall(up_final, rb_intern("y"), 0));
-  double m12 = value_to_double(rb_funcall(forward_norm, rb_intern("y"), 0));
-  double m20 = value_to_double(rb_funcall(right, rb_intern("z"), 0));
-  double m21 = value_to_double(rb_funcall(up_final, rb_intern("z"), 0));
-  double m22 = value_to_double(rb_funcall(forward_norm, rb_intern("z"), 0));
+  Vec3Data *fv = vec3_get(forward);
+  double f[3] = {fv->x, fv->y, fv->z};
+  double u[3] = {0.0, 1.0, 0.0};
+  if (!NIL_P(up)) {
+    Vec3Data *uv = vec3_get(up);
+    u[0] = uv->x;
+    u[1] = uv->y;
+    u[2] = uv->z;
+  }
+  double r[3];
+  double u2[3];
+  normalize3(f);
+  cross3(u, f, r);
+  normalize3(r);
+  cross3(f, r, u2);
+
+  double m00 = r[0];
+  double m01 = u2[0];
+  double m02 = f[0];
+  double m10 = r[1];
+  double m11 = u2[1];
+  double m12 = f[1];
+  double m20 = r[2];
+  double m21 = u2[2];
+  double m22 = f[2];
 
   double trace = m00 + m11 + m22;
   if (trace > 0.0) {
@@ -173,6 +289,7 @@ static VALUE quat_get_x(VALUE self) {
 }
 
 static VALUE quat_set_x(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   QuatData *data = quat_get(self);
   data->x = value_to_double(value);
   return value;
@@ -184,6 +301,7 @@ static VALUE quat_get_y(VALUE self) {
 }
 
 static VALUE quat_set_y(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   QuatData *data = quat_get(self);
   data->y = value_to_double(value);
   return value;
@@ -195,6 +313,7 @@ static VALUE quat_get_z(VALUE self) {
 }
 
 static VALUE quat_set_z(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   QuatData *data = quat_get(self);
   data->z = value_to_double(value);
   return value;
@@ -206,6 +325,7 @@ static VALUE quat_get_w(VALUE self) {
 }
 
 static VALUE quat_set_w(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   QuatData *data = quat_get(self);
   data->w = value_to_double(value);
   return value;
@@ -215,18 +335,21 @@ VALUE quat_mul(VALUE self, VALUE other) {
   QuatData *a = quat_get(self);
 
   if (rb_obj_is_kind_of(other, cQuat)) {
-    QuatData *b = quat_get(other);
-    return quat_build(
-        rb_obj_class(self), a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y,
-        a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x,
-        a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w,
-        a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z);
+    double av[4];
+    double bv[4];
+    double values[4];
+    quat_values(a, av);
+    quat_values(quat_get(other), bv);
+    quat_multiply_values(av, bv, values);
+    return quat_build(rb_obj_class(self), values[0], values[1], values[2],
+                      values[3]);
   }
 
   if (rb_obj_is_kind_of(other, cVec3)) {
-    double vx = value_to_double(rb_funcall(other, rb_intern("x"), 0));
-    double vy = value_to_double(rb_funcall(other, rb_intern("y"), 0));
-    double vz = value_to_double(rb_funcall(other, rb_intern("z"), 0));
+    Vec3Data *v = vec3_get(other);
+    double vx = v->x;
+    double vy = v->y;
+    double vz = v->z;
 
     double uvx = a->y * vz - a->z * vy;
     double uvy = a->z * vx - a->x * vz;
@@ -240,8 +363,7 @@ VALUE quat_mul(VALUE self, VALUE other) {
     double ry = vy + (uvy * a->w + uuvy) * 2.0;
     double rz = vz + (uvz * a->w + uuvz) * 2.0;
 
-    return rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(rx), DBL2NUM(ry),
-                      DBL2NUM(rz));
+    return vec3_build(cVec3, rx, ry, rz);
   }
 
   if (rb_obj_is_kind_of(other, rb_cNumeric)) {
@@ -299,6 +421,7 @@ VALUE quat_normalize(VALUE self) {
 }
 
 VALUE quat_normalize_bang(VALUE self) {
+  rb_check_frozen(self);
   QuatData *a = quat_get(self);
   normalize_quat(&a->x, &a->y, &a->z, &a->w);
   return self;
@@ -317,54 +440,61 @@ VALUE quat_inverse(VALUE self) {
 }
 
 VALUE quat_lerp(VALUE self, VALUE other, VALUE t) {
-  QuatData *a = quat_get(self);
-  QuatData *b = quat_get(other);
-  double s = value_to_double(t);
-  double x = a->x + (b->x - a->x) * s;
-  double y = a->y + (b->y - a->y) * s;
-  double z = a->z + (b->z - a->z) * s;
-  double w = a->w + (b->w - a->w) * s;
-  normalize_quat(&x, &y, &z, &w);
-  return quat_build(rb_obj_class(self), x, y, z, w);
+  double av[4];
+  double bv[4];
+  double values[4];
+  quat_values(quat_get(self), av);
+  quat_values(quat_get(other), bv);
+  quat_lerp_values(av, bv, value_to_double(t), values);
+  return quat_build(rb_obj_class(self), values[0], values[1], values[2],
+                    values[3]);
 }
 
 VALUE quat_slerp(VALUE self, VALUE other, VALUE t) {
+  double av[4];
+  double bv[4];
+  double values[4];
+  quat_values(quat_get(self), av);
+  quat_values(quat_get(other), bv);
+  quat_slerp_values(av, bv, value_to_double(t), values);
+  return quat_build(rb_obj_class(self), values[0], values[1], values[2],
+                    values[3]);
+}
+
+VALUE quat_mul_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
   QuatData *a = quat_get(self);
-  QuatData *b = quat_get(other);
-  double s = value_to_double(t);
-  double dot = a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
-
-  double ox = b->x;
-  double oy = b->y;
-  double oz = b->z;
-  double ow = b->w;
-  if (dot < 0.0) {
-    dot = -dot;
-    ox = -ox;
-    oy = -oy;
-    oz = -oz;
-    ow = -ow;
-  }
-
-  if (dot > 0.9995) {
-    double x = a->x + (ox - a->x) * s;
-    double y = a->y + (oy - a->y) * s;
-    double z = a->z + (oz - a->z) * s;
-    double w = a->w + (ow - a->w) * s;
-    normalize_quat(&x, &y, &z, &w);
-    return quat_build(rb_obj_class(self), x, y, z, w);
-  }
+  double av[4];
+  double bv[4];
+  quat_values(a, av);
+  quat_values(quat_get(other), bv);
+  quat_multiply_values(av, bv, av);
+  quat_store(a, av);
+  return self;
+}
 
-  double theta0 = acos(clamp_double(dot, -1.0, 1.0));
-  double theta = theta0 * s;
-  double sin_theta = sin(theta);
-  double sin_theta0 = sin(theta0);
-  double s0 = cos(theta) - dot * sin_theta / sin_theta0;
-  double s1 = sin_theta / sin_theta0;
+VALUE quat_lerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  QuatData *a = quat_get(self);
+  double av[4];
+  double bv[4];
+  quat_values(a, av);
+  quat_values(quat_get(other), bv);
+  quat_lerp_values(av, bv, value_to_double(t), av);
+  quat_store(a, av);
+  return self;
+}
 
-  return quat_build(rb_obj_class(self), a->x * s0 + ox * s1,
-                    a->y * s0 + oy * s1, a->z * s0 + oz * s1,
-                    a->w * s0 + ow * s1);
+VALUE quat_slerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  QuatData *a = quat_get(self);
+  double av[4];
+  double bv[4];
+  quat_values(a, av);
+  quat_values(quat_get(other), bv);
+  quat_slerp_values(av, bv, value_to_double(t), av);
+  quat_store(a, av);
+  return self;
 }
 
 VALUE quat_to_axis_angle(VALUE self) {
@@ -374,11 +504,9 @@ VALUE quat_to_axis_angle(VALUE self) {
   double s = sqrt(1.0 - w * w);
   VALUE axis;
   if (s < 0.001) {
-    axis = rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(1.0), DBL2NUM(0.0),
-                      DBL2NUM(0.0));
+    axis = vec3_build(cVec3, 1.0, 0.0, 0.0);
   } else {
-    axis = rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(a->x / s),
-                      DBL2NUM(a->y / s), DBL2NUM(a->z / s));
+    axis = vec3_build(cVec3, a->x / s, a->y / s, a->z / s);
   }
   VALUE ary = rb_ary_new_capa(2);
   rb_ary_push(ary, axis);
@@ -405,13 +533,14 @@ VALUE quat_to_euler(VALUE self) {
   double cosy_cosp = 1.0 - 2.0 * (a->y * a->y + a->z * a->z);
   double yaw = atan2(siny_cosp, cosy_cosp);
 
-  return rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(roll), DBL2NUM(pitch),
-                    DBL2NUM(yaw));
+  return vec3_build(cVec3, roll, pitch, yaw);
 }
 
 VALUE quat_to_mat4(VALUE self) {
-  VALUE mat4_class = rb_const_get(mLarb, rb_intern("Mat4"));
-  return rb_funcall(mat4_class, rb_intern("from_quaternion"), 1, self);
+  QuatData *a = quat_get(self);
+  double values[16];
+  mat4_rotation_values(a->x, a->y, a->z, a->w, values);
+  return mat4_build(cMat4, values);
 }
 
 VALUE quat_to_a(VALUE self) {
@@ -476,13 +605,14 @@ VALUE quat_inspect(VALUE self) {
 
 void Init_quat(VALUE module) {
   cQuat = rb_define_class_under(module, "Quat", rb_cObject);
-  cVec3 = rb_const_get(mLarb, rb_intern("Vec3"));
 
   rb_define_alloc_func(cQuat, quat_alloc);
   rb_define_method(cQuat, "initialize", quat_initialize, -1);
+  rb_define_method(cQuat, "initialize_copy", quat_initialize_copy, 1);
 
   rb_define_singleton_method(cQuat, "[]", quat_class_bracket, 4);
   rb_define_singleton_method(cQuat, "identity", quat_class_identity, 0);
+
   rb_define_singleton_method(cQuat, "from_axis_angle",
                              quat_class_from_axis_angle, 2);
   rb_define_singleton_method(cQuat, "from_euler", quat_class_from_euler, 3);
@@ -511,6 +641,9 @@ void Init_quat(VALUE module) {
   rb_define_method(cQuat, "inverse", quat_inverse, 0);
   rb_define_method(cQuat, "lerp", quat_lerp, 2);
   rb_define_method(cQuat, "slerp", quat_slerp, 2);
+  rb_define_method(cQuat, "mul!", quat_mul_bang, 1);
+  rb_define_method(cQuat, "lerp!", quat_lerp_bang, 2);
+  rb_define_method(cQuat, "slerp!", quat_slerp_bang, 2);
   rb_define_method(cQuat, "to_axis_angle", quat_to_axis_angle, 0);
   rb_define_method(cQuat, "to_euler", quat_to_euler, 0);
   rb_define_method(cQuat, "to_mat4", quat_to_mat4, 0);
@@ -520,4 +653,7 @@ void Init_quat(VALUE module) {
   rb_define_method(cQuat, "near?", quat_near, -1);
   rb_define_method(cQuat, "inspect", quat_inspect, 0);
   rb_define_alias(cQuat, "to_s", "inspect");
+
+  larb_define_constant(cQuat, "IDENTITY", &quat_const_identity,
+                       quat_build(cQuat, 0.0, 0.0, 0.0, 1.0));
 }
@@ -10,9 +10,18 @@ typedef struct {
   double w;
 } QuatData;
 
+extern VALUE cQuat;
+
 void Init_quat(VALUE module);
 VALUE quat_alloc(VALUE klass);
 VALUE quat_initialize(int argc, VALUE *argv, VALUE self);
+QuatData *quat_get(VALUE obj);
+VALUE quat_build(VALUE klass, double x, double y, double z, double w);
+
+void quat_multiply_values(const double *a, const double *b, double *out);
+void quat_lerp_values(const double *a, const double *b, double t, double *out);
+void quat_slerp_values(const double *a, const double *b, double t,
+                       double *out);
 
 VALUE quat_mul(VALUE self, VALUE other);
 VALUE quat_add(VALUE self, VALUE other);
@@ -27,6 +36,9 @@ VALUE quat_conjugate(VALUE self);
 VALUE quat_inverse(VALUE self);
 VALUE quat_lerp(VALUE self, VALUE other, VALUE t);
 VALUE quat_slerp(VALUE self, VALUE other, VALUE t);
+VALUE quat_mul_bang(VALUE self, VALUE other);
+VALUE quat_lerp_bang(VALUE self, VALUE other, VALUE t);
+VALUE quat_slerp_bang(VALUE self, VALUE other, VALUE t);
 VALUE quat_to_axis_angle(VALUE self);
 VALUE quat_to_euler(VALUE self);
 VALUE quat_to_mat4(VALUE self);
@@ -2,39 +2,33 @@
 
 #include <math.h>
 
-static void quat2_free(void *ptr) {
-  xfree(ptr);
-}
+#include "mat4.h"
+#include "quat.h"
+#include "vec3.h"
 
 static size_t quat2_memsize(const void *ptr) {
-  return sizeof(Quat2Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Quat2Data);
 }
 
 static const rb_data_type_t quat2_type = {
     "Quat2",
-    {0, quat2_free, quat2_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, quat2_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cQuat2 = Qnil;
-static VALUE cQuat = Qnil;
-static VALUE cVec3 = Qnil;
-static VALUE cMat4 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cQuat2 = Qnil;
+static VALUE quat2_const_identity = Qnil;
 
-static Quat2Data *quat2_get(VALUE obj) {
+Quat2Data *quat2_get(VALUE obj) {
   Quat2Data *data = NULL;
   TypedData_Get_Struct(obj, Quat2Data, &quat2_type, data);
   return data;
 }
 
-static VALUE quat2_build(VALUE klass, const double *values) {
+VALUE quat2_build(VALUE klass, const double *values) {
   VALUE obj = quat2_alloc(klass);
   Quat2Data *data = quat2_get(obj);
   for (int i = 0; i < 8; i++) {
@@ -50,20 +44,23 @@ static VALUE quat2_build8(VALUE klass, double v0, double v1, double v2,
   return quat2_build(klass, values);
 }
 
-static VALUE quat2_class_identity(VALUE klass) {
-  return quat2_build8(klass, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0);
+static VALUE quat2_constant(VALUE klass, VALUE constant) {
+  if (klass == cQuat2) {
+    return constant;
+  }
+  VALUE obj = quat2_alloc(klass);
+  *quat2_get(obj) = *quat2_get(constant);
+  return obj;
 }
 
-static VALUE quat2_class_from_rotation_translation(VALUE klass, VALUE rotation,
-                                                   VALUE translation) {
-  double rx = value_to_double(rb_funcall(rotation, rb_intern("x"), 0));
-  double ry = value_to_double(rb_funcall(rotation, rb_intern("y"), 0));
-  double rz = value_to_double(rb_funcall(rotation, rb_intern("z"), 0));
-  double rw = value_to_double(rb_funcall(rotation, rb_intern("w"), 0));
-  double tx = value_to_double(rb_funcall(translation, rb_intern("x"), 0));
-  double ty = value_to_double(rb_funcall(translation, rb_intern("y"), 0));
-  double tz = value_to_double(rb_funcall(translation, rb_intern("z"), 0));
+static VALUE quat2_class_identity(VALUE klass) {
+  return quat2_constant(klass, quat2_const_identity);
+}
 
+static VALUE quat2_build_rotation_translation(VALUE klass, double rx,
+                                              double ry, double rz, double rw,
+                                              double tx, double ty,
+                                              double tz) {
   return quat2_build8(
       klass, rx, ry, rz, rw, (tx * rw + ty * rz - tz * ry) * 0.5,
       (ty * rw + tz * rx - tx * rz) * 0.5,
@@ -71,27 +68,36 @@ static VALUE quat2_class_from_rotation_translation(VALUE klass, VALUE rotation,
       (-tx * rx - ty * ry - tz * rz) * 0.5);
 }
 
+static VALUE quat2_class_from_rotation_translation(VALUE klass, VALUE rotation,
+                                                   VALUE translation) {
+  QuatData *r = quat_get(rotation);
+  Vec3Data *t = vec3_get(translation);
+  return quat2_build_rotation_translation(klass, r->x, r->y, r->z, r->w, t->x,
+                                          t->y, t->z);
+}
+
 static VALUE quat2_class_from_translation(VALUE klass, VALUE translation) {
-  VALUE identity = rb_funcall(cQuat, rb_intern("identity"), 0);
-  return quat2_class_from_rotation_translation(klass, identity, translation);
+  Vec3Data *t = vec3_get(translation);
+  return quat2_build_rotation_translation(klass, 0.0, 0.0, 0.0, 1.0, t->x,
+                                          t->y, t->z);
 }
 
 static VALUE quat2_class_from_rotation(VALUE klass, VALUE rotation) {
-  double rx = value_to_double(rb_funcall(rotation, rb_intern("x"), 0));
-  double ry = value_to_double(rb_funcall(rotation, rb_intern("y"), 0));
-  double rz = value_to_double(rb_funcall(rotation, rb_intern("z"), 0));
-  double rw = value_to_double(rb_funcall(rotation, rb_intern("w"), 0));
-  return quat2_build8(klass, rx, ry, rz, rw, 0.0, 0.0, 0.0, 0.0);
+  QuatData *r = quat_get(rotation);
+  return quat2_build8(klass, r->x, r->y, r->z, r->w, 0.0, 0.0, 0.0, 0.0);
 }
 
 static VALUE quat2_class_from_mat4(VALUE klass, VALUE mat4) {
-  VALUE rotation = rb_funcall(mat4, rb_intern("extract_rotation"), 0);
-  VALUE translation = rb_funcall(mat4, rb_intern("extract_translation"), 0);
-  return quat2_class_from_rotation_translation(klass, rotation, translation);
+  QuatData *r = quat_get(mat4_extract_rotation(mat4));
+  Mat4Data *m = mat4_get(mat4);
+  return quat2_build_rotation_translation(klass, r->x, r->y, r->z, r->w,
+                                          m->data[12], m->data[13],
+                                          m->data[14]);
 }
 
 VALUE quat2_alloc(VALUE klass) {
-  Quat2Data *data = ALLOC(Quat2Data);
+  Quat2Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Quat2Data, &quat2_type, data);
   data->data[0] = 0.0;
   data->data[1] = 0.0;
   data->data[2] = 0.0;
@@ -100,10 +106,11 @@ VALUE quat2_alloc(VALUE klass) {
   data->data[5] = 0.0;
   data->data[6] = 0.0;
   data->data[7] = 0.0;
-  return TypedData_Wrap_Struct(klass, &quat2_type, data);
+  return obj;
 }
 
 VALUE quat2_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE data_arg = Qnil;
   Quat2Data *data = quat2_get(self);
 
@@ -132,18 +139,20 @@ VALUE quat2_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE quat2_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *quat2_get(self) = *quat2_get(other);
+  return self;
+}
+
 VALUE quat2_real(VALUE self) {
   Quat2Data *a = quat2_get(self);
-  return rb_funcall(cQuat, rb_intern("new"), 4, DBL2NUM(a->data[0]),
-                    DBL2NUM(a->data[1]), DBL2NUM(a->data[2]),
-                    DBL2NUM(a->data[3]));
+  return quat_build(cQuat, a->data[0], a->data[1], a->data[2], a->data[3]);
 }
 
 VALUE quat2_dual(VALUE self) {
   Quat2Data *a = quat2_get(self);
-  return rb_funcall(cQuat, rb_intern("new"), 4, DBL2NUM(a->data[4]),
-                    DBL2NUM(a->data[5]), DBL2NUM(a->data[6]),
-                    DBL2NUM(a->data[7]));
+  return quat_build(cQuat, a->data[4], a->data[5], a->data[6], a->data[7]);
 }
 
 VALUE quat2_aref(VALUE self, VALUE index) {
@@ -156,6 +165,7 @@ VALUE quat2_aref(VALUE self, VALUE index) {
 }
 
 VALUE quat2_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Quat2Data *data = quat2_get(self);
   long idx = NUM2LONG(index);
   if (idx < 0 || idx > 7) {
@@ -278,6 +288,7 @@ VALUE quat2_normalize(VALUE self) {
 }
 
 VALUE quat2_normalize_bang(VALUE self) {
+  rb_check_frozen(self);
   Quat2Data *a = quat2_get(self);
   double len = sqrt(a->data[0] * a->data[0] + a->data[1] * a->data[1] +
                     a->data[2] * a->data[2] + a->data[3] * a->data[3]);
@@ -315,35 +326,74 @@ VALUE quat2_inverse(VALUE self) {
   return quat2_build(rb_obj_class(self), values);
 }
 
-VALUE quat2_translation(VALUE self) {
-  Quat2Data *a = quat2_get(self);
-  double ax = a->data[0];
-  double ay = a->data[1];
-  double az = a->data[2];
-  double aw = a->data[3];
-  double bx = a->data[4];
-  double by = a->data[5];
-  double bz = a->data[6];
-  double bw = a->data[7];
+static void quat2_translation_values(const double *d, double *out) {
+  double ax = d[0];
+  double ay = d[1];
+  double az = d[2];
+  double aw = d[3];
+  double bx = d[4];
+  double by = d[5];
+  double bz = d[6];
+  double bw = d[7];
 
-  double tx = 2.0 * (-bw * ax + bx * aw - by * az + bz * ay);
-  double ty = 2.0 * (-bw * ay + by * aw - bz * ax + bx * az);
-  double tz = 2.0 * (-bw * az + bz * aw - bx * ay + by * ax);
+  out[0] = 2.0 * (-bw * ax + bx * aw - by * az + bz * ay);
+  out[1] = 2.0 * (-bw * ay + by * aw - bz * ax + bx * az);
+  out[2] = 2.0 * (-bw * az + bz * aw - bx * ay + by * ax);
+}
+
+static void quat2_rotation_values(const double *d, double *out) {
+  double len = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + d[3] * d[3]);
+  for (int i = 0; i < 4; i++) {
+    out[i] = d[i] / len;
+  }
+}
 
-  return rb_funcall(cVec3, rb_intern("new"), 3, DBL2NUM(tx), DBL2NUM(ty),
-                    DBL2NUM(tz));
+VALUE quat2_translation(VALUE self) {
+  Quat2Data *a = quat2_get(self);
+  double t[3];
+  quat2_translation_values(a->data, t);
+  return vec3_build(cVec3, t[0], t[1], t[2]);
 }
 
 VALUE quat2_rotation(VALUE self) {
-  VALUE real = quat2_real(self);
-  return rb_funcall(real, rb_intern("normalize"), 0);
+  Quat2Data *a = quat2_get(self);
+  double r[4];
+  quat2_rotation_values(a->data, r);
+  return quat_build(cQuat, r[0], r[1], r[2], r[3]);
 }
 
 VALUE quat2_transform_point(VALUE self, VALUE point) {
-  VALUE rot = quat2_rotation(self);
-  VALUE rotated = rb_funcall(rot, rb_intern("*"), 1, point);
-  VALUE trans = quat2_translation(self);
-  return rb_funcall(rotated, rb_intern("+"), 1, trans);
+  Quat2Data *a = quat2_get(self);
+  Vec3Data *p = vec3_get(point);
+  double r[4];
+  double t[3];
+  quat2_rotation_values(a->data, r);
+  quat2_translation_values(a->data, t);
+
+  double uvx = r[1] * p->z - r[2] * p->y;
+  double uvy = r[2] * p->x - r[0] * p->z;
+  double uvz = r[0] * p->y - r[1] * p->x;
+  double uuvx = r[1] * uvz - r[2] * uvy;
+  double uuvy = r[2] * uvx - r[0] * uvz;
+  double uuvz = r[0] * uvy - r[1] * uvx;
+
+  return vec3_build(cVec3, p->x + (uvx * r[3] + uuvx) * 2.0 + t[0],
+                    p->y + (uvy * r[3] + uuvy) * 2.0 + t[1],
+                    p->z + (uvz * r[3] + uuvz) * 2.0 + t[2]);
+}
+
+VALUE quat2_transform_points(int argc, VALUE *argv, VALUE self) {
+  VALUE points = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &points, &out);
+  Quat2Data *a = quat2_get(self);
+  double r[4];
+  double m[16];
+  quat2_rotation_values(a->data, r);
+  mat4_rotation_values(r[0], r[1], r[2], r[3], m);
+  quat2_translation_values(a->data, m + 12);
+  return mat4_apply_vec3_array(m, points, out, 1.0, 0);
 }
 
 VALUE quat2_lerp(VALUE self, VALUE other, VALUE t) {
@@ -359,15 +409,18 @@ VALUE quat2_lerp(VALUE self, VALUE other, VALUE t) {
 }
 
 VALUE quat2_to_mat4(VALUE self) {
-  VALUE rot = quat2_rotation(self);
-  VALUE trans = quat2_translation(self);
-  VALUE rot_m = rb_funcall(cMat4, rb_intern("from_quaternion"), 1, rot);
-  VALUE trans_m =
-      rb_funcall(cMat4, rb_intern("translation"), 3,
-                 rb_funcall(trans, rb_intern("x"), 0),
-                 rb_funcall(trans, rb_intern("y"), 0),
-                 rb_funcall(trans, rb_intern("z"), 0));
-  return rb_funcall(rot_m, rb_intern("*"), 1, trans_m);
+  Quat2Data *a = quat2_get(self);
+  double r[4];
+  double t[3];
+  double rot_m[16];
+  double values[16];
+  quat2_rotation_values(a->data, r);
+  quat2_translation_values(a->data, t);
+  mat4_rotation_values(r[0], r[1], r[2], r[3], rot_m);
+  double trans_m[16] = {1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
+                        0.0, 0.0, 1.0, 0.0, t[0], t[1], t[2], 1.0};
+  mat4_multiply_values(rot_m, trans_m, values);
+  return mat4_build(cMat4, values);
 }
 
 VALUE quat2_to_a(VALUE self) {
@@ -429,14 +482,13 @@ VALUE quat2_inspect(VALUE self) {
 
 void Init_quat2(VALUE module) {
   cQuat2 = rb_define_class_under(module, "Quat2", rb_cObject);
-  cQuat = rb_const_get(mLarb, rb_intern("Quat"));
-  cVec3 = rb_const_get(mLarb, rb_intern("Vec3"));
-  cMat4 = rb_const_get(mLarb, rb_intern("Mat4"));
 
   rb_define_alloc_func(cQuat2, quat2_alloc);
   rb_define_method(cQuat2, "initialize", quat2_initialize, -1);
+  rb_define_method(cQuat2, "initialize_copy", quat2_initialize_copy, 1);
 
   rb_define_singleton_method(cQuat2, "identity", quat2_class_identity, 0);
+
   rb_define_singleton_method(cQuat2, "from_rotation_translation",
                              quat2_class_from_rotation_translation, 2);
   rb_define_singleton_method(cQuat2, "from_translation",
@@ -463,6 +515,7 @@ void Init_quat2(VALUE module) {
   rb_define_method(cQuat2, "translation", quat2_translation, 0);
   rb_define_method(cQuat2, "rotation", quat2_rotation, 0);
   rb_define_method(cQuat2, "transform_point", quat2_transform_point, 1);
+  rb_define_method(cQuat2, "transform_points", quat2_transform_points, -1);
   rb_define_method(cQuat2, "lerp", quat2_lerp, 2);
   rb_define_method(cQuat2, "to_mat4", quat2_to_mat4, 0);
   rb_define_method(cQuat2, "to_a", quat2_to_a, 0);
@@ -470,4 +523,8 @@ void Init_quat2(VALUE module) {
   rb_define_method(cQuat2, "near?", quat2_near, -1);
   rb_define_method(cQuat2, "inspect", quat2_inspect, 0);
   rb_define_alias(cQuat2, "to_s", "inspect");
+
+  larb_define_constant(cQuat2, "IDENTITY", &quat2_const_identity,
+                       quat2_build8(cQuat2, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0,
+                                    0.0));
 }
@@ -7,9 +7,13 @@ typedef struct {
   double data[8];
 } Quat2Data;
 
+extern VALUE cQuat2;
+
 void Init_quat2(VALUE module);
 VALUE quat2_alloc(VALUE klass);
 VALUE quat2_initialize(int argc, VALUE *argv, VALUE self);
+Quat2Data *quat2_get(VALUE obj);
+VALUE quat2_build(VALUE klass, const double *values);
 
 VALUE quat2_real(VALUE self);
 VALUE quat2_dual(VALUE self);
@@ -28,6 +32,7 @@ VALUE quat2_inverse(VALUE self);
 VALUE quat2_translation(VALUE self);
 VALUE quat2_rotation(VALUE self);
 VALUE quat2_transform_point(VALUE self, VALUE point);
+VALUE quat2_transform_points(int argc, VALUE *argv, VALUE self);
 VALUE quat2_lerp(VALUE self, VALUE other, VALUE t);
 VALUE quat2_to_mat4(VALUE self);
 VALUE quat2_to_a(VALUE self);
@@ -0,0 +1,417 @@
+#include "quat_array.h"
+
+#include <math.h>
+
+#include "quat.h"
+#include "packed_buffer.h"
+
+static const double quat_array_identity[4] = {0.0, 0.0, 0.0, 1.0};
+
+static const PackedArrayClass quat_array_class;
+
+static const rb_data_type_t quat_array_type = {
+    "QuatArray",
+    {packed_array_mark, RUBY_TYPED_DEFAULT_FREE, packed_array_memsize},
+    0,
+    (void *)&quat_array_class,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
+};
+
+static const PackedArrayClass quat_array_class = {
+    &quat_array_type,
+    4,
+    true,
+    PACKED_FLOAT64,
+    quat_array_identity,
+    {{"d", 8, 32, 1, {4}, {8}}, {"f", 4, 16, 1, {4}, {4}}},
+};
+
+static VALUE cQuatArray = Qnil;
+
+static size_t element_size(PackedType type) {
+  return packed_array_element_size(&quat_array_class, type);
+}
+
+QuatArrayData *quat_array_get(VALUE obj) {
+  return packed_array_get(obj, &quat_array_class);
+}
+
+VALUE quat_array_build(VALUE klass, long length, PackedType type) {
+  return packed_array_build(klass, &quat_array_class, length, type);
+}
+
+static void read_quat(VALUE quat, double *out) {
+  QuatData *q = quat_get(quat);
+  out[0] = q->x;
+  out[1] = q->y;
+  out[2] = q->z;
+  out[3] = q->w;
+}
+
+static VALUE quat_new(const double *q) {
+  return quat_build(cQuat, q[0], q[1], q[2], q[3]);
+}
+
+static VALUE quat_array_element(QuatArrayData *data, long index) {
+  double scratch[4];
+  return quat_new(packed_read(data->data, data->type, index, 4, scratch));
+}
+
+typedef struct {
+  const void *data;
+  PackedType type;
+  long stride;
+  double scratch[4];
+} QuatOperand;
+
+static void quat_array_operand(VALUE other, QuatArrayData *a,
+                               QuatOperand *operand) {
+  if (rb_obj_is_kind_of(other, cQuatArray)) {
+    QuatArrayData *b = quat_array_get(other);
+    packed_check_length(a->length, b->length);
+    packed_type_check(a->type, b->type);
+    operand->data = b->data;
+    operand->type = b->type;
+    operand->stride = 1;
+    return;
+  }
+  if (rb_obj_is_kind_of(other, cQuat)) {
+    read_quat(other, operand->scratch);
+    operand->data = operand->scratch;
+    operand->type = PACKED_FLOAT64;
+    operand->stride = 0;
+    return;
+  }
+  rb_raise(rb_eTypeError, "expected QuatArray or Quat");
+}
+
+static const double *quat_operand_read(const QuatOperand *operand, long index,
+                                       double *scratch) {
+  return packed_read(operand->data, operand->type, index * operand->stride, 4,
+                     scratch);
+}
+
+static VALUE quat_array_output(VALUE self, VALUE out, QuatArrayData *a) {
+  if (NIL_P(out)) {
+    return quat_array_build(rb_obj_class(self), a->length, a->type);
+  }
+  if (!rb_obj_is_kind_of(out, cQuatArray)) {
+    rb_raise(rb_eTypeError, "expected QuatArray for output");
+  }
+  QuatArrayData *data = quat_array_get(out);
+  packed_check_length(a->length, data->length);
+  packed_type_check(a->type, data->type);
+  packed_buffer_check_writable(out, data->buffer);
+  return out;
+}
+
+typedef void (*quat_interpolate_fn)(const double *, const double *, double,
+                                    double *);
+
+typedef struct {
+  PackedType type;
+  const void *a;
+  const QuatOperand *b;
+  quat_interpolate_fn interpolate;
+  double t;
+  const double *ts;
+  void *out;
+  long length;
+} QuatArrayJob;
+
+static void normalize_job(void *ptr, long begin, long end) {
+  QuatArrayJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double scratch[4];
+    const double *q = packed_read(job->a, job->type, i, 4, scratch);
+    double len = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    double o[4] = {q[0] / len, q[1] / len, q[2] / len, q[3] / len};
+    packed_write(job->out, job->type, i, 4, o);
+  }
+}
+
+static void conjugate_job(void *ptr, long begin, long end) {
+  QuatArrayJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double scratch[4];
+    const double *q = packed_read(job->a, job->type, i, 4, scratch);
+    double o[4] = {-q[0], -q[1], -q[2], q[3]};
+    packed_write(job->out, job->type, i, 4, o);
+  }
+}
+
+static void multiply_job(void *ptr, long begin, long end) {
+  QuatArrayJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double as[4];
+    double bs[4];
+    double o[4];
+    quat_multiply_values(packed_read(job->a, job->type, i, 4, as),
+                         quat_operand_read(job->b, i, bs), o);
+    packed_write(job->out, job->type, i, 4, o);
+  }
+}
+
+static void interpolate_job(void *ptr, long begin, long end) {
+  QuatArrayJob *job = ptr;
+  for (long i = begin; i < end; i++) {
+    double as[4];
+    double bs[4];
+    double o[4];
+    job->interpolate(packed_read(job->a, job->type, i, 4, as),
+                     quat_operand_read(job->b, i, bs),
+                     job->ts ? job->ts[i] : job->t, o);
+    packed_write(job->out, job->type, i, 4, o);
+  }
+}
+
+static PackedPin quat_array_pin(VALUE obj) {
+  if (!rb_obj_is_kind_of(obj, cQuatArray)) {
+    return packed_pin(Qnil, Qnil, NULL);
+  }
+  QuatArrayData *data = quat_array_get(obj);
+  return packed_pin(obj, data->buffer, &data->locks);
+}
+
+static void quat_array_run(PackedJob run, QuatArrayJob *job, VALUE self,
+                           VALUE other, VALUE result) {
+  size_t size = (size_t)job->length * element_size(job->type);
+  packed_check_overlap(job->a, size, job->out, size);
+  if (job->b != NULL) {
+    packed_check_overlap(job->b->data, job->b->stride ? size : 0, job->out,
+                         size);
+  }
+  PackedPin pins[3] = {quat_array_pin(self), quat_array_pin(other),
+                       quat_array_pin(result)};
+  packed_run(job->length, run, job, pins, 3);
+}
+
+static void quat_array_unary(PackedJob run, VALUE self, VALUE result) {
+  QuatArrayData *a = quat_array_get(self);
+  QuatArrayJob job = {a->type, a->data, NULL, NULL, 0.0, NULL,
+                      quat_array_get(result)->data, a->length};
+  quat_array_run(run, &job, self, Qnil, result);
+}
+
+static VALUE quat_array_interpolate(int argc, VALUE *argv, VALUE self,
+                                    quat_interpolate_fn interpolate) {
+  VALUE other = Qnil;
+  VALUE t = Qnil;
+  VALUE out = Qnil;
+  QuatOperand b;
+
+  rb_scan_args(argc, argv, "21", &other, &t, &out);
+  VALUE ts = rb_check_array_type(t);
+  VALUE tmp = 0;
+  double *factors = NULL;
+  double s = 0.0;
+  long count = 0;
+  if (NIL_P(ts)) {
+    s = value_to_double(t);
+  } else {
+    count = RARRAY_LEN(ts);
+    factors = ALLOCV_N(double, tmp, count);
+    for (long i = 0; i < count; i++) {
+      factors[i] = value_to_double(rb_ary_entry(ts, i));
+    }
+  }
+  QuatArrayData *a = quat_array_get(self);
+  if (!NIL_P(ts)) {
+    packed_check_length(a->length, count);
+  }
+  quat_array_operand(other, a, &b);
+  VALUE result = quat_array_output(self, out, a);
+
+  QuatArrayJob job = {a->type, a->data, &b, interpolate, s, factors,
+                      quat_array_get(result)->data, a->length};
+  quat_array_run(interpolate_job, &job, self, other, result);
+  ALLOCV_END(tmp);
+  return result;
+}
+
+VALUE quat_array_alloc(VALUE klass) {
+  return packed_array_alloc(klass, &quat_array_class);
+}
+
+static VALUE quat_array_class_from(int argc, VALUE *argv, VALUE klass) {
+  VALUE quats = Qnil;
+  VALUE opts = Qnil;
+
+  rb_scan_args(argc, argv, "1:", &quats, &opts);
+  VALUE ary = rb_check_array_type(quats);
+  if (NIL_P(ary)) {
+    rb_raise(rb_eTypeError, "expected Array");
+  }
+
+  long length = RARRAY_LEN(ary);
+  VALUE obj = quat_array_build(klass, length, packed_type_option(opts));
+  QuatArrayData *data = quat_array_get(obj);
+  for (long i = 0; i < length; i++) {
+    double q[4];
+    read_quat(rb_ary_entry(ary, i), q);
+    packed_write(data->data, data->type, i, 4, q);
+  }
+  return obj;
+}
+
+static VALUE quat_array_class_multiply(int argc, VALUE *argv, VALUE klass) {
+  VALUE a = Qnil;
+  VALUE b = Qnil;
+  VALUE out = Qnil;
+  QuatOperand bd;
+
+  rb_scan_args(argc, argv, "21", &a, &b, &out);
+  if (!rb_obj_is_kind_of(a, cQuatArray)) {
+    rb_raise(rb_eTypeError, "expected QuatArray");
+  }
+  QuatArrayData *ad = quat_array_get(a);
+  quat_array_operand(b, ad, &bd);
+  VALUE result = quat_array_output(a, out, ad);
+  QuatArrayJob job = {ad->type, ad->data, &bd, NULL, 0.0, NULL,
+                      quat_array_get(result)->data, ad->length};
+  quat_array_run(multiply_job, &job, a, b, result);
+  return result;
+}
+
+VALUE quat_array_aref(VALUE self, VALUE index) {
+  QuatArrayData *data = quat_array_get(self);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    return Qnil;
+  }
+  return quat_array_element(data, idx);
+}
+
+VALUE quat_array_aset(VALUE self, VALUE index, VALUE value) {
+  QuatArrayData *data = quat_array_get(self);
+  packed_buffer_check_writable(self, data->buffer);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    rb_raise(rb_eIndexError, "index %ld out of range", NUM2LONG(index));
+  }
+  double q[4];
+  read_quat(value, q);
+  packed_write(data->data, data->type, idx, 4, q);
+  return value;
+}
+
+VALUE quat_array_each(VALUE self) {
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, packed_array_length);
+  for (long i = 0; i < quat_array_get(self)->length; i++) {
+    rb_yield(quat_array_element(quat_array_get(self), i));
+  }
+  return self;
+}
+
+VALUE quat_array_to_a(VALUE self) {
+  QuatArrayData *data = quat_array_get(self);
+  VALUE ary = rb_ary_new_capa(data->length);
+  for (long i = 0; i < data->length; i++) {
+    rb_ary_push(ary, quat_array_element(data, i));
+  }
+  return ary;
+}
+
+VALUE quat_array_multiply(int argc, VALUE *argv, VALUE self) {
+  VALUE other = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &other, &out);
+  VALUE args[3] = {self, other, out};
+  return quat_array_class_multiply(3, args, rb_obj_class(self));
+}
+
+VALUE quat_array_slerp(int argc, VALUE *argv, VALUE self) {
+  return quat_array_interpolate(argc, argv, self, quat_slerp_values);
+}
+
+VALUE quat_array_nlerp(int argc, VALUE *argv, VALUE self) {
+  return quat_array_interpolate(argc, argv, self, quat_lerp_values);
+}
+
+VALUE quat_array_normalize(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  QuatArrayData *a = quat_array_get(self);
+  VALUE result = quat_array_output(self, out, a);
+  quat_array_unary(normalize_job, self, result);
+  return result;
+}
+
+VALUE quat_array_normalize_bang(VALUE self) {
+  QuatArrayData *a = quat_array_get(self);
+  packed_buffer_check_writable(self, a->buffer);
+  quat_array_unary(normalize_job, self, self);
+  return self;
+}
+
+VALUE quat_array_conjugate(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  QuatArrayData *a = quat_array_get(self);
+  VALUE result = quat_array_output(self, out, a);
+  quat_array_unary(conjugate_job, self, result);
+  return result;
+}
+
+VALUE quat_array_equal(VALUE self, VALUE other) {
+  if (!rb_obj_is_kind_of(other, cQuatArray)) {
+    return Qfalse;
+  }
+  QuatArrayData *a = quat_array_get(self);
+  QuatArrayData *b = quat_array_get(other);
+  if (a->length != b->length) {
+    return Qfalse;
+  }
+  for (long i = 0; i < a->length; i++) {
+    double as[4];
+    double bs[4];
+    const double *av = packed_read(a->data, a->type, i, 4, as);
+    const double *bv = packed_read(b->data, b->type, i, 4, bs);
+    if (av[0] != bv[0] || av[1] != bv[1] || av[2] != bv[2] || av[3] != bv[3]) {
+      return Qfalse;
+    }
+  }
+  return Qtrue;
+}
+
+VALUE quat_array_inspect(VALUE self) {
+  QuatArrayData *a = quat_array_get(self);
+  VALUE str = rb_str_new_cstr("QuatArray[");
+  for (long i = 0; i < a->length; i++) {
+    if (i > 0) {
+      rb_str_cat_cstr(str, ", ");
+    }
+    rb_str_concat(str, rb_inspect(quat_array_element(a, i)));
+  }
+  rb_str_cat_cstr(str, "]");
+  return str;
+}
+
+void Init_quat_array(VALUE module) {
+  cQuatArray = rb_define_class_under(module, "QuatArray", rb_cObject);
+  rb_define_alloc_func(cQuatArray, quat_array_alloc);
+  packed_array_define(cQuatArray, &quat_array_class);
+
+  rb_define_singleton_method(cQuatArray, "from", quat_array_class_from, -1);
+  rb_define_singleton_method(cQuatArray, "multiply", quat_array_class_multiply,
+                             -1);
+
+  rb_define_method(cQuatArray, "[]", quat_array_aref, 1);
+  rb_define_method(cQuatArray, "[]=", quat_array_aset, 2);
+  rb_define_method(cQuatArray, "each", quat_array_each, 0);
+  rb_define_method(cQuatArray, "to_a", quat_array_to_a, 0);
+
+  rb_define_method(cQuatArray, "multiply", quat_array_multiply, -1);
+  rb_define_method(cQuatArray, "slerp", quat_array_slerp, -1);
+  rb_define_method(cQuatArray, "nlerp", quat_array_nlerp, -1);
+  rb_define_method(cQuatArray, "normalize", quat_array_normalize, -1);
+  rb_define_method(cQuatArray, "normalize!", quat_array_normalize_bang, 0);
+  rb_define_method(cQuatArray, "conjugate", quat_array_conjugate, -1);
+  rb_define_method(cQuatArray, "==", quat_array_equal, 1);
+  rb_define_method(cQuatArray, "inspect", quat_array_inspect, 0);
+  rb_define_alias(cQuatArray, "to_s", "inspect");
+}
@@ -0,0 +1,27 @@
+#ifndef QUAT_ARRAY_H
+#define QUAT_ARRAY_H
+
+#include "larb.h"
+#include "packed_buffer.h"
+
+typedef PackedArray QuatArrayData;
+
+void Init_quat_array(VALUE module);
+VALUE quat_array_alloc(VALUE klass);
+QuatArrayData *quat_array_get(VALUE obj);
+VALUE quat_array_build(VALUE klass, long length, PackedType type);
+
+VALUE quat_array_aref(VALUE self, VALUE index);
+VALUE quat_array_aset(VALUE self, VALUE index, VALUE value);
+VALUE quat_array_each(VALUE self);
+VALUE quat_array_to_a(VALUE self);
+VALUE quat_array_multiply(int argc, VALUE *argv, VALUE self);
+VALUE quat_array_slerp(int argc, VALUE *argv, VALUE self);
+VALUE quat_array_nlerp(int argc, VALUE *argv, VALUE self);
+VALUE quat_array_normalize(int argc, VALUE *argv, VALUE self);
+VALUE quat_array_normalize_bang(VALUE self);
+VALUE quat_array_conjugate(int argc, VALUE *argv, VALUE self);
+VALUE quat_array_equal(VALUE self, VALUE other);
+VALUE quat_array_inspect(VALUE self);
+
+#endif
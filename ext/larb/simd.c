@@ -0,0 +1,81 @@
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+SimdLevel simd_level = SIMD_BASELINE;
+static SimdLevel simd_detected = SIMD_BASELINE;
+
+#ifdef LARB_SIMD_X86
+static const char *const simd_names[SIMD_LEVELS] = {"sse2", "avx2", "avx512"};
+
+static SimdLevel simd_detect(void) {
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma")) {
+    return SIMD_BASELINE;
+  }
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+      __builtin_cpu_supports("avx512dq")) {
+    return SIMD_AVX512;
+  }
+  return SIMD_AVX2;
+}
+#else
+static const char *const simd_names[SIMD_LEVELS] = {"scalar"};
+
+static SimdLevel simd_detect(void) { return SIMD_BASELINE; }
+#endif
+
+static int simd_find(const char *name) {
+  for (int i = 0; i < SIMD_LEVELS; i++) {
+    if (strcmp(name, simd_names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static VALUE larb_simd_level(VALUE self) {
+  return ID2SYM(rb_intern(simd_names[simd_level]));
+}
+
+static VALUE larb_set_simd_level(VALUE self, VALUE level) {
+  larb_check_main_ractor("Larb.simd_level");
+  int index = simd_find(rb_id2name(rb_sym2id(rb_to_symbol(level))));
+  if (index < 0) {
+    rb_raise(rb_eArgError, "unknown SIMD level %+" PRIsVALUE, level);
+  }
+  if ((SimdLevel)index > simd_detected) {
+    rb_raise(rb_eArgError, "%s is not supported by this CPU",
+             simd_names[index]);
+  }
+  simd_level = (SimdLevel)index;
+  return level;
+}
+
+static VALUE larb_simd_levels(VALUE self) {
+  VALUE levels = rb_ary_new_capa((long)simd_detected + 1);
+  for (int i = 0; i <= (int)simd_detected; i++) {
+    rb_ary_push(levels, ID2SYM(rb_intern(simd_names[i])));
+  }
+  return levels;
+}
+
+void Init_simd(VALUE module) {
+  simd_detected = simd_detect();
+  simd_level = simd_detected;
+
+  const char *env = getenv("LARB_SIMD");
+  if (env != NULL && *env != '\0') {
+    int index = simd_find(env);
+    if (index >= 0 && (SimdLevel)index <= simd_detected) {
+      simd_level = (SimdLevel)index;
+    } else {
+      rb_warn("ignoring unsupported LARB_SIMD=%s", env);
+    }
+  }
+
+  rb_define_singleton_method(module, "simd_level", larb_simd_level, 0);
+  rb_define_singleton_method(module, "simd_level=", larb_set_simd_level, 1);
+  rb_define_singleton_method(module, "simd_levels", larb_simd_levels, 0);
+}
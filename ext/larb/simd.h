@@ -0,0 +1,55 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "larb.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LARB_SIMD_X86 1
+#endif
+
+typedef enum {
+  SIMD_BASELINE,
+  SIMD_AVX2,
+  SIMD_AVX512,
+} SimdLevel;
+
+extern SimdLevel simd_level;
+
+void Init_simd(VALUE module);
+
+#define SIMD_PRAGMA(x) _Pragma(#x)
+
+#ifdef LARB_SIMD_X86
+#define SIMD_LEVELS 3
+#define SIMD_AVX2_TARGET "avx2,fma"
+#define SIMD_AVX512_TARGET "avx512f,avx512vl,avx512dq,avx2,fma"
+#ifdef __clang__
+#define SIMD_BEGIN(isa)                                                        \
+  SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))),              \
+                                   apply_to = function))
+#define SIMD_END SIMD_PRAGMA(clang attribute pop)
+#else
+#define SIMD_BEGIN(isa)                                                        \
+  SIMD_PRAGMA(GCC push_options) SIMD_PRAGMA(GCC target(isa))
+#define SIMD_END SIMD_PRAGMA(GCC pop_options)
+#endif
+#define SIMD_SELECT(name)                                                      \
+  (simd_level == SIMD_AVX512 ? name##_avx512                                   \
+   : simd_level == SIMD_AVX2 ? name##_avx2                                     \
+                             : name)
+#define SIMD_KERNELS(name)                                                     \
+  {                                                                            \
+    {name##_kernel_f64, name##_kernel_f32},                                    \
+        {name##_kernel_f64_avx2, name##_kernel_f32_avx2},                      \
+        {name##_kernel_f64_avx512, name##_kernel_f32_avx512},                  \
+  }
+#else
+#define SIMD_LEVELS 1
+#define SIMD_SELECT(name) name
+#define SIMD_KERNELS(name)                                                     \
+  {                                                                            \
+    { name##_kernel_f64, name##_kernel_f32 }                                   \
+  }
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#define SCALAR double
+#define SQRT sqrt
+#define KERNEL(name) name##_kernel_f64
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+#define SCALAR float
+#define SQRT sqrtf
+#define KERNEL(name) name##_kernel_f32
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+#ifdef LARB_SIMD_X86
+SIMD_BEGIN(SIMD_AVX2_TARGET)
+
+#define SCALAR double
+#define SQRT sqrt
+#define KERNEL(name) name##_kernel_f64_avx2
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+#define SCALAR float
+#define SQRT sqrtf
+#define KERNEL(name) name##_kernel_f32_avx2
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+SIMD_END
+SIMD_BEGIN(SIMD_AVX512_TARGET)
+
+#define SCALAR double
+#define SQRT sqrt
+#define KERNEL(name) name##_kernel_f64_avx512
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+#define SCALAR float
+#define SQRT sqrtf
+#define KERNEL(name) name##_kernel_f32_avx512
+#include SIMD_KERNELS_HEADER
+#undef SCALAR
+#undef SQRT
+#undef KERNEL
+
+SIMD_END
+#endif
@@ -0,0 +1,104 @@
+#include "task.h"
+
+#include <ruby/atomic.h>
+
+static void task_mark(void *ptr) {
+  TaskData *data = ptr;
+  rb_gc_mark(data->thread);
+}
+
+static size_t task_memsize(const void *ptr) {
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(TaskData);
+}
+
+static const rb_data_type_t task_type = {
+    "Task",
+    {task_mark, RUBY_TYPED_DEFAULT_FREE, task_memsize},
+    0,
+    0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        LARB_TYPED_EMBEDDABLE,
+};
+
+static VALUE cTask = Qnil;
+static rb_atomic_t running = 0;
+static ID id_task;
+static ID id_alive_p;
+static ID id_new;
+static ID id_join;
+static ID id_value;
+static ID id_report_on_exception_set;
+
+static TaskData *task_get(VALUE obj) {
+  TaskData *data = NULL;
+  TypedData_Get_Struct(obj, TaskData, &task_type, data);
+  return data;
+}
+
+bool task_current_p(void) {
+  return RUBY_ATOMIC_LOAD(running) > 0 &&
+         RTEST(rb_attr_get(rb_thread_current(), id_task));
+}
+
+static VALUE task_call(VALUE block) {
+  VALUE thread = rb_thread_current();
+  rb_funcall(thread, id_report_on_exception_set, 1, Qfalse);
+  rb_ivar_set(thread, id_task, Qtrue);
+  return rb_proc_call_with_block(block, 0, NULL, Qnil);
+}
+
+static VALUE task_finish(VALUE unused) {
+  RUBY_ATOMIC_DEC(running);
+  return Qnil;
+}
+
+static VALUE task_body(RB_BLOCK_CALL_FUNC_ARGLIST(yielded, block)) {
+  RUBY_ATOMIC_INC(running);
+  return rb_ensure(task_call, block, task_finish, Qnil);
+}
+
+static VALUE larb_async(VALUE self) {
+  if (!rb_block_given_p()) {
+    rb_raise(rb_eArgError, "no block given");
+  }
+  VALUE block = rb_block_proc();
+  TaskData *data = NULL;
+  VALUE obj = TypedData_Make_Struct(cTask, TaskData, &task_type, data);
+  RB_OBJ_WRITE(obj, &data->thread,
+               rb_block_call(rb_cThread, id_new, 0, NULL, task_body, block));
+  return obj;
+}
+
+static VALUE task_wait(int argc, VALUE *argv, VALUE self) {
+  VALUE timeout = Qnil;
+
+  rb_scan_args(argc, argv, "01", &timeout);
+  VALUE thread = task_get(self)->thread;
+  return NIL_P(rb_funcall(thread, id_join, 1, timeout)) ? Qnil : self;
+}
+
+static VALUE task_done_p(VALUE self) {
+  return RTEST(rb_funcall(task_get(self)->thread, id_alive_p, 0)) ? Qfalse
+                                                                  : Qtrue;
+}
+
+static VALUE task_value(VALUE self) {
+  return rb_funcall(task_get(self)->thread, id_value, 0);
+}
+
+void Init_task(VALUE module) {
+  id_task = rb_intern("__larb_task__");
+  id_alive_p = rb_intern("alive?");
+  id_new = rb_intern("new");
+  id_join = rb_intern("join");
+  id_value = rb_intern("value");
+  id_report_on_exception_set = rb_intern("report_on_exception=");
+
+  cTask = rb_define_class_under(module, "Task", rb_cObject);
+  rb_undef_alloc_func(cTask);
+
+  rb_define_singleton_method(module, "async", larb_async, 0);
+  rb_define_method(cTask, "wait", task_wait, -1);
+  rb_define_method(cTask, "done?", task_done_p, 0);
+  rb_define_method(cTask, "value", task_value, 0);
+}
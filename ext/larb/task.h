@@ -0,0 +1,13 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "larb.h"
+
+typedef struct {
+  VALUE thread;
+} TaskData;
+
+void Init_task(VALUE module);
+bool task_current_p(void);
+
+#endif
@@ -0,0 +1,216 @@
+#include "thread_pool.h"
+
+#include <ruby/thread.h>
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+#define THREAD_POOL_MAX 256
+
+static int pool_threads = 1;
+
+static void run_chunks(ThreadPoolTask task, void *arg, long length,
+                       long *next) {
+  for (;;) {
+    long begin = __atomic_fetch_add(next, THREAD_POOL_CHUNK, __ATOMIC_RELAXED);
+    if (begin >= length) {
+      return;
+    }
+    long end = length - begin < THREAD_POOL_CHUNK ? length
+                                                   : begin + THREAD_POOL_CHUNK;
+    task(arg, begin, end);
+  }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+static pthread_mutex_t dispatch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+static pthread_t *workers = NULL;
+static int worker_count = 0;
+static int stopping = 0;
+static unsigned long generation = 0;
+static unsigned long spawn_generation = 0;
+static int active = 0;
+
+static ThreadPoolTask current_task = NULL;
+static void *current_arg = NULL;
+static long current_length = 0;
+static long next_chunk = 0;
+
+static void *worker_main(void *unused) {
+  unsigned long seen = spawn_generation;
+
+  pthread_mutex_lock(&state_lock);
+  for (;;) {
+    while (generation == seen && !stopping) {
+      pthread_cond_wait(&work_ready, &state_lock);
+    }
+    if (stopping) {
+      break;
+    }
+    seen = generation;
+    pthread_mutex_unlock(&state_lock);
+
+    run_chunks(current_task, current_arg, current_length, &next_chunk);
+
+    pthread_mutex_lock(&state_lock);
+    if (--active == 0) {
+      pthread_cond_signal(&work_done);
+    }
+  }
+  pthread_mutex_unlock(&state_lock);
+  return NULL;
+}
+
+static void start_workers(int count) {
+  sigset_t all;
+  sigset_t saved;
+
+  workers = malloc(sizeof(pthread_t) * (size_t)count);
+  if (workers == NULL) {
+    return;
+  }
+  spawn_generation = generation;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &saved);
+  for (int i = 0; i < count; i++) {
+    if (pthread_create(&workers[i], NULL, worker_main, NULL) != 0) {
+      break;
+    }
+    worker_count++;
+  }
+  pthread_sigmask(SIG_SETMASK, &saved, NULL);
+  if (worker_count == 0) {
+    free(workers);
+    workers = NULL;
+  }
+}
+
+static void stop_workers(void) {
+  pthread_mutex_lock(&state_lock);
+  stopping = 1;
+  pthread_cond_broadcast(&work_ready);
+  pthread_mutex_unlock(&state_lock);
+  for (int i = 0; i < worker_count; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+  workers = NULL;
+  worker_count = 0;
+  stopping = 0;
+}
+
+static void reset_after_fork(void) {
+  pthread_mutex_init(&dispatch_lock, NULL);
+  pthread_mutex_init(&state_lock, NULL);
+  pthread_cond_init(&work_ready, NULL);
+  pthread_cond_init(&work_done, NULL);
+  free(workers);
+  workers = NULL;
+  worker_count = 0;
+  stopping = 0;
+  active = 0;
+}
+
+void thread_pool_run(ThreadPoolTask task, void *arg, long length) {
+  if (pool_threads <= 1 || length <= THREAD_POOL_CHUNK ||
+      pthread_mutex_trylock(&dispatch_lock) != 0) {
+    task(arg, 0, length);
+    return;
+  }
+  if (worker_count == 0) {
+    start_workers(pool_threads - 1);
+  }
+  if (worker_count == 0) {
+    pthread_mutex_unlock(&dispatch_lock);
+    task(arg, 0, length);
+    return;
+  }
+
+  pthread_mutex_lock(&state_lock);
+  current_task = task;
+  current_arg = arg;
+  current_length = length;
+  next_chunk = 0;
+  active = worker_count;
+  generation++;
+  pthread_cond_broadcast(&work_ready);
+  pthread_mutex_unlock(&state_lock);
+
+  run_chunks(task, arg, length, &next_chunk);
+
+  pthread_mutex_lock(&state_lock);
+  while (active > 0) {
+    pthread_cond_wait(&work_done, &state_lock);
+  }
+  pthread_mutex_unlock(&state_lock);
+  pthread_mutex_unlock(&dispatch_lock);
+}
+
+static void *resize_pool(void *ptr) {
+  int *threads = ptr;
+  pthread_mutex_lock(&dispatch_lock);
+  if (worker_count > 0) {
+    stop_workers();
+  }
+  pool_threads = *threads;
+  pthread_mutex_unlock(&dispatch_lock);
+  return NULL;
+}
+
+static void set_threads(int threads) {
+  rb_thread_call_without_gvl(resize_pool, &threads, NULL, NULL);
+}
+
+#else
+
+void thread_pool_run(ThreadPoolTask task, void *arg, long length) {
+  task(arg, 0, length);
+}
+
+static void set_threads(int threads) { pool_threads = threads; }
+
+#endif
+
+static int parse_threads(VALUE threads) {
+  long count = NUM2LONG(threads);
+  if (count < 1 || count > THREAD_POOL_MAX) {
+    rb_raise(rb_eArgError, "thread count must be between 1 and %d",
+             THREAD_POOL_MAX);
+  }
+  return (int)count;
+}
+
+static VALUE larb_threads(VALUE self) { return INT2NUM(pool_threads); }
+
+static VALUE larb_set_threads(VALUE self, VALUE threads) {
+  larb_check_main_ractor("Larb.threads");
+  set_threads(parse_threads(threads));
+  return threads;
+}
+
+void Init_thread_pool(VALUE module) {
+  const char *env = getenv("LARB_THREADS");
+  if (env != NULL && *env != '\0') {
+    char *end = NULL;
+    long count = strtol(env, &end, 10);
+    if (*end == '\0' && count >= 1 && count <= THREAD_POOL_MAX) {
+      pool_threads = (int)count;
+    } else {
+      rb_warn("ignoring invalid LARB_THREADS=%s", env);
+    }
+  }
+#ifdef HAVE_PTHREAD_H
+  pthread_atfork(NULL, NULL, reset_after_fork);
+#endif
+
+  rb_define_singleton_method(module, "threads", larb_threads, 0);
+  rb_define_singleton_method(module, "threads=", larb_set_threads, 1);
+}
@@ -0,0 +1,13 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "larb.h"
+
+#define THREAD_POOL_CHUNK 4096
+
+typedef void (*ThreadPoolTask)(void *arg, long begin, long end);
+
+void Init_thread_pool(VALUE module);
+void thread_pool_run(ThreadPoolTask task, void *arg, long length);
+
+#endif
@@ -2,36 +2,32 @@
 
 #include <math.h>
 
-static void vec2_free(void *ptr) {
-  xfree(ptr);
-}
+#include "vec3.h"
 
 static size_t vec2_memsize(const void *ptr) {
-  return sizeof(Vec2Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Vec2Data);
 }
 
 static const rb_data_type_t vec2_type = {
     "Vec2",
-    {0, vec2_free, vec2_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, vec2_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cVec2 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cVec2 = Qnil;
+static VALUE vec2_const_zero = Qnil;
+static VALUE vec2_const_one = Qnil;
 
-static Vec2Data *vec2_get(VALUE obj) {
+Vec2Data *vec2_get(VALUE obj) {
   Vec2Data *data = NULL;
   TypedData_Get_Struct(obj, Vec2Data, &vec2_type, data);
   return data;
 }
 
-static VALUE vec2_build(VALUE klass, double x, double y) {
+VALUE vec2_build(VALUE klass, double x, double y) {
   VALUE obj = vec2_alloc(klass);
   Vec2Data *data = vec2_get(obj);
   data->x = x;
@@ -40,13 +36,15 @@ static VALUE vec2_build(VALUE klass, double x, double y) {
 }
 
 VALUE vec2_alloc(VALUE klass) {
-  Vec2Data *data = ALLOC(Vec2Data);
+  Vec2Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Vec2Data, &vec2_type, data);
   data->x = 0.0;
   data->y = 0.0;
-  return TypedData_Wrap_Struct(klass, &vec2_type, data);
+  return obj;
 }
 
 VALUE vec2_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE vx = Qnil;
   VALUE vy = Qnil;
   Vec2Data *data = vec2_get(self);
@@ -58,16 +56,31 @@ VALUE vec2_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE vec2_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *vec2_get(self) = *vec2_get(other);
+  return self;
+}
+
 static VALUE vec2_class_bracket(VALUE klass, VALUE x, VALUE y) {
   return vec2_build(klass, value_to_double(x), value_to_double(y));
 }
 
+static VALUE vec2_constant(VALUE klass, VALUE constant) {
+  if (klass == cVec2) {
+    return constant;
+  }
+  VALUE obj = vec2_alloc(klass);
+  *vec2_get(obj) = *vec2_get(constant);
+  return obj;
+}
+
 static VALUE vec2_class_zero(VALUE klass) {
-  return vec2_build(klass, 0.0, 0.0);
+  return vec2_constant(klass, vec2_const_zero);
 }
 
 static VALUE vec2_class_one(VALUE klass) {
-  return vec2_build(klass, 1.0, 1.0);
+  return vec2_constant(klass, vec2_const_one);
 }
 
 static VALUE vec2_get_x(VALUE self) {
@@ -76,8 +89,9 @@ static VALUE vec2_get_x(VALUE self) {
 }
 
 static VALUE vec2_set_x(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec2Data *data = vec2_get(self);
-  data->x = NUM2DBL(value);
+  data->x = value_to_double(value);
   return value;
 }
 
@@ -87,8 +101,9 @@ static VALUE vec2_get_y(VALUE self) {
 }
 
 static VALUE vec2_set_y(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec2Data *data = vec2_get(self);
-  data->y = NUM2DBL(value);
+  data->y = value_to_double(value);
   return value;
 }
 
@@ -106,13 +121,13 @@ VALUE vec2_sub(VALUE self, VALUE other) {
 
 VALUE vec2_mul(VALUE self, VALUE scalar) {
   Vec2Data *a = vec2_get(self);
-  double s = NUM2DBL(scalar);
+  double s = value_to_double(scalar);
   return vec2_build(rb_obj_class(self), a->x * s, a->y * s);
 }
 
 VALUE vec2_div(VALUE self, VALUE scalar) {
   Vec2Data *a = vec2_get(self);
-  double s = NUM2DBL(scalar);
+  double s = value_to_double(scalar);
   return vec2_build(rb_obj_class(self), a->x / s, a->y / s);
 }
 
@@ -144,6 +159,7 @@ VALUE vec2_normalize(VALUE self) {
 }
 
 VALUE vec2_normalize_bang(VALUE self) {
+  rb_check_frozen(self);
   Vec2Data *a = vec2_get(self);
   double len = sqrt(a->x * a->x + a->y * a->y);
   a->x /= len;
@@ -151,10 +167,55 @@ VALUE vec2_normalize_bang(VALUE self) {
   return self;
 }
 
+VALUE vec2_add_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec2Data *a = vec2_get(self);
+  Vec2Data *b = vec2_get(other);
+  a->x += b->x;
+  a->y += b->y;
+  return self;
+}
+
+VALUE vec2_sub_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec2Data *a = vec2_get(self);
+  Vec2Data *b = vec2_get(other);
+  a->x -= b->x;
+  a->y -= b->y;
+  return self;
+}
+
+VALUE vec2_mul_bang(VALUE self, VALUE scalar) {
+  rb_check_frozen(self);
+  Vec2Data *a = vec2_get(self);
+  double s = value_to_double(scalar);
+  a->x *= s;
+  a->y *= s;
+  return self;
+}
+
+VALUE vec2_negate_bang(VALUE self) {
+  rb_check_frozen(self);
+  Vec2Data *a = vec2_get(self);
+  a->x = -a->x;
+  a->y = -a->y;
+  return self;
+}
+
+VALUE vec2_lerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  Vec2Data *a = vec2_get(self);
+  Vec2Data *b = vec2_get(other);
+  double s = value_to_double(t);
+  a->x += (b->x - a->x) * s;
+  a->y += (b->y - a->y) * s;
+  return self;
+}
+
 VALUE vec2_lerp(VALUE self, VALUE other, VALUE t) {
   Vec2Data *a = vec2_get(self);
   Vec2Data *b = vec2_get(other);
-  double s = NUM2DBL(t);
+  double s = value_to_double(t);
   return vec2_build(rb_obj_class(self), a->x + (b->x - a->x) * s,
                     a->y + (b->y - a->y) * s);
 }
@@ -173,12 +234,13 @@ VALUE vec2_aref(VALUE self, VALUE index) {
 }
 
 VALUE vec2_aset(VALUE self, VALUE index, VALUE value) {
+  rb_check_frozen(self);
   Vec2Data *a = vec2_get(self);
   long idx = NUM2LONG(index);
   if (idx == 0) {
-    a->x = NUM2DBL(value);
+    a->x = value_to_double(value);
   } else {
-    a->y = NUM2DBL(value);
+    a->y = value_to_double(value);
   }
   return value;
 }
@@ -199,7 +261,7 @@ VALUE vec2_near(int argc, VALUE *argv, VALUE self) {
   rb_scan_args(argc, argv, "11", &other, &epsilon);
   Vec2Data *a = vec2_get(self);
   Vec2Data *b = vec2_get(other);
-  double eps = NIL_P(epsilon) ? 1e-6 : NUM2DBL(epsilon);
+  double eps = NIL_P(epsilon) ? 1e-6 : value_to_double(epsilon);
 
   if (fabs(a->x - b->x) < eps && fabs(a->y - b->y) < eps) {
     return Qtrue;
@@ -220,7 +282,7 @@ VALUE vec2_angle_to(VALUE self, VALUE other) {
 
 VALUE vec2_rotate(VALUE self, VALUE radians) {
   Vec2Data *a = vec2_get(self);
-  double r = NUM2DBL(radians);
+  double r = value_to_double(radians);
   double c = cos(r);
   double s = sin(r);
   return vec2_build(rb_obj_class(self), a->x * c - a->y * s,
@@ -264,7 +326,7 @@ VALUE vec2_reflect(VALUE self, VALUE normal) {
 
 VALUE vec2_clamp_length(VALUE self, VALUE max_length) {
   Vec2Data *a = vec2_get(self);
-  double max_len = NUM2DBL(max_length);
+  double max_len = value_to_double(max_length);
   double len_sq = a->x * a->x + a->y * a->y;
   if (len_sq <= max_len * max_len) {
     return self;
@@ -278,9 +340,7 @@ VALUE vec2_to_vec3(int argc, VALUE *argv, VALUE self) {
   Vec2Data *a = vec2_get(self);
 
   rb_scan_args(argc, argv, "01", &vz);
-  VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
-  return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(a->x),
-                    DBL2NUM(a->y), NIL_P(vz) ? DBL2NUM(0.0) : vz);
+  return vec3_build(cVec3, a->x, a->y, NIL_P(vz) ? 0.0 : value_to_double(vz));
 }
 
 VALUE vec2_inspect(VALUE self) {
@@ -300,6 +360,7 @@ void Init_vec2(VALUE module) {
 
   rb_define_alloc_func(cVec2, vec2_alloc);
   rb_define_method(cVec2, "initialize", vec2_initialize, -1);
+  rb_define_method(cVec2, "initialize_copy", vec2_initialize_copy, 1);
 
   rb_define_singleton_method(cVec2, "[]", vec2_class_bracket, 2);
   rb_define_singleton_method(cVec2, "zero", vec2_class_zero, 0);
@@ -322,6 +383,12 @@ void Init_vec2(VALUE module) {
   rb_define_method(cVec2, "normalize", vec2_normalize, 0);
   rb_define_method(cVec2, "normalize!", vec2_normalize_bang, 0);
   rb_define_method(cVec2, "lerp", vec2_lerp, 2);
+  rb_define_method(cVec2, "add!", vec2_add_bang, 1);
+  rb_define_method(cVec2, "sub!", vec2_sub_bang, 1);
+  rb_define_method(cVec2, "mul!", vec2_mul_bang, 1);
+  rb_define_alias(cVec2, "scale!", "mul!");
+  rb_define_method(cVec2, "negate!", vec2_negate_bang, 0);
+  rb_define_method(cVec2, "lerp!", vec2_lerp_bang, 2);
   rb_define_method(cVec2, "to_a", vec2_to_a, 0);
   rb_define_method(cVec2, "[]", vec2_aref, 1);
   rb_define_method(cVec2, "[]=", vec2_aset, 2);
@@ -339,4 +406,9 @@ void Init_vec2(VALUE module) {
   rb_define_method(cVec2, "to_vec3", vec2_to_vec3, -1);
   rb_define_method(cVec2, "inspect", vec2_inspect, 0);
   rb_define_alias(cVec2, "to_s", "inspect");
+
+  larb_define_constant(cVec2, "ZERO", &vec2_const_zero,
+                       vec2_build(cVec2, 0.0, 0.0));
+  larb_define_constant(cVec2, "ONE", &vec2_const_one,
+                       vec2_build(cVec2, 1.0, 1.0));
 }
@@ -8,9 +8,13 @@ typedef struct {
   double y;
 } Vec2Data;
 
+extern VALUE cVec2;
+
 void Init_vec2(VALUE module);
 VALUE vec2_alloc(VALUE klass);
 VALUE vec2_initialize(int argc, VALUE *argv, VALUE self);
+Vec2Data *vec2_get(VALUE obj);
+VALUE vec2_build(VALUE klass, double x, double y);
 
 VALUE vec2_add(VALUE self, VALUE other);
 VALUE vec2_sub(VALUE self, VALUE other);
@@ -23,6 +27,11 @@ VALUE vec2_length_squared(VALUE self);
 VALUE vec2_normalize(VALUE self);
 VALUE vec2_normalize_bang(VALUE self);
 VALUE vec2_lerp(VALUE self, VALUE other, VALUE t);
+VALUE vec2_add_bang(VALUE self, VALUE other);
+VALUE vec2_sub_bang(VALUE self, VALUE other);
+VALUE vec2_mul_bang(VALUE self, VALUE scalar);
+VALUE vec2_negate_bang(VALUE self);
+VALUE vec2_lerp_bang(VALUE self, VALUE other, VALUE t);
 VALUE vec2_to_a(VALUE self);
 VALUE vec2_aref(VALUE self, VALUE index);
 VALUE vec2_aset(VALUE self, VALUE index, VALUE value);
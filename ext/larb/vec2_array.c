@@ -0,0 +1,447 @@
+#include "vec2_array.h"
+
+#include <math.h>
+
+#include "packed_buffer.h"
+#include "simd.h"
+#include "vec2.h"
+
+#define SIMD_KERNELS_HEADER "vec2_array_kernels.h"
+#include "simd_kernels.h"
+#undef SIMD_KERNELS_HEADER
+
+static const PackedArrayClass vec2_array_class;
+
+static const rb_data_type_t vec2_array_type = {
+    "Vec2Array",
+    {packed_array_mark, RUBY_TYPED_DEFAULT_FREE, packed_array_memsize},
+    0,
+    (void *)&vec2_array_class,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
+};
+
+static const PackedArrayClass vec2_array_class = {
+    &vec2_array_type,
+    2,
+    true,
+    PACKED_FLOAT64,
+    NULL,
+    {{"d", 8, 16, 1, {2}, {8}}, {"f", 4, 8, 1, {2}, {4}}},
+};
+
+static VALUE cVec2Array = Qnil;
+
+typedef union {
+  double f64[2];
+  float f32[2];
+} Vec2Scratch;
+
+typedef struct {
+  void (*f64)(const double *, const double *, long, double *, long);
+  void (*f32)(const float *, const float *, long, float *, long);
+} Vec2ArrayKernel;
+
+static const Vec2ArrayKernel add_kernel[SIMD_LEVELS] = SIMD_KERNELS(add);
+static const Vec2ArrayKernel sub_kernel[SIMD_LEVELS] = SIMD_KERNELS(sub);
+static const Vec2ArrayKernel mul_kernel[SIMD_LEVELS] = SIMD_KERNELS(mul);
+
+static size_t element_size(PackedType type) {
+  return packed_array_element_size(&vec2_array_class, type);
+}
+
+Vec2ArrayData *vec2_array_get(VALUE obj) {
+  return packed_array_get(obj, &vec2_array_class);
+}
+
+VALUE vec2_array_build(VALUE klass, long length, PackedType type) {
+  return packed_array_build(klass, &vec2_array_class, length, type);
+}
+
+static void read_vec2(VALUE vec, double *out) {
+  Vec2Data *v = vec2_get(vec);
+  out[0] = v->x;
+  out[1] = v->y;
+}
+
+static VALUE vec2_new(const double *v) {
+  return vec2_build(cVec2, v[0], v[1]);
+}
+
+static VALUE vec2_array_element(Vec2ArrayData *data, long index) {
+  double scratch[2];
+  return vec2_new(packed_read(data->data, data->type, index, 2, scratch));
+}
+
+static const void *vec2_array_operand(VALUE other, Vec2ArrayData *a,
+                                      Vec2Scratch *scratch, long *stride) {
+  if (rb_obj_is_kind_of(other, cVec2Array)) {
+    Vec2ArrayData *b = vec2_array_get(other);
+    packed_check_length(a->length, b->length);
+    packed_type_check(a->type, b->type);
+    *stride = 2;
+    return b->data;
+  }
+  if (rb_obj_is_kind_of(other, cVec2)) {
+    double v[2];
+    read_vec2(other, v);
+    packed_write(scratch, a->type, 0, 2, v);
+    *stride = 0;
+    return scratch;
+  }
+  rb_raise(rb_eTypeError, "expected Vec2Array or Vec2");
+  return NULL;
+}
+
+static VALUE vec2_array_output(VALUE self, VALUE out, Vec2ArrayData *a) {
+  if (NIL_P(out)) {
+    return vec2_array_build(rb_obj_class(self), a->length, a->type);
+  }
+  if (!rb_obj_is_kind_of(out, cVec2Array)) {
+    rb_raise(rb_eTypeError, "expected Vec2Array for output");
+  }
+  Vec2ArrayData *data = vec2_array_get(out);
+  packed_check_length(a->length, data->length);
+  packed_type_check(a->type, data->type);
+  packed_buffer_check_writable(out, data->buffer);
+  return out;
+}
+
+typedef struct {
+  const Vec2ArrayKernel *kernel;
+  PackedType type;
+  const void *a;
+  const void *b;
+  long stride;
+  double t;
+  double c;
+  double s;
+  void *out;
+  long length;
+} Vec2ArrayJob;
+
+static void binary_job(void *ptr, long begin, long end) {
+  Vec2ArrayJob *job = ptr;
+  long b = begin * job->stride;
+  if (job->type == PACKED_FLOAT32) {
+    job->kernel[simd_level].f32((const float *)job->a + begin * 2,
+                                (const float *)job->b + b, job->stride,
+                                (float *)job->out + begin * 2, end - begin);
+  } else {
+    job->kernel[simd_level].f64((const double *)job->a + begin * 2,
+                                (const double *)job->b + b, job->stride,
+                                (double *)job->out + begin * 2, end - begin);
+  }
+}
+
+static void normalize_job(void *ptr, long begin, long end) {
+  Vec2ArrayJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(normalize_kernel_f32)
+    ((const float *)job->a + begin * 2, (float *)job->out + begin * 2,
+     end - begin);
+  } else {
+    SIMD_SELECT(normalize_kernel_f64)
+    ((const double *)job->a + begin * 2, (double *)job->out + begin * 2,
+     end - begin);
+  }
+}
+
+static void rotate_job(void *ptr, long begin, long end) {
+  Vec2ArrayJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(rotate_kernel_f32)
+    ((const float *)job->a + begin * 2, (float)job->c, (float)job->s,
+     (float *)job->out + begin * 2, end - begin);
+  } else {
+    SIMD_SELECT(rotate_kernel_f64)
+    ((const double *)job->a + begin * 2, job->c, job->s,
+     (double *)job->out + begin * 2, end - begin);
+  }
+}
+
+static void lerp_job(void *ptr, long begin, long end) {
+  Vec2ArrayJob *job = ptr;
+  long b = begin * job->stride;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(lerp_kernel_f32)
+    ((const float *)job->a + begin * 2, (const float *)job->b + b,
+     job->stride, (float)job->t, (float *)job->out + begin * 2, end - begin);
+  } else {
+    SIMD_SELECT(lerp_kernel_f64)
+    ((const double *)job->a + begin * 2, (const double *)job->b + b,
+     job->stride, job->t, (double *)job->out + begin * 2, end - begin);
+  }
+}
+
+static PackedPin vec2_array_pin(VALUE obj) {
+  if (!rb_obj_is_kind_of(obj, cVec2Array)) {
+    return packed_pin(Qnil, Qnil, NULL);
+  }
+  Vec2ArrayData *data = vec2_array_get(obj);
+  return packed_pin(obj, data->buffer, &data->locks);
+}
+
+static void vec2_array_run(PackedJob run, Vec2ArrayJob *job, VALUE self,
+                           VALUE other, VALUE result) {
+  size_t size = (size_t)job->length * element_size(job->type);
+  packed_check_overlap(job->a, size, job->out, size);
+  packed_check_overlap(job->b, job->stride ? size : 0, job->out, size);
+  PackedPin pins[3] = {vec2_array_pin(self), vec2_array_pin(other),
+                       vec2_array_pin(result)};
+  packed_run(job->length, run, job, pins, 3);
+}
+
+static VALUE vec2_array_binary(int argc, VALUE *argv, VALUE self,
+                               const Vec2ArrayKernel *kernel) {
+  VALUE other = Qnil;
+  VALUE out = Qnil;
+  Vec2Scratch scratch = {{0}};
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "11", &other, &out);
+  Vec2ArrayData *a = vec2_array_get(self);
+  const void *b = vec2_array_operand(other, a, &scratch, &stride);
+  VALUE result = vec2_array_output(self, out, a);
+  Vec2ArrayJob job = {kernel, a->type, a->data, b, stride, 0.0, 0.0, 0.0,
+                      vec2_array_get(result)->data, a->length};
+  vec2_array_run(binary_job, &job, self, other, result);
+  return result;
+}
+
+static void vec2_array_normalize_into(VALUE self, VALUE result) {
+  Vec2ArrayData *a = vec2_array_get(self);
+  Vec2ArrayJob job = {NULL, a->type, a->data, NULL, 0, 0.0, 0.0, 0.0,
+                      vec2_array_get(result)->data, a->length};
+  vec2_array_run(normalize_job, &job, self, Qnil, result);
+}
+
+VALUE vec2_array_alloc(VALUE klass) {
+  return packed_array_alloc(klass, &vec2_array_class);
+}
+
+static VALUE vec2_array_class_from(int argc, VALUE *argv, VALUE klass) {
+  VALUE points = Qnil;
+  VALUE opts = Qnil;
+
+  rb_scan_args(argc, argv, "1:", &points, &opts);
+  VALUE ary = rb_check_array_type(points);
+  if (NIL_P(ary)) {
+    rb_raise(rb_eTypeError, "expected Array");
+  }
+
+  long length = RARRAY_LEN(ary);
+  VALUE obj = vec2_array_build(klass, length, packed_type_option(opts));
+  Vec2ArrayData *data = vec2_array_get(obj);
+  for (long i = 0; i < length; i++) {
+    double v[2];
+    read_vec2(rb_ary_entry(ary, i), v);
+    packed_write(data->data, data->type, i, 2, v);
+  }
+  return obj;
+}
+
+VALUE vec2_array_aref(VALUE self, VALUE index) {
+  Vec2ArrayData *data = vec2_array_get(self);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    return Qnil;
+  }
+  return vec2_array_element(data, idx);
+}
+
+VALUE vec2_array_aset(VALUE self, VALUE index, VALUE value) {
+  Vec2ArrayData *data = vec2_array_get(self);
+  packed_buffer_check_writable(self, data->buffer);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    rb_raise(rb_eIndexError, "index %ld out of range", NUM2LONG(index));
+  }
+  double v[2];
+  read_vec2(value, v);
+  packed_write(data->data, data->type, idx, 2, v);
+  return value;
+}
+
+VALUE vec2_array_each(VALUE self) {
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, packed_array_length);
+  for (long i = 0; i < vec2_array_get(self)->length; i++) {
+    rb_yield(vec2_array_element(vec2_array_get(self), i));
+  }
+  return self;
+}
+
+VALUE vec2_array_to_a(VALUE self) {
+  Vec2ArrayData *data = vec2_array_get(self);
+  VALUE ary = rb_ary_new_capa(data->length);
+  for (long i = 0; i < data->length; i++) {
+    rb_ary_push(ary, vec2_array_element(data, i));
+  }
+  return ary;
+}
+
+VALUE vec2_array_add(int argc, VALUE *argv, VALUE self) {
+  return vec2_array_binary(argc, argv, self, add_kernel);
+}
+
+VALUE vec2_array_sub(int argc, VALUE *argv, VALUE self) {
+  return vec2_array_binary(argc, argv, self, sub_kernel);
+}
+
+VALUE vec2_array_scale(int argc, VALUE *argv, VALUE self) {
+  VALUE scalar = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &scalar, &out);
+  if (!rb_obj_is_kind_of(scalar, rb_cNumeric)) {
+    return vec2_array_binary(argc, argv, self, mul_kernel);
+  }
+
+  double s = value_to_double(scalar);
+  double factor[2] = {s, s};
+  Vec2Scratch scratch = {{0}};
+  Vec2ArrayData *a = vec2_array_get(self);
+  packed_write(&scratch, a->type, 0, 2, factor);
+  VALUE result = vec2_array_output(self, out, a);
+  Vec2ArrayJob job = {mul_kernel, a->type, a->data, &scratch, 0, 0.0, 0.0,
+                      0.0, vec2_array_get(result)->data, a->length};
+  vec2_array_run(binary_job, &job, self, Qnil, result);
+  return result;
+}
+
+VALUE vec2_array_dot(VALUE self, VALUE other) {
+  Vec2Scratch scratch = {{0}};
+  long stride = 0;
+  Vec2ArrayData *a = vec2_array_get(self);
+  const void *b = vec2_array_operand(other, a, &scratch, &stride);
+
+  VALUE ary = rb_ary_new_capa(a->length);
+  for (long i = 0; i < a->length; i++) {
+    double as[2];
+    double bs[2];
+    const double *av = packed_read(a->data, a->type, i, 2, as);
+    const double *bv = packed_read(b, a->type, stride ? i : 0, 2, bs);
+    rb_ary_push(ary, DBL2NUM(av[0] * bv[0] + av[1] * bv[1]));
+  }
+  return ary;
+}
+
+VALUE vec2_array_rotate(int argc, VALUE *argv, VALUE self) {
+  VALUE radians = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &radians, &out);
+  double r = value_to_double(radians);
+  Vec2ArrayData *a = vec2_array_get(self);
+  VALUE result = vec2_array_output(self, out, a);
+  Vec2ArrayJob job = {NULL, a->type, a->data, NULL, 0, 0.0, cos(r), sin(r),
+                      vec2_array_get(result)->data, a->length};
+  vec2_array_run(rotate_job, &job, self, Qnil, result);
+  return result;
+}
+
+VALUE vec2_array_lengths(VALUE self) {
+  Vec2ArrayData *a = vec2_array_get(self);
+  VALUE ary = rb_ary_new_capa(a->length);
+  for (long i = 0; i < a->length; i++) {
+    double scratch[2];
+    const double *av = packed_read(a->data, a->type, i, 2, scratch);
+    rb_ary_push(ary, DBL2NUM(sqrt(av[0] * av[0] + av[1] * av[1])));
+  }
+  return ary;
+}
+
+VALUE vec2_array_normalize(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  Vec2ArrayData *a = vec2_array_get(self);
+  VALUE result = vec2_array_output(self, out, a);
+  vec2_array_normalize_into(self, result);
+  return result;
+}
+
+VALUE vec2_array_normalize_bang(VALUE self) {
+  Vec2ArrayData *a = vec2_array_get(self);
+  packed_buffer_check_writable(self, a->buffer);
+  vec2_array_normalize_into(self, self);
+  return self;
+}
+
+VALUE vec2_array_lerp(int argc, VALUE *argv, VALUE self) {
+  VALUE other = Qnil;
+  VALUE t = Qnil;
+  VALUE out = Qnil;
+  Vec2Scratch scratch = {{0}};
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "21", &other, &t, &out);
+  double s = value_to_double(t);
+  Vec2ArrayData *a = vec2_array_get(self);
+  const void *b = vec2_array_operand(other, a, &scratch, &stride);
+  VALUE result = vec2_array_output(self, out, a);
+  Vec2ArrayJob job = {NULL, a->type, a->data, b, stride, s, 0.0, 0.0,
+                      vec2_array_get(result)->data, a->length};
+  vec2_array_run(lerp_job, &job, self, other, result);
+  return result;
+}
+
+VALUE vec2_array_equal(VALUE self, VALUE other) {
+  if (!rb_obj_is_kind_of(other, cVec2Array)) {
+    return Qfalse;
+  }
+  Vec2ArrayData *a = vec2_array_get(self);
+  Vec2ArrayData *b = vec2_array_get(other);
+  if (a->length != b->length) {
+    return Qfalse;
+  }
+  for (long i = 0; i < a->length; i++) {
+    double as[2];
+    double bs[2];
+    const double *av = packed_read(a->data, a->type, i, 2, as);
+    const double *bv = packed_read(b->data, b->type, i, 2, bs);
+    if (av[0] != bv[0] || av[1] != bv[1]) {
+      return Qfalse;
+    }
+  }
+  return Qtrue;
+}
+
+VALUE vec2_array_inspect(VALUE self) {
+  Vec2ArrayData *a = vec2_array_get(self);
+  VALUE str = rb_str_new_cstr("Vec2Array[");
+  for (long i = 0; i < a->length; i++) {
+    if (i > 0) {
+      rb_str_cat_cstr(str, ", ");
+    }
+    rb_str_concat(str, rb_inspect(vec2_array_element(a, i)));
+  }
+  rb_str_cat_cstr(str, "]");
+  return str;
+}
+
+void Init_vec2_array(VALUE module) {
+  cVec2Array = rb_define_class_under(module, "Vec2Array", rb_cObject);
+  rb_define_alloc_func(cVec2Array, vec2_array_alloc);
+  packed_array_define(cVec2Array, &vec2_array_class);
+
+  rb_define_singleton_method(cVec2Array, "from", vec2_array_class_from, -1);
+
+  rb_define_method(cVec2Array, "[]", vec2_array_aref, 1);
+  rb_define_method(cVec2Array, "[]=", vec2_array_aset, 2);
+  rb_define_method(cVec2Array, "each", vec2_array_each, 0);
+  rb_define_method(cVec2Array, "to_a", vec2_array_to_a, 0);
+
+  rb_define_method(cVec2Array, "add", vec2_array_add, -1);
+  rb_define_method(cVec2Array, "sub", vec2_array_sub, -1);
+  rb_define_method(cVec2Array, "scale", vec2_array_scale, -1);
+  rb_define_method(cVec2Array, "dot", vec2_array_dot, 1);
+  rb_define_method(cVec2Array, "rotate", vec2_array_rotate, -1);
+  rb_define_method(cVec2Array, "lengths", vec2_array_lengths, 0);
+  rb_define_method(cVec2Array, "normalize", vec2_array_normalize, -1);
+  rb_define_method(cVec2Array, "normalize!", vec2_array_normalize_bang, 0);
+  rb_define_method(cVec2Array, "lerp", vec2_array_lerp, -1);
+  rb_define_method(cVec2Array, "==", vec2_array_equal, 1);
+  rb_define_method(cVec2Array, "inspect", vec2_array_inspect, 0);
+  rb_define_alias(cVec2Array, "to_s", "inspect");
+}
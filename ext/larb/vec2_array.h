@@ -0,0 +1,30 @@
+#ifndef VEC2_ARRAY_H
+#define VEC2_ARRAY_H
+
+#include "larb.h"
+#include "packed_buffer.h"
+
+typedef PackedArray Vec2ArrayData;
+
+void Init_vec2_array(VALUE module);
+VALUE vec2_array_alloc(VALUE klass);
+Vec2ArrayData *vec2_array_get(VALUE obj);
+VALUE vec2_array_build(VALUE klass, long length, PackedType type);
+
+VALUE vec2_array_aref(VALUE self, VALUE index);
+VALUE vec2_array_aset(VALUE self, VALUE index, VALUE value);
+VALUE vec2_array_each(VALUE self);
+VALUE vec2_array_to_a(VALUE self);
+VALUE vec2_array_add(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_sub(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_scale(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_dot(VALUE self, VALUE other);
+VALUE vec2_array_rotate(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_lengths(VALUE self);
+VALUE vec2_array_normalize(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_normalize_bang(VALUE self);
+VALUE vec2_array_lerp(int argc, VALUE *argv, VALUE self);
+VALUE vec2_array_equal(VALUE self, VALUE other);
+VALUE vec2_array_inspect(VALUE self);
+
+#endif
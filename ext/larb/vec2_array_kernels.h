@@ -0,0 +1,65 @@
+static void KERNEL(add)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 2;
+    ov[0] = av[0] + bv[0];
+    ov[1] = av[1] + bv[1];
+  }
+}
+
+static void KERNEL(sub)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 2;
+    ov[0] = av[0] - bv[0];
+    ov[1] = av[1] - bv[1];
+  }
+}
+
+static void KERNEL(mul)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 2;
+    ov[0] = av[0] * bv[0];
+    ov[1] = av[1] * bv[1];
+  }
+}
+
+static void KERNEL(rotate)(const SCALAR *a, SCALAR c, SCALAR s, SCALAR *out,
+                           long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    SCALAR *ov = out + i * 2;
+    SCALAR x = av[0] * c - av[1] * s;
+    SCALAR y = av[0] * s + av[1] * c;
+    ov[0] = x;
+    ov[1] = y;
+  }
+}
+
+static void KERNEL(lerp)(const SCALAR *a, const SCALAR *b, long b_stride,
+                         SCALAR t, SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 2;
+    ov[0] = av[0] + (bv[0] - av[0]) * t;
+    ov[1] = av[1] + (bv[1] - av[1]) * t;
+  }
+}
+
+static void KERNEL(normalize)(const SCALAR *a, SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 2;
+    SCALAR *ov = out + i * 2;
+    SCALAR len = SQRT(av[0] * av[0] + av[1] * av[1]);
+    ov[0] = av[0] / len;
+    ov[1] = av[1] / len;
+  }
+}
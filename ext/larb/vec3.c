@@ -2,36 +2,39 @@
 
 #include <math.h>
 
-static void vec3_free(void *ptr) {
-  xfree(ptr);
-}
+#include "vec2.h"
+#include "vec4.h"
 
 static size_t vec3_memsize(const void *ptr) {
-  return sizeof(Vec3Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Vec3Data);
 }
 
 static const rb_data_type_t vec3_type = {
     "Vec3",
-    {0, vec3_free, vec3_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, vec3_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cVec3 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
-
-static Vec3Data *vec3_get(VALUE obj) {
+VALUE cVec3 = Qnil;
+static VALUE vec3_const_zero = Qnil;
+static VALUE vec3_const_one = Qnil;
+static VALUE vec3_const_up = Qnil;
+static VALUE vec3_const_down = Qnil;
+static VALUE vec3_const_forward = Qnil;
+static VALUE vec3_const_back = Qnil;
+static VALUE vec3_const_right = Qnil;
+static VALUE vec3_const_left = Qnil;
+
+Vec3Data *vec3_get(VALUE obj) {
   Vec3Data *data = NULL;
   TypedData_Get_Struct(obj, Vec3Data, &vec3_type, data);
   return data;
 }
 
-static VALUE vec3_build(VALUE klass, double x, double y, double z) {
+VALUE vec3_build(VALUE klass, double x, double y, double z) {
   VALUE obj = vec3_alloc(klass);
   Vec3Data *data = vec3_get(obj);
   data->x = x;
@@ -51,14 +54,16 @@ static double clamp_double(double value, double min, double max) {
 }
 
 VALUE vec3_alloc(VALUE klass) {
-  Vec3Data *data = ALLOC(Vec3Data);
+  Vec3Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Vec3Data, &vec3_type, data);
   data->x = 0.0;
   data->y = 0.0;
   data->z = 0.0;
-  return TypedData_Wrap_Struct(klass, &vec3_type, data);
+  return obj;
 }
 
 VALUE vec3_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE vx = Qnil;
   VALUE vy = Qnil;
   VALUE vz = Qnil;
@@ -72,41 +77,56 @@ VALUE vec3_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE vec3_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *vec3_get(self) = *vec3_get(other);
+  return self;
+}
+
 static VALUE vec3_class_bracket(VALUE klass, VALUE x, VALUE y, VALUE z) {
   return vec3_build(klass, value_to_double(x), value_to_double(y),
                     value_to_double(z));
 }
 
+static VALUE vec3_constant(VALUE klass, VALUE constant) {
+  if (klass == cVec3) {
+    return constant;
+  }
+  VALUE obj = vec3_alloc(klass);
+  *vec3_get(obj) = *vec3_get(constant);
+  return obj;
+}
+
 static VALUE vec3_class_zero(VALUE klass) {
-  return vec3_build(klass, 0.0, 0.0, 0.0);
+  return vec3_constant(klass, vec3_const_zero);
 }
 
 static VALUE vec3_class_one(VALUE klass) {
-  return vec3_build(klass, 1.0, 1.0, 1.0);
+  return vec3_constant(klass, vec3_const_one);
 }
 
 static VALUE vec3_class_up(VALUE klass) {
-  return vec3_build(klass, 0.0, 1.0, 0.0);
+  return vec3_constant(klass, vec3_const_up);
 }
 
 static VALUE vec3_class_down(VALUE klass) {
-  return vec3_build(klass, 0.0, -1.0, 0.0);
+  return vec3_constant(klass, vec3_const_down);
 }
 
 static VALUE vec3_class_forward(VALUE klass) {
-  return vec3_build(klass, 0.0, 0.0, -1.0);
+  return vec3_constant(klass, vec3_const_forward);
 }
 
 static VALUE vec3_class_back(VALUE klass) {
-  return vec3_build(klass, 0.0, 0.0, 1.0);
+  return vec3_constant(klass, vec3_const_back);
 }
 
 static VALUE vec3_class_right(VALUE klass) {
-  return vec3_build(klass, 1.0, 0.0, 0.0);
+  return vec3_constant(klass, vec3_const_right);
 }
 
 static VALUE vec3_class_left(VALUE klass) {
-  return vec3_build(klass, -1.0, 0.0, 0.0);
+  return vec3_constant(klass, vec3_const_left);
 }
 
 static VALUE vec3_get_x(VALUE self) {
@@ -115,6 +135,7 @@ static VALUE vec3_get_x(VALUE self) {
 }
 
 static VALUE vec3_set_x(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec3Data *data = vec3_get(self);
   data->x = value_to_double(value);
   return value;
@@ -126,6 +147,7 @@ static VALUE vec3_get_y(VALUE self) {
 }
 
 static VALUE vec3_set_y(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec3Data *data = vec3_get(self);
   data->y = value_to_double(value);
   return value;
@@ -137,6 +159,7 @@ static VALUE vec3_get_z(VALUE self) {
 }
 
 static VALUE vec3_set_z(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec3Data *data = vec3_get(self);
   data->z = value_to_double(value);
   return value;
@@ -220,23 +243,17 @@ VALUE vec3_reflect(VALUE self, VALUE normal) {
 
 VALUE vec3_xy(VALUE self) {
   Vec3Data *a = vec3_get(self);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(a->x),
-                    DBL2NUM(a->y));
+  return vec2_build(cVec2, a->x, a->y);
 }
 
 VALUE vec3_xz(VALUE self) {
   Vec3Data *a = vec3_get(self);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(a->x),
-                    DBL2NUM(a->z));
+  return vec2_build(cVec2, a->x, a->z);
 }
 
 VALUE vec3_yz(VALUE self) {
   Vec3Data *a = vec3_get(self);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(a->y),
-                    DBL2NUM(a->z));
+  return vec2_build(cVec2, a->y, a->z);
 }
 
 VALUE vec3_lerp(VALUE self, VALUE other, VALUE t) {
@@ -262,10 +279,8 @@ VALUE vec3_to_vec4(int argc, VALUE *argv, VALUE self) {
   Vec3Data *a = vec3_get(self);
 
   rb_scan_args(argc, argv, "01", &vw);
-  VALUE vec4_class = rb_const_get(mLarb, rb_intern("Vec4"));
-  return rb_funcall(vec4_class, rb_intern("new"), 4, DBL2NUM(a->x),
-                    DBL2NUM(a->y), DBL2NUM(a->z),
-                    NIL_P(vw) ? DBL2NUM(1.0) : vw);
+  return vec4_build(cVec4, a->x, a->y, a->z,
+                    NIL_P(vw) ? 1.0 : value_to_double(vw));
 }
 
 VALUE vec3_aref(VALUE self, VALUE index) {
@@ -383,6 +398,7 @@ VALUE vec3_clamp_length(VALUE self, VALUE max_length) {
 }
 
 VALUE vec3_normalize_bang(VALUE self) {
+  rb_check_frozen(self);
   Vec3Data *a = vec3_get(self);
   double len = sqrt(a->x * a->x + a->y * a->y + a->z * a->z);
   a->x /= len;
@@ -405,6 +421,98 @@ VALUE vec3_max(VALUE self, VALUE other) {
                     fmax(a->z, b->z));
 }
 
+VALUE vec3_add_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  a->x += b->x;
+  a->y += b->y;
+  a->z += b->z;
+  return self;
+}
+
+VALUE vec3_sub_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  a->x -= b->x;
+  a->y -= b->y;
+  a->z -= b->z;
+  return self;
+}
+
+VALUE vec3_mul_bang(VALUE self, VALUE scalar) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+
+  if (rb_obj_is_kind_of(scalar, cVec3)) {
+    Vec3Data *b = vec3_get(scalar);
+    a->x *= b->x;
+    a->y *= b->y;
+    a->z *= b->z;
+    return self;
+  }
+
+  double s = value_to_double(scalar);
+  a->x *= s;
+  a->y *= s;
+  a->z *= s;
+  return self;
+}
+
+VALUE vec3_negate_bang(VALUE self) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  a->x = -a->x;
+  a->y = -a->y;
+  a->z = -a->z;
+  return self;
+}
+
+VALUE vec3_cross_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  double x = a->y * b->z - a->z * b->y;
+  double y = a->z * b->x - a->x * b->z;
+  double z = a->x * b->y - a->y * b->x;
+  a->x = x;
+  a->y = y;
+  a->z = z;
+  return self;
+}
+
+VALUE vec3_lerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  double s = value_to_double(t);
+  a->x += (b->x - a->x) * s;
+  a->y += (b->y - a->y) * s;
+  a->z += (b->z - a->z) * s;
+  return self;
+}
+
+VALUE vec3_min_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  a->x = fmin(a->x, b->x);
+  a->y = fmin(a->y, b->y);
+  a->z = fmin(a->z, b->z);
+  return self;
+}
+
+VALUE vec3_max_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec3Data *a = vec3_get(self);
+  Vec3Data *b = vec3_get(other);
+  a->x = fmax(a->x, b->x);
+  a->y = fmax(a->y, b->y);
+  a->z = fmax(a->z, b->z);
+  return self;
+}
+
 VALUE vec3_abs(VALUE self) {
   Vec3Data *a = vec3_get(self);
   return vec3_build(rb_obj_class(self), fabs(a->x), fabs(a->y), fabs(a->z));
@@ -445,6 +553,7 @@ void Init_vec3(VALUE module) {
 
   rb_define_alloc_func(cVec3, vec3_alloc);
   rb_define_method(cVec3, "initialize", vec3_initialize, -1);
+  rb_define_method(cVec3, "initialize_copy", vec3_initialize_copy, 1);
 
   rb_define_singleton_method(cVec3, "[]", vec3_class_bracket, 3);
   rb_define_singleton_method(cVec3, "zero", vec3_class_zero, 0);
@@ -494,10 +603,36 @@ void Init_vec3(VALUE module) {
   rb_define_method(cVec3, "normalize!", vec3_normalize_bang, 0);
   rb_define_method(cVec3, "min", vec3_min, 1);
   rb_define_method(cVec3, "max", vec3_max, 1);
+  rb_define_method(cVec3, "add!", vec3_add_bang, 1);
+  rb_define_method(cVec3, "sub!", vec3_sub_bang, 1);
+  rb_define_method(cVec3, "mul!", vec3_mul_bang, 1);
+  rb_define_alias(cVec3, "scale!", "mul!");
+  rb_define_method(cVec3, "negate!", vec3_negate_bang, 0);
+  rb_define_method(cVec3, "cross!", vec3_cross_bang, 1);
+  rb_define_method(cVec3, "lerp!", vec3_lerp_bang, 2);
+  rb_define_method(cVec3, "min!", vec3_min_bang, 1);
+  rb_define_method(cVec3, "max!", vec3_max_bang, 1);
   rb_define_method(cVec3, "abs", vec3_abs, 0);
   rb_define_method(cVec3, "floor", vec3_floor, 0);
   rb_define_method(cVec3, "ceil", vec3_ceil, 0);
   rb_define_method(cVec3, "round", vec3_round, 0);
   rb_define_method(cVec3, "inspect", vec3_inspect, 0);
   rb_define_alias(cVec3, "to_s", "inspect");
+
+  larb_define_constant(cVec3, "ZERO", &vec3_const_zero,
+                       vec3_build(cVec3, 0.0, 0.0, 0.0));
+  larb_define_constant(cVec3, "ONE", &vec3_const_one,
+                       vec3_build(cVec3, 1.0, 1.0, 1.0));
+  larb_define_constant(cVec3, "UP", &vec3_const_up,
+                       vec3_build(cVec3, 0.0, 1.0, 0.0));
+  larb_define_constant(cVec3, "DOWN", &vec3_const_down,
+                       vec3_build(cVec3, 0.0, -1.0, 0.0));
+  larb_define_constant(cVec3, "FORWARD", &vec3_const_forward,
+                       vec3_build(cVec3, 0.0, 0.0, -1.0));
+  larb_define_constant(cVec3, "BACK", &vec3_const_back,
+                       vec3_build(cVec3, 0.0, 0.0, 1.0));
+  larb_define_constant(cVec3, "RIGHT", &vec3_const_right,
+                       vec3_build(cVec3, 1.0, 0.0, 0.0));
+  larb_define_constant(cVec3, "LEFT", &vec3_const_left,
+                       vec3_build(cVec3, -1.0, 0.0, 0.0));
 }
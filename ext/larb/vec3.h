@@ -9,9 +9,13 @@ typedef struct {
   double z;
 } Vec3Data;
 
+extern VALUE cVec3;
+
 void Init_vec3(VALUE module);
 VALUE vec3_alloc(VALUE klass);
 VALUE vec3_initialize(int argc, VALUE *argv, VALUE self);
+Vec3Data *vec3_get(VALUE obj);
+VALUE vec3_build(VALUE klass, double x, double y, double z);
 
 VALUE vec3_add(VALUE self, VALUE other);
 VALUE vec3_sub(VALUE self, VALUE other);
@@ -43,6 +47,14 @@ VALUE vec3_clamp_length(VALUE self, VALUE max_length);
 VALUE vec3_normalize_bang(VALUE self);
 VALUE vec3_min(VALUE self, VALUE other);
 VALUE vec3_max(VALUE self, VALUE other);
+VALUE vec3_add_bang(VALUE self, VALUE other);
+VALUE vec3_sub_bang(VALUE self, VALUE other);
+VALUE vec3_mul_bang(VALUE self, VALUE scalar);
+VALUE vec3_negate_bang(VALUE self);
+VALUE vec3_cross_bang(VALUE self, VALUE other);
+VALUE vec3_lerp_bang(VALUE self, VALUE other, VALUE t);
+VALUE vec3_min_bang(VALUE self, VALUE other);
+VALUE vec3_max_bang(VALUE self, VALUE other);
 VALUE vec3_abs(VALUE self);
 VALUE vec3_floor(VALUE self);
 VALUE vec3_ceil(VALUE self);
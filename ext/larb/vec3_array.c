@@ -0,0 +1,425 @@
+#include "vec3_array.h"
+
+#include <math.h>
+
+#include "packed_buffer.h"
+#include "simd.h"
+#include "vec3.h"
+
+#define SIMD_KERNELS_HEADER "vec3_array_kernels.h"
+#include "simd_kernels.h"
+#undef SIMD_KERNELS_HEADER
+
+static const PackedArrayClass vec3_array_class;
+
+static const rb_data_type_t vec3_array_type = {
+    "Vec3Array",
+    {packed_array_mark, RUBY_TYPED_DEFAULT_FREE, packed_array_memsize},
+    0,
+    (void *)&vec3_array_class,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
+};
+
+static const PackedArrayClass vec3_array_class = {
+    &vec3_array_type,
+    3,
+    true,
+    PACKED_FLOAT64,
+    NULL,
+    {{"d", 8, 24, 1, {3}, {8}}, {"f", 4, 12, 1, {3}, {4}}},
+};
+
+static VALUE cVec3Array = Qnil;
+
+typedef union {
+  double f64[3];
+  float f32[3];
+} Vec3Scratch;
+
+typedef struct {
+  void (*f64)(const double *, const double *, long, double *, long);
+  void (*f32)(const float *, const float *, long, float *, long);
+} Vec3ArrayKernel;
+
+static const Vec3ArrayKernel add_kernel[SIMD_LEVELS] = SIMD_KERNELS(add);
+static const Vec3ArrayKernel sub_kernel[SIMD_LEVELS] = SIMD_KERNELS(sub);
+static const Vec3ArrayKernel mul_kernel[SIMD_LEVELS] = SIMD_KERNELS(mul);
+static const Vec3ArrayKernel cross_kernel[SIMD_LEVELS] = SIMD_KERNELS(cross);
+
+static size_t element_size(PackedType type) {
+  return packed_array_element_size(&vec3_array_class, type);
+}
+
+Vec3ArrayData *vec3_array_get(VALUE obj) {
+  return packed_array_get(obj, &vec3_array_class);
+}
+
+VALUE vec3_array_build(VALUE klass, long length, PackedType type) {
+  return packed_array_build(klass, &vec3_array_class, length, type);
+}
+
+static void read_vec3(VALUE vec, double *out) {
+  Vec3Data *v = vec3_get(vec);
+  out[0] = v->x;
+  out[1] = v->y;
+  out[2] = v->z;
+}
+
+static VALUE vec3_new(const double *v) {
+  return vec3_build(cVec3, v[0], v[1], v[2]);
+}
+
+static VALUE vec3_array_element(Vec3ArrayData *data, long index) {
+  double scratch[3];
+  return vec3_new(packed_read(data->data, data->type, index, 3, scratch));
+}
+
+static const void *vec3_array_operand(VALUE other, Vec3ArrayData *a,
+                                      Vec3Scratch *scratch, long *stride) {
+  if (rb_obj_is_kind_of(other, cVec3Array)) {
+    Vec3ArrayData *b = vec3_array_get(other);
+    packed_check_length(a->length, b->length);
+    packed_type_check(a->type, b->type);
+    *stride = 3;
+    return b->data;
+  }
+  if (rb_obj_is_kind_of(other, cVec3)) {
+    double v[3];
+    read_vec3(other, v);
+    packed_write(scratch, a->type, 0, 3, v);
+    *stride = 0;
+    return scratch;
+  }
+  rb_raise(rb_eTypeError, "expected Vec3Array or Vec3");
+  return NULL;
+}
+
+static VALUE vec3_array_output(VALUE self, VALUE out, Vec3ArrayData *a) {
+  if (NIL_P(out)) {
+    return vec3_array_build(rb_obj_class(self), a->length, a->type);
+  }
+  if (!rb_obj_is_kind_of(out, cVec3Array)) {
+    rb_raise(rb_eTypeError, "expected Vec3Array for output");
+  }
+  Vec3ArrayData *data = vec3_array_get(out);
+  packed_check_length(a->length, data->length);
+  packed_type_check(a->type, data->type);
+  packed_buffer_check_writable(out, data->buffer);
+  return out;
+}
+
+typedef struct {
+  const Vec3ArrayKernel *kernel;
+  PackedType type;
+  const void *a;
+  const void *b;
+  long stride;
+  double t;
+  void *out;
+  long length;
+} Vec3ArrayJob;
+
+static void binary_job(void *ptr, long begin, long end) {
+  Vec3ArrayJob *job = ptr;
+  long b = begin * job->stride;
+  if (job->type == PACKED_FLOAT32) {
+    job->kernel[simd_level].f32((const float *)job->a + begin * 3,
+                                (const float *)job->b + b, job->stride,
+                                (float *)job->out + begin * 3, end - begin);
+  } else {
+    job->kernel[simd_level].f64((const double *)job->a + begin * 3,
+                                (const double *)job->b + b, job->stride,
+                                (double *)job->out + begin * 3, end - begin);
+  }
+}
+
+static void normalize_job(void *ptr, long begin, long end) {
+  Vec3ArrayJob *job = ptr;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(normalize_kernel_f32)
+    ((const float *)job->a + begin * 3, (float *)job->out + begin * 3,
+     end - begin);
+  } else {
+    SIMD_SELECT(normalize_kernel_f64)
+    ((const double *)job->a + begin * 3, (double *)job->out + begin * 3,
+     end - begin);
+  }
+}
+
+static void lerp_job(void *ptr, long begin, long end) {
+  Vec3ArrayJob *job = ptr;
+  long b = begin * job->stride;
+  if (job->type == PACKED_FLOAT32) {
+    SIMD_SELECT(lerp_kernel_f32)
+    ((const float *)job->a + begin * 3, (const float *)job->b + b,
+     job->stride, (float)job->t, (float *)job->out + begin * 3, end - begin);
+  } else {
+    SIMD_SELECT(lerp_kernel_f64)
+    ((const double *)job->a + begin * 3, (const double *)job->b + b,
+     job->stride, job->t, (double *)job->out + begin * 3, end - begin);
+  }
+}
+
+static PackedPin vec3_array_pin(VALUE obj) {
+  if (!rb_obj_is_kind_of(obj, cVec3Array)) {
+    return packed_pin(Qnil, Qnil, NULL);
+  }
+  Vec3ArrayData *data = vec3_array_get(obj);
+  return packed_pin(obj, data->buffer, &data->locks);
+}
+
+static void vec3_array_run(PackedJob run, Vec3ArrayJob *job, VALUE self,
+                           VALUE other, VALUE result) {
+  size_t size = (size_t)job->length * element_size(job->type);
+  packed_check_overlap(job->a, size, job->out, size);
+  packed_check_overlap(job->b, job->stride ? size : 0, job->out, size);
+  PackedPin pins[3] = {vec3_array_pin(self), vec3_array_pin(other),
+                       vec3_array_pin(result)};
+  packed_run(job->length, run, job, pins, 3);
+}
+
+static VALUE vec3_array_binary(int argc, VALUE *argv, VALUE self,
+                               const Vec3ArrayKernel *kernel) {
+  VALUE other = Qnil;
+  VALUE out = Qnil;
+  Vec3Scratch scratch = {{0}};
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "11", &other, &out);
+  Vec3ArrayData *a = vec3_array_get(self);
+  const void *b = vec3_array_operand(other, a, &scratch, &stride);
+  VALUE result = vec3_array_output(self, out, a);
+  Vec3ArrayJob job = {kernel, a->type, a->data, b, stride, 0.0,
+                      vec3_array_get(result)->data, a->length};
+  vec3_array_run(binary_job, &job, self, other, result);
+  return result;
+}
+
+static void vec3_array_normalize_into(VALUE self, VALUE result) {
+  Vec3ArrayData *a = vec3_array_get(self);
+  Vec3ArrayJob job = {NULL, a->type, a->data, NULL, 0, 0.0,
+                      vec3_array_get(result)->data, a->length};
+  vec3_array_run(normalize_job, &job, self, Qnil, result);
+}
+
+VALUE vec3_array_alloc(VALUE klass) {
+  return packed_array_alloc(klass, &vec3_array_class);
+}
+
+static VALUE vec3_array_class_from(int argc, VALUE *argv, VALUE klass) {
+  VALUE points = Qnil;
+  VALUE opts = Qnil;
+
+  rb_scan_args(argc, argv, "1:", &points, &opts);
+  VALUE ary = rb_check_array_type(points);
+  if (NIL_P(ary)) {
+    rb_raise(rb_eTypeError, "expected Array");
+  }
+
+  long length = RARRAY_LEN(ary);
+  VALUE obj = vec3_array_build(klass, length, packed_type_option(opts));
+  Vec3ArrayData *data = vec3_array_get(obj);
+  for (long i = 0; i < length; i++) {
+    double v[3];
+    read_vec3(rb_ary_entry(ary, i), v);
+    packed_write(data->data, data->type, i, 3, v);
+  }
+  return obj;
+}
+
+VALUE vec3_array_aref(VALUE self, VALUE index) {
+  Vec3ArrayData *data = vec3_array_get(self);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    return Qnil;
+  }
+  return vec3_array_element(data, idx);
+}
+
+VALUE vec3_array_aset(VALUE self, VALUE index, VALUE value) {
+  Vec3ArrayData *data = vec3_array_get(self);
+  packed_buffer_check_writable(self, data->buffer);
+  long idx = packed_array_index(data, index);
+  if (idx < 0 || idx >= data->length) {
+    rb_raise(rb_eIndexError, "index %ld out of range", NUM2LONG(index));
+  }
+  double v[3];
+  read_vec3(value, v);
+  packed_write(data->data, data->type, idx, 3, v);
+  return value;
+}
+
+VALUE vec3_array_each(VALUE self) {
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, packed_array_length);
+  for (long i = 0; i < vec3_array_get(self)->length; i++) {
+    rb_yield(vec3_array_element(vec3_array_get(self), i));
+  }
+  return self;
+}
+
+VALUE vec3_array_to_a(VALUE self) {
+  Vec3ArrayData *data = vec3_array_get(self);
+  VALUE ary = rb_ary_new_capa(data->length);
+  for (long i = 0; i < data->length; i++) {
+    rb_ary_push(ary, vec3_array_element(data, i));
+  }
+  return ary;
+}
+
+VALUE vec3_array_add(int argc, VALUE *argv, VALUE self) {
+  return vec3_array_binary(argc, argv, self, add_kernel);
+}
+
+VALUE vec3_array_sub(int argc, VALUE *argv, VALUE self) {
+  return vec3_array_binary(argc, argv, self, sub_kernel);
+}
+
+VALUE vec3_array_scale(int argc, VALUE *argv, VALUE self) {
+  VALUE scalar = Qnil;
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "11", &scalar, &out);
+  if (!rb_obj_is_kind_of(scalar, rb_cNumeric)) {
+    return vec3_array_binary(argc, argv, self, mul_kernel);
+  }
+
+  double s = value_to_double(scalar);
+  double factor[3] = {s, s, s};
+  Vec3Scratch scratch = {{0}};
+  Vec3ArrayData *a = vec3_array_get(self);
+  packed_write(&scratch, a->type, 0, 3, factor);
+  VALUE result = vec3_array_output(self, out, a);
+  Vec3ArrayJob job = {mul_kernel, a->type, a->data, &scratch, 0, 0.0,
+                      vec3_array_get(result)->data, a->length};
+  vec3_array_run(binary_job, &job, self, Qnil, result);
+  return result;
+}
+
+VALUE vec3_array_dot(VALUE self, VALUE other) {
+  Vec3Scratch scratch = {{0}};
+  long stride = 0;
+  Vec3ArrayData *a = vec3_array_get(self);
+  const void *b = vec3_array_operand(other, a, &scratch, &stride);
+
+  VALUE ary = rb_ary_new_capa(a->length);
+  for (long i = 0; i < a->length; i++) {
+    double as[3];
+    double bs[3];
+    const double *av = packed_read(a->data, a->type, i, 3, as);
+    const double *bv = packed_read(b, a->type, stride ? i : 0, 3, bs);
+    rb_ary_push(ary, DBL2NUM(av[0] * bv[0] + av[1] * bv[1] + av[2] * bv[2]));
+  }
+  return ary;
+}
+
+VALUE vec3_array_cross(int argc, VALUE *argv, VALUE self) {
+  return vec3_array_binary(argc, argv, self, cross_kernel);
+}
+
+VALUE vec3_array_lengths(VALUE self) {
+  Vec3ArrayData *a = vec3_array_get(self);
+  VALUE ary = rb_ary_new_capa(a->length);
+  for (long i = 0; i < a->length; i++) {
+    double scratch[3];
+    const double *av = packed_read(a->data, a->type, i, 3, scratch);
+    rb_ary_push(ary, DBL2NUM(sqrt(av[0] * av[0] + av[1] * av[1] +
+                                  av[2] * av[2])));
+  }
+  return ary;
+}
+
+VALUE vec3_array_normalize(int argc, VALUE *argv, VALUE self) {
+  VALUE out = Qnil;
+
+  rb_scan_args(argc, argv, "01", &out);
+  Vec3ArrayData *a = vec3_array_get(self);
+  VALUE result = vec3_array_output(self, out, a);
+  vec3_array_normalize_into(self, result);
+  return result;
+}
+
+VALUE vec3_array_normalize_bang(VALUE self) {
+  Vec3ArrayData *a = vec3_array_get(self);
+  packed_buffer_check_writable(self, a->buffer);
+  vec3_array_normalize_into(self, self);
+  return self;
+}
+
+VALUE vec3_array_lerp(int argc, VALUE *argv, VALUE self) {
+  VALUE other = Qnil;
+  VALUE t = Qnil;
+  VALUE out = Qnil;
+  Vec3Scratch scratch = {{0}};
+  long stride = 0;
+
+  rb_scan_args(argc, argv, "21", &other, &t, &out);
+  double s = value_to_double(t);
+  Vec3ArrayData *a = vec3_array_get(self);
+  const void *b = vec3_array_operand(other, a, &scratch, &stride);
+  VALUE result = vec3_array_output(self, out, a);
+  Vec3ArrayJob job = {NULL, a->type, a->data, b, stride, s,
+                      vec3_array_get(result)->data, a->length};
+  vec3_array_run(lerp_job, &job, self, other, result);
+  return result;
+}
+
+VALUE vec3_array_equal(VALUE self, VALUE other) {
+  if (!rb_obj_is_kind_of(other, cVec3Array)) {
+    return Qfalse;
+  }
+  Vec3ArrayData *a = vec3_array_get(self);
+  Vec3ArrayData *b = vec3_array_get(other);
+  if (a->length != b->length) {
+    return Qfalse;
+  }
+  for (long i = 0; i < a->length; i++) {
+    double as[3];
+    double bs[3];
+    const double *av = packed_read(a->data, a->type, i, 3, as);
+    const double *bv = packed_read(b->data, b->type, i, 3, bs);
+    if (av[0] != bv[0] || av[1] != bv[1] || av[2] != bv[2]) {
+      return Qfalse;
+    }
+  }
+  return Qtrue;
+}
+
+VALUE vec3_array_inspect(VALUE self) {
+  Vec3ArrayData *a = vec3_array_get(self);
+  VALUE str = rb_str_new_cstr("Vec3Array[");
+  for (long i = 0; i < a->length; i++) {
+    if (i > 0) {
+      rb_str_cat_cstr(str, ", ");
+    }
+    rb_str_concat(str, rb_inspect(vec3_array_element(a, i)));
+  }
+  rb_str_cat_cstr(str, "]");
+  return str;
+}
+
+void Init_vec3_array(VALUE module) {
+  cVec3Array = rb_define_class_under(module, "Vec3Array", rb_cObject);
+  rb_define_alloc_func(cVec3Array, vec3_array_alloc);
+  packed_array_define(cVec3Array, &vec3_array_class);
+
+  rb_define_singleton_method(cVec3Array, "from", vec3_array_class_from, -1);
+
+  rb_define_method(cVec3Array, "[]", vec3_array_aref, 1);
+  rb_define_method(cVec3Array, "[]=", vec3_array_aset, 2);
+  rb_define_method(cVec3Array, "each", vec3_array_each, 0);
+  rb_define_method(cVec3Array, "to_a", vec3_array_to_a, 0);
+
+  rb_define_method(cVec3Array, "add", vec3_array_add, -1);
+  rb_define_method(cVec3Array, "sub", vec3_array_sub, -1);
+  rb_define_method(cVec3Array, "scale", vec3_array_scale, -1);
+  rb_define_method(cVec3Array, "dot", vec3_array_dot, 1);
+  rb_define_method(cVec3Array, "cross", vec3_array_cross, -1);
+  rb_define_method(cVec3Array, "lengths", vec3_array_lengths, 0);
+  rb_define_method(cVec3Array, "normalize", vec3_array_normalize, -1);
+  rb_define_method(cVec3Array, "normalize!", vec3_array_normalize_bang, 0);
+  rb_define_method(cVec3Array, "lerp", vec3_array_lerp, -1);
+  rb_define_method(cVec3Array, "==", vec3_array_equal, 1);
+  rb_define_method(cVec3Array, "inspect", vec3_array_inspect, 0);
+  rb_define_alias(cVec3Array, "to_s", "inspect");
+}
@@ -0,0 +1,30 @@
+#ifndef VEC3_ARRAY_H
+#define VEC3_ARRAY_H
+
+#include "larb.h"
+#include "packed_buffer.h"
+
+typedef PackedArray Vec3ArrayData;
+
+void Init_vec3_array(VALUE module);
+VALUE vec3_array_alloc(VALUE klass);
+Vec3ArrayData *vec3_array_get(VALUE obj);
+VALUE vec3_array_build(VALUE klass, long length, PackedType type);
+
+VALUE vec3_array_aref(VALUE self, VALUE index);
+VALUE vec3_array_aset(VALUE self, VALUE index, VALUE value);
+VALUE vec3_array_each(VALUE self);
+VALUE vec3_array_to_a(VALUE self);
+VALUE vec3_array_add(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_sub(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_scale(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_dot(VALUE self, VALUE other);
+VALUE vec3_array_cross(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_lengths(VALUE self);
+VALUE vec3_array_normalize(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_normalize_bang(VALUE self);
+VALUE vec3_array_lerp(int argc, VALUE *argv, VALUE self);
+VALUE vec3_array_equal(VALUE self, VALUE other);
+VALUE vec3_array_inspect(VALUE self);
+
+#endif
@@ -0,0 +1,73 @@
+static void KERNEL(add)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 3;
+    ov[0] = av[0] + bv[0];
+    ov[1] = av[1] + bv[1];
+    ov[2] = av[2] + bv[2];
+  }
+}
+
+static void KERNEL(sub)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 3;
+    ov[0] = av[0] - bv[0];
+    ov[1] = av[1] - bv[1];
+    ov[2] = av[2] - bv[2];
+  }
+}
+
+static void KERNEL(mul)(const SCALAR *a, const SCALAR *b, long b_stride,
+                        SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 3;
+    ov[0] = av[0] * bv[0];
+    ov[1] = av[1] * bv[1];
+    ov[2] = av[2] * bv[2];
+  }
+}
+
+static void KERNEL(cross)(const SCALAR *a, const SCALAR *b, long b_stride,
+                          SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 3;
+    SCALAR x = av[1] * bv[2] - av[2] * bv[1];
+    SCALAR y = av[2] * bv[0] - av[0] * bv[2];
+    SCALAR z = av[0] * bv[1] - av[1] * bv[0];
+    ov[0] = x;
+    ov[1] = y;
+    ov[2] = z;
+  }
+}
+
+static void KERNEL(lerp)(const SCALAR *a, const SCALAR *b, long b_stride,
+                         SCALAR t, SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    const SCALAR *bv = b + i * b_stride;
+    SCALAR *ov = out + i * 3;
+    ov[0] = av[0] + (bv[0] - av[0]) * t;
+    ov[1] = av[1] + (bv[1] - av[1]) * t;
+    ov[2] = av[2] + (bv[2] - av[2]) * t;
+  }
+}
+
+static void KERNEL(normalize)(const SCALAR *a, SCALAR *out, long n) {
+  for (long i = 0; i < n; i++) {
+    const SCALAR *av = a + i * 3;
+    SCALAR *ov = out + i * 3;
+    SCALAR len = SQRT(av[0] * av[0] + av[1] * av[1] + av[2] * av[2]);
+    ov[0] = av[0] / len;
+    ov[1] = av[1] / len;
+    ov[2] = av[2] / len;
+  }
+}
@@ -2,36 +2,33 @@
 
 #include <math.h>
 
-static void vec4_free(void *ptr) {
-  xfree(ptr);
-}
+#include "vec2.h"
+#include "vec3.h"
 
 static size_t vec4_memsize(const void *ptr) {
-  return sizeof(Vec4Data);
+  return LARB_TYPED_EMBEDDABLE ? 0 : sizeof(Vec4Data);
 }
 
 static const rb_data_type_t vec4_type = {
     "Vec4",
-    {0, vec4_free, vec4_memsize},
+    {0, RUBY_TYPED_DEFAULT_FREE, vec4_memsize},
     0,
     0,
-    RUBY_TYPED_FREE_IMMEDIATELY,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED |
+        RUBY_TYPED_FROZEN_SHAREABLE | LARB_TYPED_EMBEDDABLE,
 };
 
-static VALUE cVec4 = Qnil;
-
-static double value_to_double(VALUE value) {
-  VALUE coerced = rb_funcall(value, rb_intern("to_f"), 0);
-  return NUM2DBL(coerced);
-}
+VALUE cVec4 = Qnil;
+static VALUE vec4_const_zero = Qnil;
+static VALUE vec4_const_one = Qnil;
 
-static Vec4Data *vec4_get(VALUE obj) {
+Vec4Data *vec4_get(VALUE obj) {
   Vec4Data *data = NULL;
   TypedData_Get_Struct(obj, Vec4Data, &vec4_type, data);
   return data;
 }
 
-static VALUE vec4_build(VALUE klass, double x, double y, double z, double w) {
+VALUE vec4_build(VALUE klass, double x, double y, double z, double w) {
   VALUE obj = vec4_alloc(klass);
   Vec4Data *data = vec4_get(obj);
   data->x = x;
@@ -42,15 +39,17 @@ static VALUE vec4_build(VALUE klass, double x, double y, double z, double w) {
 }
 
 VALUE vec4_alloc(VALUE klass) {
-  Vec4Data *data = ALLOC(Vec4Data);
+  Vec4Data *data = NULL;
+  VALUE obj = TypedData_Make_Struct(klass, Vec4Data, &vec4_type, data);
   data->x = 0.0;
   data->y = 0.0;
   data->z = 0.0;
   data->w = 1.0;
-  return TypedData_Wrap_Struct(klass, &vec4_type, data);
+  return obj;
 }
 
 VALUE vec4_initialize(int argc, VALUE *argv, VALUE self) {
+  rb_check_frozen(self);
   VALUE vx = Qnil;
   VALUE vy = Qnil;
   VALUE vz = Qnil;
@@ -66,6 +65,12 @@ VALUE vec4_initialize(int argc, VALUE *argv, VALUE self) {
   return self;
 }
 
+static VALUE vec4_initialize_copy(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  *vec4_get(self) = *vec4_get(other);
+  return self;
+}
+
 static VALUE vec4_class_bracket(int argc, VALUE *argv, VALUE klass) {
   VALUE vx = Qnil;
   VALUE vy = Qnil;
@@ -77,12 +82,21 @@ static VALUE vec4_class_bracket(int argc, VALUE *argv, VALUE klass) {
                     value_to_double(vz), NIL_P(vw) ? 1.0 : value_to_double(vw));
 }
 
+static VALUE vec4_constant(VALUE klass, VALUE constant) {
+  if (klass == cVec4) {
+    return constant;
+  }
+  VALUE obj = vec4_alloc(klass);
+  *vec4_get(obj) = *vec4_get(constant);
+  return obj;
+}
+
 static VALUE vec4_class_zero(VALUE klass) {
-  return vec4_build(klass, 0.0, 0.0, 0.0, 0.0);
+  return vec4_constant(klass, vec4_const_zero);
 }
 
 static VALUE vec4_class_one(VALUE klass) {
-  return vec4_build(klass, 1.0, 1.0, 1.0, 1.0);
+  return vec4_constant(klass, vec4_const_one);
 }
 
 static VALUE vec4_get_x(VALUE self) {
@@ -91,6 +105,7 @@ static VALUE vec4_get_x(VALUE self) {
 }
 
 static VALUE vec4_set_x(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec4Data *data = vec4_get(self);
   data->x = value_to_double(value);
   return value;
@@ -102,6 +117,7 @@ static VALUE vec4_get_y(VALUE self) {
 }
 
 static VALUE vec4_set_y(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec4Data *data = vec4_get(self);
   data->y = value_to_double(value);
   return value;
@@ -113,6 +129,7 @@ static VALUE vec4_get_z(VALUE self) {
 }
 
 static VALUE vec4_set_z(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec4Data *data = vec4_get(self);
   data->z = value_to_double(value);
   return value;
@@ -124,6 +141,7 @@ static VALUE vec4_get_w(VALUE self) {
 }
 
 static VALUE vec4_set_w(VALUE self, VALUE value) {
+  rb_check_frozen(self);
   Vec4Data *data = vec4_get(self);
   data->w = value_to_double(value);
   return value;
@@ -186,6 +204,7 @@ VALUE vec4_normalize(VALUE self) {
 }
 
 VALUE vec4_normalize_bang(VALUE self) {
+  rb_check_frozen(self);
   Vec4Data *a = vec4_get(self);
   double len = sqrt(a->x * a->x + a->y * a->y + a->z * a->z + a->w * a->w);
   a->x /= len;
@@ -197,29 +216,22 @@ VALUE vec4_normalize_bang(VALUE self) {
 
 VALUE vec4_perspective_divide(VALUE self) {
   Vec4Data *a = vec4_get(self);
-  VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
 
   if (a->w == 0.0 || a->w == 1.0) {
-    return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(a->x),
-                      DBL2NUM(a->y), DBL2NUM(a->z));
+    return vec3_build(cVec3, a->x, a->y, a->z);
   }
 
-  return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(a->x / a->w),
-                    DBL2NUM(a->y / a->w), DBL2NUM(a->z / a->w));
+  return vec3_build(cVec3, a->x / a->w, a->y / a->w, a->z / a->w);
 }
 
 VALUE vec4_xyz(VALUE self) {
   Vec4Data *a = vec4_get(self);
-  VALUE vec3_class = rb_const_get(mLarb, rb_intern("Vec3"));
-  return rb_funcall(vec3_class, rb_intern("new"), 3, DBL2NUM(a->x),
-                    DBL2NUM(a->y), DBL2NUM(a->z));
+  return vec3_build(cVec3, a->x, a->y, a->z);
 }
 
 VALUE vec4_xy(VALUE self) {
   Vec4Data *a = vec4_get(self);
-  VALUE vec2_class = rb_const_get(mLarb, rb_intern("Vec2"));
-  return rb_funcall(vec2_class, rb_intern("new"), 2, DBL2NUM(a->x),
-                    DBL2NUM(a->y));
+  return vec2_build(cVec2, a->x, a->y);
 }
 
 VALUE vec4_rgb(VALUE self) {
@@ -278,6 +290,61 @@ VALUE vec4_lerp(VALUE self, VALUE other, VALUE t) {
                     a->w + (b->w - a->w) * s);
 }
 
+VALUE vec4_add_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec4Data *a = vec4_get(self);
+  Vec4Data *b = vec4_get(other);
+  a->x += b->x;
+  a->y += b->y;
+  a->z += b->z;
+  a->w += b->w;
+  return self;
+}
+
+VALUE vec4_sub_bang(VALUE self, VALUE other) {
+  rb_check_frozen(self);
+  Vec4Data *a = vec4_get(self);
+  Vec4Data *b = vec4_get(other);
+  a->x -= b->x;
+  a->y -= b->y;
+  a->z -= b->z;
+  a->w -= b->w;
+  return self;
+}
+
+VALUE vec4_mul_bang(VALUE self, VALUE scalar) {
+  rb_check_frozen(self);
+  Vec4Data *a = vec4_get(self);
+  double s = value_to_double(scalar);
+  a->x *= s;
+  a->y *= s;
+  a->z *= s;
+  a->w *= s;
+  return self;
+}
+
+VALUE vec4_negate_bang(VALUE self) {
+  rb_check_frozen(self);
+  Vec4Data *a = vec4_get(self);
+  a->x = -a->x;
+  a->y = -a->y;
+  a->z = -a->z;
+  a->w = -a->w;
+  return self;
+}
+
+VALUE vec4_lerp_bang(VALUE self, VALUE other, VALUE t) {
+  rb_check_frozen(self);
+  Vec4Data *a = vec4_get(self);
+  Vec4Data *b = vec4_get(other);
+  double s = value_to_double(t);
+  a->x += (b->x - a->x) * s;
+  a->y += (b->y - a->y) * s;
+  a->z += (b->z - a->z) * s;
+  a->w += (b->w - a->w) * s;
+  return self;
+}
+
 VALUE vec4_inspect(VALUE self) {
   Vec4Data *a = vec4_get(self);
   VALUE sx = rb_funcall(DBL2NUM(a->x), rb_intern("to_s"), 0);
@@ -301,6 +368,7 @@ void Init_vec4(VALUE module) {
 
   rb_define_alloc_func(cVec4, vec4_alloc);
   rb_define_method(cVec4, "initialize", vec4_initialize, -1);
+  rb_define_method(cVec4, "initialize_copy", vec4_initialize_copy, 1);
 
   rb_define_singleton_method(cVec4, "[]", vec4_class_bracket, -1);
   rb_define_singleton_method(cVec4, "zero", vec4_class_zero, 0);
@@ -335,6 +403,17 @@ void Init_vec4(VALUE module) {
   rb_define_method(cVec4, "==", vec4_equal, 1);
   rb_define_method(cVec4, "near?", vec4_near, -1);
   rb_define_method(cVec4, "lerp", vec4_lerp, 2);
+  rb_define_method(cVec4, "add!", vec4_add_bang, 1);
+  rb_define_method(cVec4, "sub!", vec4_sub_bang, 1);
+  rb_define_method(cVec4, "mul!", vec4_mul_bang, 1);
+  rb_define_alias(cVec4, "scale!", "mul!");
+  rb_define_method(cVec4, "negate!", vec4_negate_bang, 0);
+  rb_define_method(cVec4, "lerp!", vec4_lerp_bang, 2);
   rb_define_method(cVec4, "inspect", vec4_inspect, 0);
   rb_define_alias(cVec4, "to_s", "inspect");
+
+  larb_define_constant(cVec4, "ZERO", &vec4_const_zero,
+                       vec4_build(cVec4, 0.0, 0.0, 0.0, 0.0));
+  larb_define_constant(cVec4, "ONE", &vec4_const_one,
+                       vec4_build(cVec4, 1.0, 1.0, 1.0, 1.0));
 }
@@ -10,9 +10,13 @@ typedef struct {
   double w;
 } Vec4Data;
 
+extern VALUE cVec4;
+
 void Init_vec4(VALUE module);
 VALUE vec4_alloc(VALUE klass);
 VALUE vec4_initialize(int argc, VALUE *argv, VALUE self);
+Vec4Data *vec4_get(VALUE obj);
+VALUE vec4_build(VALUE klass, double x, double y, double z, double w);
 
 VALUE vec4_add(VALUE self, VALUE other);
 VALUE vec4_sub(VALUE self, VALUE other);
@@ -33,6 +37,11 @@ VALUE vec4_aref(VALUE self, VALUE index);
 VALUE vec4_equal(VALUE self, VALUE other);
 VALUE vec4_near(int argc, VALUE *argv, VALUE self);
 VALUE vec4_lerp(VALUE self, VALUE other, VALUE t);
+VALUE vec4_add_bang(VALUE self, VALUE other);
+VALUE vec4_sub_bang(VALUE self, VALUE other);
+VALUE vec4_mul_bang(VALUE self, VALUE scalar);
+VALUE vec4_negate_bang(VALUE self);
+VALUE vec4_lerp_bang(VALUE self, VALUE other, VALUE t);
 VALUE vec4_inspect(VALUE self);
 
 #endif
@@ -0,0 +1,43 @@
+#include "view.h"
+
+bool view_fill(rb_memory_view_t *view, VALUE obj, void *data, long count,
+               bool readonly, int flags, const ViewLayout *layout) {
+  if (readonly && (flags & RUBY_MEMORY_VIEW_WRITABLE)) {
+    return false;
+  }
+
+  ssize_t ndim = layout->ndim + (count >= 0 ? 1 : 0);
+  ssize_t *dims = ALLOC_N(ssize_t, 2 * ndim);
+  ssize_t *shape = dims;
+  ssize_t *strides = dims + ndim;
+  ssize_t offset = 0;
+  if (count >= 0) {
+    shape[0] = count;
+    strides[0] = layout->element_size;
+    offset = 1;
+  }
+  for (ssize_t i = 0; i < layout->ndim; i++) {
+    shape[offset + i] = layout->shape[i];
+    strides[offset + i] = layout->strides[i];
+  }
+
+  view->obj = obj;
+  view->data = data;
+  view->byte_size = layout->element_size * (count >= 0 ? count : 1);
+  view->readonly = readonly;
+  view->format = layout->format;
+  view->item_size = layout->item_size;
+  view->item_desc.components = NULL;
+  view->item_desc.length = 0;
+  view->ndim = ndim;
+  view->shape = shape;
+  view->strides = strides;
+  view->sub_offsets = NULL;
+  view->private_data = dims;
+  return true;
+}
+
+void view_release(rb_memory_view_t *view) {
+  xfree(view->private_data);
+  view->private_data = NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "larb.h"
+
+#include <ruby/memory_view.h>
+
+typedef struct {
+  const char *format;
+  ssize_t item_size;
+  ssize_t element_size;
+  ssize_t ndim;
+  ssize_t shape[2];
+  ssize_t strides[2];
+} ViewLayout;
+
+bool view_fill(rb_memory_view_t *view, VALUE obj, void *data, long count,
+               bool readonly, int flags, const ViewLayout *layout);
+void view_release(rb_memory_view_t *view);
+
+#endif
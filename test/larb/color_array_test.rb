@@ -0,0 +1,178 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class ColorArrayTest < Test::Unit::TestCase
+  def build(*colors)
+    Larb::ColorArray.from(colors.map { |c| Larb::Color.new(*c) })
+  end
+
+  def test_new_is_zero_filled
+    a = Larb::ColorArray.new(2)
+    assert_equal 2, a.length
+    assert_equal Larb::Color.new(0, 0, 0, 0), a[1]
+  end
+
+  def test_new_with_negative_length
+    assert_raise(ArgumentError) { Larb::ColorArray.new(-1) }
+  end
+
+  def test_from_and_index
+    a = build([1, 0.5, 0.25, 1], [0, 0, 1, 0.5])
+    assert_equal 2, a.size
+    assert_equal Larb::Color.new(1, 0.5, 0.25, 1), a[0]
+    assert_equal Larb::Color.new(0, 0, 1, 0.5), a[-1]
+    assert_nil a[2]
+  end
+
+  def test_index_assign
+    a = Larb::ColorArray.new(1)
+    a[0] = Larb::Color.new(0.5, 0.5, 0.5, 1)
+    assert_equal Larb::Color.new(0.5, 0.5, 0.5, 1), a[0]
+    assert_raise(IndexError) { a[1] = Larb::Color.new }
+  end
+
+  def test_stores_single_precision
+    a = build([0.1, 0.2, 0.3, 1])
+    assert a[0].near?(Larb::Color.new(0.1, 0.2, 0.3, 1))
+  end
+
+  def test_dup_copies_storage
+    a = build([1, 1, 1, 1])
+    b = a.dup
+    b[0] = Larb::Color.new(0, 0, 0, 0)
+    assert_equal Larb::Color.new(1, 1, 1, 1), a[0]
+  end
+
+  def test_to_rgba8
+    bytes = build([1, 0.5, 0, 1], [2, -1, 0.25, 0]).to_rgba8
+    assert_equal Encoding::BINARY, bytes.encoding
+    assert_equal [255, 128, 0, 255, 255, 0, 64, 0], bytes.unpack("C*")
+  end
+
+  def test_to_rgba8_matches_color_to_bytes
+    colors = [Larb::Color.new(0.2, 0.4, 0.6, 0.8), Larb::Color.new(0.5, 0.25, 1, 0)]
+    bytes = Larb::ColorArray.from(colors).to_rgba8
+    assert_equal colors.flat_map(&:to_bytes), bytes.unpack("C*")
+  end
+
+  def test_from_rgba8
+    a = Larb::ColorArray.from_rgba8([255, 0, 51, 255, 0, 255, 0, 0].pack("C*"))
+    assert_equal 2, a.length
+    assert a[0].near?(Larb::Color.new(1, 0, 0.2, 1))
+    assert_equal Larb::Color.new(0, 1, 0, 0), a[1]
+  end
+
+  def test_from_rgba8_round_trip
+    bytes = (0..255).to_a.pack("C*")
+    assert_equal bytes, Larb::ColorArray.from_rgba8(bytes).to_rgba8
+  end
+
+  def test_from_rgba8_threaded_round_trip
+    threshold = Larb.gvl_threshold
+    threads = Larb.threads
+    bytes = Array.new(80_000) { |i| i % 256 }.pack("C*")
+    Larb.threads = 4
+    Larb.gvl_threshold = 0
+    assert_equal bytes, Larb::ColorArray.from_rgba8(bytes).to_rgba8
+  ensure
+    Larb.gvl_threshold = threshold
+    Larb.threads = threads
+  end
+
+  def test_from_rgba8_invalid_size
+    assert_raise(ArgumentError) { Larb::ColorArray.from_rgba8("abc") }
+  end
+
+  def test_add
+    a = build([0.25, 0.5, 0, 1])
+    assert_equal build([0.5, 1, 0, 2]), a + a
+    assert_equal build([0.5, 0.5, 0.5, 1]), a.add(Larb::Color.new(0.25, 0, 0.5, 0))
+  end
+
+  def test_add_type_mismatch
+    assert_raise(TypeError) { build([1, 1, 1, 1]) + 1 }
+  end
+
+  def test_multiply
+    a = build([0.5, 1, 0.25, 1])
+    assert_equal build([1, 2, 0.5, 2]), a * 2
+    assert_equal build([0.25, 0.5, 0, 1]), a * Larb::Color.new(0.5, 0.5, 0, 1)
+    assert_equal build([0.25, 1, 0.0625, 1]), a.multiply(a)
+  end
+
+  def test_multiply_into_output
+    a = build([0.5, 0.5, 0.5, 0.5])
+    assert_same a, a.multiply(2, a)
+    assert_equal build([1, 1, 1, 1]), a
+  end
+
+  def test_lerp
+    a = build([0, 0, 0, 0], [1, 1, 1, 1])
+    b = build([1, 0.5, 0, 1], [0, 0, 0, 0])
+    assert_equal build([0.5, 0.25, 0, 0.5], [0.5, 0.5, 0.5, 0.5]), a.lerp(b, 0.5)
+    assert_equal build([0.5, 0.5, 0.5, 0.5], [1, 1, 1, 1]), a.lerp(Larb::Color.white, 0.5)
+  end
+
+  def test_lerp_converts_t_before_reading_storage
+    a = build([1, 0.5, 0, 1])
+    t = Object.new
+    t.define_singleton_method(:to_f) do
+      a.to_io_buffer.resize(a.to_io_buffer.size * 8)
+      0.5
+    end
+    assert_equal build([1, 0.5, 0, 1]), a.lerp(build([1, 0.5, 0, 1]), t)
+  end
+
+  def test_length_mismatch
+    assert_raise(ArgumentError) { build([1, 1, 1, 1]).lerp(Larb::ColorArray.new(2), 0.5) }
+  end
+
+  def test_clamp
+    a = build([2, -1, 0.5, 1])
+    assert_equal build([1, 0, 0.5, 1]), a.clamp
+    a.clamp(a)
+    assert_equal build([1, 0, 0.5, 1]), a
+  end
+
+  def test_each_and_to_a
+    a = build([1, 0, 0, 1], [0, 1, 0, 1])
+    assert_equal [Larb::Color.red, Larb::Color.green], a.to_a
+    assert_equal [1.0, 0.0], a.map(&:r)
+  end
+
+  def test_each_rechecks_storage
+    a = build([1, 0, 0, 1], [0, 1, 0, 1])
+    seen = []
+    assert_raise(RuntimeError) do
+      a.each do |color|
+        seen << color
+        a.to_io_buffer.free
+      end
+    end
+    assert_equal [Larb::Color.red], seen
+  end
+
+  def test_inspect
+    assert_equal "ColorArray[Color[1.0, 0.5, 0.0, 1.0]]", build([1, 0.5, 0, 1]).inspect
+  end
+
+  def test_io_buffer_round_trip
+    a = build([1, 0.5, 0.25, 1])
+    buffer = a.to_io_buffer
+    assert_equal [1.0, 0.5, 0.25, 1.0], buffer.get_values([:f32] * 4, 0)
+    b = Larb::ColorArray.from_io_buffer(buffer)
+    b[0] = Larb::Color.new(0, 0, 0, 0)
+    assert_equal Larb::Color.new(0, 0, 0, 0), a[0]
+  end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(build([1, 0.5, 0.25, 1]))
+    assert_equal "f", view.format
+    assert_equal [1, 4], view.shape
+    assert_equal [16, 4], view.strides
+    assert_equal 0.25, view[0, 2]
+    view.release
+  end
+end
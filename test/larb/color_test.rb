@@ -275,4 +275,45 @@ class ColorTest < Test::Unit::TestCase
     c = Larb::Color.new(0.1, 0.2, 0.3, 0.4)
     assert_equal c.inspect, c.to_s
   end
+
+  def test_bang_arithmetic
+    c = Larb::Color.new(0.5, 0.25, 0.5, 1.0)
+    assert_same c, c.add!(Larb::Color.new(0.25, 0.25, 0.25, 0.0))
+    assert_equal Larb::Color.new(0.75, 0.5, 0.75, 1.0), c
+    c.sub!(Larb::Color.new(0.25, 0.25, 0.25, 0.0))
+    assert_equal Larb::Color.new(0.5, 0.25, 0.5, 1.0), c
+    c.mul!(2)
+    assert_equal Larb::Color.new(1.0, 0.5, 1.0, 2.0), c
+    c.mul!(Larb::Color.new(0.5, 0.5, 0.5, 0.5))
+    assert_equal Larb::Color.new(0.5, 0.25, 0.5, 1.0), c
+    assert_raise(TypeError) { c.mul!("x") }
+  end
+
+  def test_lerp_bang
+    c = Larb::Color.black.dup
+    c.lerp!(Larb::Color.white, 0.5)
+    assert_equal Larb::Color.new(0.5, 0.5, 0.5, 1.0), c
+  end
+
+  def test_clamp_bang
+    c = Larb::Color.new(1.5, -0.5, 0.5, 2.0)
+    assert_same c, c.clamp!
+    assert_equal Larb::Color.new(1.0, 0.0, 0.5, 1.0), c
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Color::RED, Larb::Color.red
+    assert_same Larb::Color::TRANSPARENT, Larb::Color.transparent
+    assert_equal Larb::Color.new(1, 1, 0, 1), Larb::Color::YELLOW
+    assert_raise(FrozenError) { Larb::Color.white.a = 0.5 }
+    assert_raise(FrozenError) { Larb::Color.white.clamp! }
+    assert_equal Larb::Color.new(1, 0, 0, 0.5), Larb::Color.red.dup.tap { |c| c.a = 0.5 }
+  end
+
+  def test_vector_conversions_require_larb_vectors
+    assert_equal Larb::Vec3.new(1, 0, 0), Larb::Color.red.to_vec3
+    assert_equal Larb::Color.new(0, 1, 0, 0.5), Larb::Color.from_vec3(Larb::Vec3.new(0, 1, 0), 0.5)
+    assert_raise(TypeError) { Larb::Color.from_vec4(Larb::Vec3.new) }
+    assert_raise(TypeError) { Larb::Color.from_vec3(Struct.new(:x, :y, :z).new(1, 2, 3)) }
+  end
 end
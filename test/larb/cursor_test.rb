@@ -0,0 +1,68 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class CursorTest < Test::Unit::TestCase
+  def chunks(cursor)
+    result = []
+    cursor.step { |offset, count| result << [offset, count] }
+    result
+  end
+
+  def test_element_budget
+    cursor = Larb::Cursor.new(10, elements: 4)
+    assert_equal [[0, 4]], chunks(cursor)
+    assert_equal 4, cursor.position
+    assert_equal [[4, 4]], chunks(cursor)
+    assert_false cursor.done?
+    assert cursor.step { |_offset, count| assert_equal 2, count }
+    assert cursor.done?
+    assert_equal [], chunks(cursor)
+    assert_equal [[0, 4]], chunks(cursor.rewind)
+  end
+
+  def test_without_budget
+    cursor = Larb::Cursor.new(10)
+    assert_equal [[0, 10]], chunks(cursor)
+    assert cursor.done?
+    assert Larb::Cursor.new(0).step { flunk }
+  end
+
+  def test_time_budget
+    cursor = Larb::Cursor.new(10, time: 1e-9, grain: 3)
+    assert_equal [[0, 3]], chunks(cursor)
+    assert_equal [[3, 3]], chunks(cursor)
+    cursor = Larb::Cursor.new(10, time: 60, grain: 3, elements: 7)
+    assert_equal [[0, 3], [3, 3], [6, 1]], chunks(cursor)
+    assert_equal 10, cursor.length
+  end
+
+  def test_failed_chunk_is_retried
+    cursor = Larb::Cursor.new(10, elements: 5)
+    assert_raise(RuntimeError) { cursor.step { raise "boom" } }
+    assert_equal [[0, 5]], chunks(cursor)
+  end
+
+  def test_invalid_options
+    assert_raise(ArgumentError) { Larb::Cursor.new(-1) }
+    assert_raise(ArgumentError) { Larb::Cursor.new(1, elements: 0) }
+    assert_raise(ArgumentError) { Larb::Cursor.new(1, time: 0) }
+    assert_raise(ArgumentError) { Larb::Cursor.new(1, grain: 0) }
+    assert_raise(ArgumentError) { Larb::Cursor.new(1, budget: 1) }
+    assert_raise(LocalJumpError) { Larb::Cursor.new(1).step }
+  end
+
+  def test_transform_in_slices
+    points = Larb::Vec3Array.from(Array.new(10) { |i| Larb::Vec3.new(i, 1, 2) })
+    out = Larb::Vec3Array.new(points.length)
+    m = Larb::Mat4.rotation_z(0.5)
+    cursor = Larb::Cursor.new(points.length, elements: 3)
+    steps = 0
+    until cursor.done?
+      cursor.step { |offset, count| m.transform_points(points.view(offset, count), out.view(offset, count)) }
+      steps += 1
+    end
+    assert_equal 4, steps
+    assert_equal m.transform_points(points), out
+  end
+end
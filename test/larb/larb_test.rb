@@ -0,0 +1,190 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class LarbTest < Test::Unit::TestCase
+  def setup
+    @gvl_threshold = Larb.gvl_threshold
+    @threads = Larb.threads
+    @simd_level = Larb.simd_level
+  end
+
+  def teardown
+    Larb.gvl_threshold = @gvl_threshold
+    Larb.threads = @threads
+    Larb.simd_level = @simd_level
+  end
+
+  def points
+    Larb::Vec3Array.from([Larb::Vec3.new(1, 2, 3), Larb::Vec3.new(0, 3, 4)])
+  end
+
+  def test_gvl_threshold
+    assert_kind_of Integer, Larb.gvl_threshold
+    Larb.gvl_threshold = 10
+    assert_equal 10, Larb.gvl_threshold
+    Larb.gvl_threshold = nil
+    assert_nil Larb.gvl_threshold
+    assert_raise(ArgumentError) { Larb.gvl_threshold = -1 }
+    assert_raise(TypeError) { Larb.gvl_threshold = "10" }
+  end
+
+  def test_released_kernels_match_held_kernels
+    m = Larb::Mat4.trs(Larb::Vec3.new(1, 2, 3), Larb::Quat.from_euler(0.3, -0.7, 1.1), Larb::Vec3.one)
+    q = Larb::QuatArray.from([Larb::Quat.identity, Larb::Quat.from_euler(0.1, 0.2, 0.3)])
+    colors = Larb::ColorArray.from([Larb::Color.red, Larb::Color.new(0.5, 2, -1, 1)])
+    run = lambda do
+      [
+        points.add(points), points.normalize, points.lerp(Larb::Vec3.one, 0.25),
+        m.transform_points(points), Larb::Vec2Array.from([Larb::Vec2.new(1, 2)]).rotate(0.5),
+        q.slerp(q.conjugate, [0.25, 0.75]), Larb::Mat4Array.from([m]).inverse,
+        colors.clamp, colors.to_rgba8
+      ]
+    end
+    Larb.gvl_threshold = nil
+    held = run.call
+    Larb.gvl_threshold = 0
+    assert_equal held, run.call
+  end
+
+  def test_buffers_are_unlocked_after_released_kernels
+    Larb.gvl_threshold = 0
+    a = points
+    a.add(a, a)
+    assert_false a.to_io_buffer.locked?
+
+    singular = Larb::Mat4Array.from([Larb::Mat4.zero])
+    assert_raise(RuntimeError) { singular.inverse(singular) }
+    assert_false singular.to_io_buffer.locked?
+  end
+
+  def test_externally_locked_buffer_keeps_the_gvl
+    Larb.gvl_threshold = 0
+    a = points
+    expected = points.add(points)
+    a.to_io_buffer.locked { a.add(a, a) }
+    assert_equal expected, a
+  end
+
+  def test_views_pin_their_parent_buffer
+    Larb.gvl_threshold = 1
+    a = Larb::Vec3Array.new(2_000_000)
+    view = a.view(0, a.length)
+    worker = Thread.new { view.normalize! }
+    Thread.pass until worker.stop? || !worker.alive?
+    locked = 0
+    begin
+      a.to_io_buffer.free
+    rescue IO::Buffer::LockedError
+      locked += 1
+      Thread.pass
+      retry
+    end
+    worker.join
+    assert_operator locked, :>, 0
+  end
+
+  def test_view_keeps_the_gvl_when_parent_is_locked
+    Larb.gvl_threshold = 0
+    a = points
+    view = a.view(0, 2)
+    expected = points.add(points)
+    a.to_io_buffer.locked { view.add(view, view) }
+    assert_equal expected, a
+    assert_false a.to_io_buffer.locked?
+  end
+
+  def test_threads
+    assert_kind_of Integer, Larb.threads
+    Larb.threads = 3
+    assert_equal 3, Larb.threads
+    assert_raise(ArgumentError) { Larb.threads = 0 }
+    assert_raise(TypeError) { Larb.threads = nil }
+  end
+
+  def test_threaded_kernels_are_deterministic
+    n = 20_000
+    a = Larb::Vec3Array.from(Array.new(n) { |i| Larb::Vec3.new(i, i % 7 - 3, 1.0 / (i + 1)) })
+    matrices = Larb::Mat4Array.new(n)
+    matrices[n - 1] = Larb::Mat4.zero
+    matrices[5000] = Larb::Mat4.zero
+    m = Larb::Mat4.rotation_y(0.3)
+    run = lambda do
+      error = assert_raise(RuntimeError) { matrices.inverse }
+      [m.transform_points(a), a.normalize, a.cross(a.scale(2)), error.message]
+    end
+    Larb.threads = 1
+    serial = run.call
+    [2, 4].each do |threads|
+      Larb.threads = threads
+      [nil, 0].each do |threshold|
+        Larb.gvl_threshold = threshold
+        assert_equal serial, run.call
+      end
+    end
+    assert_equal "Matrix at index 5000 is not invertible", serial.last
+  end
+
+  def test_simd_level
+    assert_include Larb.simd_levels, Larb.simd_level
+    assert_include [:sse2, :scalar], Larb.simd_levels.first
+    Larb.simd_levels.each do |level|
+      Larb.simd_level = level
+      assert_equal level, Larb.simd_level
+    end
+    assert_raise(ArgumentError) { Larb.simd_level = :mmx }
+    unsupported = %i[avx2 avx512] - Larb.simd_levels
+    assert_raise(ArgumentError) { Larb.simd_level = unsupported.first } unless unsupported.empty?
+  end
+
+  def test_simd_levels_match_baseline
+    a = Larb::Vec3Array.from(Array.new(100) { |i| Larb::Vec3.new(i, i % 7 - 3, 1.0 / (i + 1)) })
+    b = Larb::Vec2Array.from(Array.new(100) { |i| Larb::Vec2.new(i % 5 - 2, i) })
+    m = Larb::Mat4.perspective(1.0, 1.5, 0.1, 100) * Larb::Mat4.rotation_y(0.3)
+    run = lambda do |array|
+      [array.add(array), array.cross(array.scale(2)), array.normalize, array.lerp(Larb::Vec3.one, 0.25),
+       m.transform_points(array), m.project_points(array), b.rotate(0.7), b.normalize,
+       array.convert(:float32).normalize.convert(:float64)]
+    end
+    Larb.simd_level = Larb.simd_levels.first
+    baseline = run.call(a)
+    Larb.simd_levels.each do |level|
+      Larb.simd_level = level
+      run.call(a).zip(baseline).each do |actual, expected|
+        actual.each_with_index { |v, i| assert v.near?(expected[i], 1e-5), "#{level}: #{v.inspect} != #{expected[i].inspect}" }
+      end
+    end
+  end
+
+  def test_constants_are_shareable
+    assert Ractor.shareable?(Larb::Vec3::ZERO)
+    assert Ractor.shareable?(Larb::Mat4::IDENTITY)
+    assert Ractor.shareable?(Larb::Color::WHITE)
+  end
+
+  def test_values_are_usable_from_ractors
+    v = Ractor.make_shareable(Larb::Vec3.new(1, 2, 2))
+    a = Ractor.make_shareable(points)
+    result = with_ractors { Ractor.new(v, a) { |x, y| [x.length, y.add(y)] }.take }
+    assert_equal [3.0, points.add(points)], result
+  end
+
+  def test_settings_are_main_ractor_only
+    ractor = with_ractors do
+      Ractor.new do
+        Larb.threads = 2
+      rescue Ractor::IsolationError => e
+        e.class
+      end
+    end
+    assert_equal Ractor::IsolationError, ractor.take
+  end
+
+  def with_ractors
+    experimental = Warning[:experimental]
+    Warning[:experimental] = false
+    yield
+  ensure
+    Warning[:experimental] = experimental
+  end
+end
@@ -141,4 +141,21 @@ class Mat2Test < Test::Unit::TestCase
     m = Larb::Mat2.identity
     assert_match(/Mat2/, m.inspect)
   end
+
+  def test_transform_points
+    m = Larb::Mat2.rotation(Math::PI / 3)
+    points = [Larb::Vec2.new(1, 0), Larb::Vec2.new(-2, 5)]
+    result = m.transform_points(Larb::Vec2Array.from(points))
+    points.each_with_index { |p, i| assert result[i].near?(m * p) }
+  end
+
+  def test_transform_points_type_mismatch
+    assert_raise(TypeError) { Larb::Mat2.identity.transform_points([Larb::Vec2.new]) }
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Mat2::IDENTITY, Larb::Mat2.identity
+    assert_same Larb::Mat2::ZERO, Larb::Mat2.zero
+    assert_raise(FrozenError) { Larb::Mat2.identity[0] = 2 }
+  end
 end
@@ -169,4 +169,48 @@ class Mat2dTest < Test::Unit::TestCase
     m = Larb::Mat2d.identity
     assert_match(/Mat2d/, m.inspect)
   end
+
+  def test_transform_points
+    m = Larb::Mat2d.from_rotation_translation_scale(0.5, Larb::Vec2.new(3, 4), Larb::Vec2.new(2, 1))
+    points = [Larb::Vec2.new(1, 0), Larb::Vec2.new(-2, 5)]
+    result = m.transform_points(Larb::Vec2Array.from(points))
+    points.each_with_index { |p, i| assert result[i].near?(m * p) }
+  end
+
+  def test_transform_points_into_output
+    m = Larb::Mat2d.translation(1, 2)
+    points = Larb::Vec2Array.from([Larb::Vec2.new(1, 1)])
+    assert_same points, m.transform_points(points, points)
+    assert_equal Larb::Vec2.new(2, 3), points[0]
+  end
+
+  def test_transform_points_length_mismatch
+    m = Larb::Mat2d.identity
+    assert_raise(ArgumentError) { m.transform_points(Larb::Vec2Array.new(2), Larb::Vec2Array.new(1)) }
+  end
+
+  def test_class_multiply_into_output
+    a = Larb::Mat2d.translation(1, 2)
+    b = Larb::Mat2d.rotation(0.5)
+    out = Larb::Mat2d.new
+    assert_same out, Larb::Mat2d.multiply(a, b, out)
+    assert_equal a * b, out
+    Larb::Mat2d.multiply(a, b, b)
+    assert_equal out, b
+  end
+
+  def test_invert_into
+    m = Larb::Mat2d.translation(1, 2) * Larb::Mat2d.scaling(2, 4)
+    out = Larb::Mat2d.new
+    assert_same out, m.invert_into(out)
+    assert out.near?(m.inverse)
+    assert_raise(RuntimeError) { Larb::Mat2d.zero.invert_into(out) }
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Mat2d::IDENTITY, Larb::Mat2d.identity
+    assert_raise(FrozenError) { Larb::Mat2d.zero[0] = 2 }
+    m = Larb::Mat2d.identity
+    assert_raise(FrozenError) { Larb::Mat2d.multiply(m, m, Larb::Mat2d::IDENTITY) }
+  end
 end
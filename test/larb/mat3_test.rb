@@ -135,7 +135,7 @@ class Mat3Test < Test::Unit::TestCase
 
   def test_near
     m1 = Larb::Mat3.identity
-    m2 = Larb::Mat3.identity
+    m2 = Larb::Mat3.identity.dup
     m2[0] = 1.0000001
     assert m1.near?(m2)
   end
@@ -144,4 +144,54 @@ class Mat3Test < Test::Unit::TestCase
     m = Larb::Mat3.identity
     assert_match(/Mat3/, m.inspect)
   end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(Larb::Mat3.new([1, 2, 3, 4, 5, 6, 7, 8, 9]))
+    assert_equal [3, 3], view.shape
+    assert_equal [8, 24], view.strides
+    assert_equal 4.0, view[0, 1]
+    view.release
+  end
+
+  def test_class_multiply_into_output
+    a = Larb::Mat3.translation(1, 2)
+    b = Larb::Mat3.rotation(0.5)
+    out = Larb::Mat3.new
+    assert_same out, Larb::Mat3.multiply(a, b, out)
+    assert_equal a * b, out
+    Larb::Mat3.multiply(a, b, a)
+    assert_equal out, a
+  end
+
+  def test_invert_into
+    m = Larb::Mat3.translation(1, 2) * Larb::Mat3.scaling(2, 4)
+    out = Larb::Mat3.new
+    assert_same out, m.invert_into(out)
+    assert out.near?(m.inverse)
+    assert_raise(RuntimeError) { Larb::Mat3.zero.invert_into(out) }
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Mat3::IDENTITY, Larb::Mat3.identity
+    assert_equal Larb::Mat3.zero, Larb::Mat3::ZERO
+    assert_raise(FrozenError) { Larb::Mat3.identity[4] = 2 }
+  end
+
+  def test_conversions_read_structs_directly
+    m4 = Larb::Mat4.new((1..16).map(&:to_f))
+    assert_equal [1.0, 2.0, 3.0, 5.0, 6.0, 7.0, 9.0, 10.0, 11.0], Larb::Mat3.from_mat4(m4).to_a
+    m2d = Larb::Mat2d.translation(3, 4)
+    assert_equal Larb::Mat3.translation(3, 4), Larb::Mat3.from_mat2d(m2d)
+    assert_equal Larb::Mat3.from_mat2d(m2d), m2d.to_mat3
+    assert_raise(TypeError) { Larb::Mat3.from_mat4(Larb::Mat3.identity) }
+    assert_raise(TypeError) { Larb::Mat3.from_quaternion(Larb::Vec4.new) }
+  end
+
+  def test_normal_from_mat4
+    m4 = Larb::Mat4.scaling(2, 4, 8)
+    expected = Larb::Mat3.from_mat4(m4).inverse.transpose
+    assert Larb::Mat3.normal_from_mat4(m4).near?(expected)
+    assert_raise(RuntimeError) { Larb::Mat3.normal_from_mat4(Larb::Mat4.zero) }
+  end
 end
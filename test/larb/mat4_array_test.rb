@@ -0,0 +1,249 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class Mat4ArrayTest < Test::Unit::TestCase
+  def sample
+    Larb::Mat4Array.from([
+      Larb::Mat4.translation(1, 2, 3),
+      Larb::Mat4.rotation_y(0.5) * Larb::Mat4.scaling(2, 3, 4)
+    ])
+  end
+
+  def test_new_is_identity_filled
+    a = Larb::Mat4Array.new(2)
+    assert_equal 2, a.length
+    assert_equal Larb::Mat4.identity, a[1]
+  end
+
+  def test_from_and_index
+    a = sample
+    assert_equal Larb::Mat4.translation(1, 2, 3), a[0]
+    assert_nil a[2]
+    assert_raise(IndexError) { a[2] = Larb::Mat4.identity }
+  end
+
+  def test_index_assign
+    a = Larb::Mat4Array.new(1)
+    a[0] = Larb::Mat4.scaling(2, 2, 2)
+    assert_equal Larb::Mat4.scaling(2, 2, 2), a[-1]
+  end
+
+  def test_to_a
+    assert_equal [Larb::Mat4.identity], Larb::Mat4Array.new(1).to_a
+  end
+
+  def test_multiply_elementwise
+    a = sample
+    b = Larb::Mat4Array.from([Larb::Mat4.scaling(2, 2, 2), Larb::Mat4.translation(1, 0, 0)])
+    result = Larb::Mat4Array.multiply(a, b)
+    assert_equal a[0] * b[0], result[0]
+    assert_equal a[1] * b[1], result[1]
+  end
+
+  def test_multiply_broadcast_left
+    parent = Larb::Mat4.translation(0, 10, 0)
+    locals = sample
+    result = Larb::Mat4Array.multiply(parent, locals)
+    assert_equal parent * locals[0], result[0]
+    assert_equal parent * locals[1], result[1]
+  end
+
+  def test_multiply_broadcast_right_into_output
+    a = sample
+    out = Larb::Mat4Array.new(2)
+    m = Larb::Mat4.rotation_x(0.3)
+    assert_same out, a.multiply(m, out)
+    assert_equal a[1] * m, out[1]
+  end
+
+  def test_multiply_in_place
+    a = sample
+    expected = a[1] * a[1]
+    a.multiply(a, a)
+    assert_equal expected, a[1]
+  end
+
+  def test_multiply_requires_an_array
+    assert_raise(TypeError) do
+      Larb::Mat4Array.multiply(Larb::Mat4.identity, Larb::Mat4.identity)
+    end
+  end
+
+  def test_multiply_length_mismatch
+    assert_raise(ArgumentError) { sample.multiply(Larb::Mat4Array.new(3)) }
+  end
+
+  def test_transpose
+    a = sample
+    assert_equal a[1].transpose, a.transpose[1]
+  end
+
+  def test_inverse
+    a = sample
+    result = a.inverse
+    assert result[0].near?(a[0].inverse)
+    assert result[1].near?(a[1].inverse)
+  end
+
+  def test_inverse_singular
+    a = Larb::Mat4Array.from([Larb::Mat4.identity, Larb::Mat4.zero])
+    assert_raise(RuntimeError) { a.inverse }
+  end
+
+  def test_inverse_in_place_leaves_batch_untouched_on_failure
+    %i[float64 float32].each do |type|
+      a = Larb::Mat4Array.from([Larb::Mat4.scaling(2, 2, 2), Larb::Mat4.zero], type: type)
+      before = a.dup
+      assert_raise_message("Matrix at index 1 is not invertible") { a.inverse(a) }
+      assert_equal before, a
+    end
+  end
+
+  def test_inverse_threshold_is_shared_by_element_types
+    near = Larb::Mat4.scaling(1e-3, 1e-3, 1e-3)
+    tiny = Larb::Mat4.scaling(1e-3, 1e-3, 1e-5)
+    %i[float64 float32].each do |type|
+      mask = IO::Buffer.new(2)
+      Larb::Mat4Array.from([near, tiny], type: type).inverse(mask: mask)
+      assert_equal [0, 1], mask.get_values(%i[U8 U8], 0), type.to_s
+    end
+    assert_nothing_raised { near.inverse }
+    assert_raise(RuntimeError) { tiny.inverse }
+  end
+
+  def test_inverse_mask
+    a = Larb::Mat4Array.from([Larb::Mat4.identity, Larb::Mat4.zero, Larb::Mat4.scaling(2, 2, 2)])
+    mask = IO::Buffer.new(3)
+    result = a.inverse(mask: mask)
+    assert_equal [0, 1, 0], mask.get_values(%i[U8 U8 U8], 0)
+    assert_equal Larb::Mat4.identity, result[1]
+    assert result[2].near?(Larb::Mat4.scaling(0.5, 0.5, 0.5))
+    assert_false mask.locked?
+    assert_raise(ArgumentError) { a.inverse(mask: IO::Buffer.new(2)) }
+    assert_raise(TypeError) { a.inverse(mask: "\0" * 3) }
+    assert_raise(IO::Buffer::AccessError) { a.inverse(mask: IO::Buffer.for("\0\0\0".freeze)) }
+  end
+
+  def test_inverse_in_lane_blocks
+    matrices = Array.new(19) { |i| Larb::Mat4.rotation_x(i * 0.3) * Larb::Mat4.translation(i, -i, 2) * Larb::Mat4.scaling(1, 2, i + 1) }
+    matrices[9] = Larb::Mat4.scaling(1, 0, 1)
+    matrices[17] = Larb::Mat4.zero
+    level = Larb.simd_level
+    Larb.simd_levels.product(%i[float64 float32]).each do |simd, type|
+      Larb.simd_level = simd
+      a = Larb::Mat4Array.from(matrices, type: type)
+      mask = IO::Buffer.new(19)
+      result = a.inverse(a.dup, mask: mask)
+      assert_equal [9, 17], (0...19).select { |i| mask.get_value(:U8, i) == 1 }
+      matrices.each_with_index do |m, i|
+        next if [9, 17].include?(i)
+
+        assert result[i].near?(m.inverse, 1e-4), "#{simd} #{type} #{i}"
+      end
+      assert_raise_message("Matrix at index 9 is not invertible") { a.inverse(a) }
+    end
+  ensure
+    Larb.simd_level = level
+  end
+
+  def test_determinant
+    a = sample
+    result = a.determinant
+    assert_in_delta 1.0, result[0], 1e-10
+    assert_in_delta 24.0, result[1], 1e-10
+  end
+
+  def test_dup_copies_storage
+    a = sample
+    b = a.dup
+    b[0] = Larb::Mat4.identity
+    assert_equal Larb::Mat4.translation(1, 2, 3), a[0]
+  end
+
+  def test_inspect
+    m = Larb::Mat4.translation(1, 2, 3)
+    assert_equal "Mat4Array[#{m.inspect}]", Larb::Mat4Array.from([m]).inspect
+    assert_equal "Mat4Array[#{sample.to_a.map(&:inspect).join(", ")}]", sample.inspect
+    assert_equal "Mat4Array[]", Larb::Mat4Array.new.inspect
+  end
+
+  def test_io_buffer_round_trip
+    a = Larb::Mat4Array.new(2)
+    buffer = a.to_io_buffer
+    assert_equal 256, buffer.size
+    b = Larb::Mat4Array.from_io_buffer(buffer)
+    b[1] = Larb::Mat4.translation(1, 2, 3)
+    assert_equal Larb::Mat4.translation(1, 2, 3), a[1]
+  end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(sample)
+    assert_equal [2, 4, 4], view.shape
+    assert_equal [128, 8, 32], view.strides
+    assert_equal 3.0, view[0, 2, 3]
+    view.release
+  end
+
+  def test_trs
+    t = [Larb::Vec3.new(1, 2, 3), Larb::Vec3.new(-4, 0, 5)]
+    q = [Larb::Quat.from_euler(0.3, -0.7, 1.1), Larb::Quat.identity]
+    s = [Larb::Vec3.new(2, 3, 4), Larb::Vec3.new(1, 1, 1)]
+    result = Larb::Mat4Array.trs(Larb::Vec3Array.from(t), Larb::QuatArray.from(q), Larb::Vec3Array.from(s))
+    2.times { |i| assert_equal Larb::Mat4.trs(t[i], q[i], s[i]), result[i] }
+  end
+
+  def test_trs_broadcast_scale_into_output
+    t = Larb::Vec3Array.from([Larb::Vec3.new(1, 2, 3)], type: :float32)
+    q = Larb::QuatArray.from([Larb::Quat.from_euler(0.3, -0.7, 1.1)], type: :float32)
+    out = Larb::Mat4Array.new(1, type: :float32)
+    assert_same out, Larb::Mat4Array.trs(t, q, Larb::Vec3.new(2, 2, 2), out)
+    assert out[0].near?(Larb::Mat4.trs(t[0], q[0], Larb::Vec3.new(2, 2, 2)), 1e-5)
+  end
+
+  def test_trs_mismatch
+    t = Larb::Vec3Array.new(2)
+    assert_raise(ArgumentError) { Larb::Mat4Array.trs(t, Larb::QuatArray.new(1), Larb::Vec3.one) }
+    assert_raise(ArgumentError) { Larb::Mat4Array.trs(t, Larb::QuatArray.new(2), Larb::Vec3Array.new(1)) }
+    assert_raise(ArgumentError) { Larb::Mat4Array.trs(t, Larb::QuatArray.new(2, type: :float32), Larb::Vec3.one) }
+    assert_raise(TypeError) { Larb::Mat4Array.trs(t, Larb::Vec3Array.new(2), Larb::Vec3.one) }
+  end
+
+  def test_float32_storage
+    matrices = [Larb::Mat4.translation(1, 2, 3), Larb::Mat4.scaling(2, 4, 8)]
+    exact = Larb::Mat4Array.from(matrices)
+    a = Larb::Mat4Array.from(matrices, type: :float32)
+    assert_equal :float32, a.type
+    assert_equal 128, a.to_io_buffer.size
+    assert_equal Larb::Mat4.identity, Larb::Mat4Array.new(1, type: :float32)[0]
+    assert_equal exact.multiply(exact), a.multiply(a)
+    assert_equal :float32, a.multiply(Larb::Mat4.identity).type
+    assert_equal exact.transpose, a.transpose
+    assert_equal exact.inverse, a.inverse
+    assert_equal exact.determinant, a.determinant
+    assert_equal exact, a.convert(:float64)
+    assert_raise(ArgumentError) { a.multiply(exact) }
+  end
+  def test_multiply_matches_across_simd_levels
+    a = Larb::Mat4.perspective(1.0, 1.5, 0.1, 100) * Larb::Mat4.translation(1, -2, 3)
+    b = Larb::Mat4.rotation_x(0.4) * Larb::Mat4.scaling(2, 3, 4)
+    run = lambda do
+      batch = Larb::Mat4Array.from([a, b, a])
+      single = batch.convert(:float32)
+      in_place = batch.dup
+      in_place.multiply(b, in_place)
+      [[a * b], batch.multiply(batch).to_a, Larb::Mat4Array.multiply(b, single).to_a,
+       single.multiply(single).to_a, in_place.to_a].flatten
+    end
+    level = Larb.simd_level
+    Larb.simd_level = Larb.simd_levels.first
+    expected = run.call
+    Larb.simd_levels.each do |simd|
+      Larb.simd_level = simd
+      run.call.zip(expected).each { |actual, m| assert actual.near?(m, 1e-4), "#{simd}: #{actual.inspect}" }
+    end
+  ensure
+    Larb.simd_level = level
+  end
+end
@@ -113,7 +113,7 @@ class Mat4Test < Test::Unit::TestCase
   end
 
   def test_index_assignment
-    m = Larb::Mat4.identity
+    m = Larb::Mat4.identity.dup
     m[0] = 5.0
     assert_equal 5.0, m[0]
   end
@@ -232,7 +232,7 @@ class Mat4Test < Test::Unit::TestCase
 
   def test_near
     m1 = Larb::Mat4.identity
-    m2 = Larb::Mat4.identity
+    m2 = Larb::Mat4.identity.dup
     m2[0] = 1.0000001
     assert m1.near?(m2)
   end
@@ -263,8 +263,144 @@ class Mat4Test < Test::Unit::TestCase
     assert_in_delta 0.0, m[0], 1e-10
   end
 
+  def test_trs_matches_composed_product
+    t = Larb::Vec3.new(1, 2, 3)
+    q = Larb::Quat.from_euler(0.3, -0.7, 1.1)
+    s = Larb::Vec3.new(2, 3, 4)
+    expected = Larb::Mat4.from_quaternion(q) * Larb::Mat4.scaling(2, 3, 4) * Larb::Mat4.translation(1, 2, 3)
+    assert Larb::Mat4.trs(t, q, s).near?(expected, 1e-12)
+  end
+
+  def test_transform_points
+    m = Larb::Mat4.translation(1, 2, 3) * Larb::Mat4.scaling(2, 2, 2)
+    points = Larb::Vec3Array.from([Larb::Vec3.new(1, 0, 0), Larb::Vec3.new(0, 1, 0)])
+    result = m.transform_points(points)
+    assert_instance_of Larb::Vec3Array, result
+    assert_equal Larb::Vec3.new(3, 2, 3), result[0]
+    assert_equal Larb::Vec3.new(1, 4, 3), result[1]
+    assert_equal Larb::Vec3.new(1, 0, 0), points[0]
+  end
+
+  def test_transform_points_in_place
+    m = Larb::Mat4.translation(1, 2, 3)
+    points = Larb::Vec3Array.from([Larb::Vec3.new(1, 1, 1)])
+    assert_same points, m.transform_points(points, points)
+    assert_equal Larb::Vec3.new(2, 3, 4), points[0]
+  end
+
+  def test_transform_points_length_mismatch
+    m = Larb::Mat4.identity
+    assert_raise(ArgumentError) do
+      m.transform_points(Larb::Vec3Array.new(2), Larb::Vec3Array.new(3))
+    end
+  end
+
+  def test_transform_directions_ignores_translation
+    m = Larb::Mat4.translation(1, 2, 3) * Larb::Mat4.rotation_z(Math::PI / 2)
+    dirs = Larb::Vec3Array.from([Larb::Vec3.new(1, 0, 0)])
+    assert m.transform_directions(dirs)[0].near?(Larb::Vec3.new(0, 1, 0))
+  end
+
+  def test_project_points_matches_perspective_divide
+    m = Larb::Mat4.perspective(Math::PI / 3, 1.5, 0.1, 100)
+    point = Larb::Vec3.new(1, 2, -5)
+    expected = (m * point.to_vec4).perspective_divide
+    result = m.project_points(Larb::Vec3Array.from([point]))
+    assert result[0].near?(expected)
+  end
+
   def test_inspect
     m = Larb::Mat4.identity
     assert_match(/Mat4/, m.inspect)
   end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(Larb::Mat4.translation(1, 2, 3))
+    assert_equal "d", view.format
+    assert_equal [4, 4], view.shape
+    assert_equal [8, 32], view.strides
+    assert_equal 2.0, view[1, 3]
+    assert_equal 1.0, view[3, 3]
+    view.release
+  end
+
+  def test_class_multiply_into_output
+    a = Larb::Mat4.translation(1, 2, 3)
+    b = Larb::Mat4.rotation_y(0.5)
+    out = Larb::Mat4.new
+    assert_same out, Larb::Mat4.multiply(a, b, out)
+    assert_equal a * b, out
+    assert_equal a * b, Larb::Mat4.multiply(a, b)
+  end
+
+  def test_class_multiply_aliasing_operand
+    a = Larb::Mat4.translation(1, 2, 3)
+    b = Larb::Mat4.scaling(2, 2, 2)
+    expected = a * b
+    Larb::Mat4.multiply(a, b, a)
+    assert_equal expected, a
+  end
+
+  def test_invert_into
+    m = Larb::Mat4.translation(1, 2, 3) * Larb::Mat4.scaling(2, 4, 8)
+    out = Larb::Mat4.new
+    assert_same out, m.invert_into(out)
+    assert out.near?(m.inverse)
+    m.invert_into(m)
+    assert m.near?(out)
+  end
+
+  def test_invert_into_singular_leaves_output
+    out = Larb::Mat4.translation(1, 2, 3)
+    assert_raise(RuntimeError) { Larb::Mat4.zero.invert_into(out) }
+    assert_equal Larb::Mat4.translation(1, 2, 3), out
+  end
+
+  def test_transpose_into
+    m = Larb::Mat4.translation(1, 2, 3)
+    out = Larb::Mat4.new
+    assert_same out, m.transpose_into(out)
+    assert_equal m.transpose, out
+  end
+
+  def test_output_must_not_be_frozen
+    out = Larb::Mat4.new.freeze
+    assert_raise(FrozenError) { Larb::Mat4.multiply(Larb::Mat4.identity, Larb::Mat4.identity, out) }
+    assert_raise(TypeError) { Larb::Mat4.identity.invert_into(Larb::Mat3.new) }
+  end
+
+  def test_memory_view_survives_compaction
+    omit "compaction unsupported" unless GC.respond_to?(:verify_compaction_references)
+    require "fiddle"
+    m = Larb::Mat4.translation(1, 2, 3)
+    view = Fiddle::MemoryView.new(m)
+    GC.verify_compaction_references(expand_heap: true, toward: :empty)
+    m[0] = 42.0
+    assert_equal 42.0, view[0, 0]
+    view.release
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Mat4::IDENTITY, Larb::Mat4.identity
+    assert_same Larb::Mat4::ZERO, Larb::Mat4.zero
+    assert_raise(FrozenError) { Larb::Mat4.identity[0] = 2 }
+    assert_raise(FrozenError) { Larb::Mat4.zero.invert_into(Larb::Mat4::IDENTITY) }
+    assert_not_same Larb::Mat4::IDENTITY, Larb::Mat4.translation(0, 0, 0)
+  end
+
+  def test_dup_is_mutable_copy
+    m = Larb::Mat4.identity.dup
+    m[12] = 3
+    assert_equal Larb::Mat4.translation(3, 0, 0), m
+    assert_equal 0.0, Larb::Mat4::IDENTITY[12]
+  end
+
+  def test_mixed_type_operands_are_type_checked
+    m = Larb::Mat4.translation(1, 2, 3)
+    assert_equal Larb::Vec4.new(2, 3, 4, 1), m * Larb::Vec3.new(1, 1, 1)
+    assert_equal Larb::Quat.identity, Larb::Mat4.identity.extract_rotation
+    assert_raise(TypeError) { Larb::Mat4.from_quaternion(Larb::Vec4.new) }
+    assert_raise(TypeError) { Larb::Mat4.look_at(Larb::Vec3.new, Larb::Vec3.new(0, 0, -1), [0, 1, 0]) }
+  end
 end
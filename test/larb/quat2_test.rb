@@ -135,6 +135,32 @@ class Quat2Test < Test::Unit::TestCase
     assert_in_delta 4.0, result.z, 1e-10
   end
 
+  def test_transform_point_matches_rotation_and_translation
+    rotation = Larb::Quat.from_euler(0.3, -0.7, 1.1)
+    translation = Larb::Vec3.new(1, -2, 3)
+    q = Larb::Quat2.from_rotation_translation(rotation, translation)
+    point = Larb::Vec3.new(4, 5, -6)
+    assert q.transform_point(point).near?(rotation * point + translation, 1e-9)
+  end
+
+  def test_transform_points
+    rotation = Larb::Quat.from_euler(0.3, -0.7, 1.1)
+    q = Larb::Quat2.from_rotation_translation(rotation, Larb::Vec3.new(1, -2, 3))
+    points = [Larb::Vec3.new(4, 5, -6), Larb::Vec3.new(0, 1, 0)]
+    result = q.transform_points(Larb::Vec3Array.from(points))
+    points.each_with_index { |p, i| assert result[i].near?(q.transform_point(p), 1e-9) }
+
+    single = Larb::Vec3Array.from(points, type: :float32)
+    out = q.transform_points(single, single)
+    assert_same single, out
+    points.each_with_index { |p, i| assert out[i].near?(q.transform_point(p), 1e-5) }
+  end
+
+  def test_transform_points_length_mismatch
+    q = Larb::Quat2.identity
+    assert_raise(ArgumentError) { q.transform_points(Larb::Vec3Array.new(1), Larb::Vec3Array.new(2)) }
+  end
+
   def test_lerp
     q1 = Larb::Quat2.from_translation(Larb::Vec3.new(0, 0, 0))
     q2 = Larb::Quat2.from_translation(Larb::Vec3.new(10, 0, 0))
@@ -158,4 +184,10 @@ class Quat2Test < Test::Unit::TestCase
     q = Larb::Quat2.identity
     assert_match(/Quat2/, q.inspect)
   end
+
+  def test_identity_constant_is_frozen
+    assert_same Larb::Quat2::IDENTITY, Larb::Quat2.identity
+    assert_raise(FrozenError) { Larb::Quat2.identity[0] = 1 }
+    assert_equal Larb::Quat2.identity, Larb::Quat2.identity.dup
+  end
 end
@@ -0,0 +1,167 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class QuatArrayTest < Test::Unit::TestCase
+  def axis_angle(angle)
+    Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 1, 0), angle)
+  end
+
+  def rotations
+    [axis_angle(0.1), axis_angle(0.7), Larb::Quat.from_axis_angle(Larb::Vec3.new(1, 0, 0), 1.2)]
+  end
+
+  def test_new_is_identity_filled
+    a = Larb::QuatArray.new(2)
+    assert_equal 2, a.length
+    assert_equal Larb::Quat.identity, a[1]
+  end
+
+  def test_new_with_negative_length
+    assert_raise(ArgumentError) { Larb::QuatArray.new(-1) }
+  end
+
+  def test_from_and_to_a
+    qs = rotations
+    assert_equal qs, Larb::QuatArray.from(qs).to_a
+  end
+
+  def test_index_assign
+    a = Larb::QuatArray.new(1)
+    a[0] = Larb::Quat.new(1, 2, 3, 4)
+    assert_equal Larb::Quat.new(1, 2, 3, 4), a[-1]
+    assert_nil a[1]
+    assert_raise(IndexError) { a[1] = Larb::Quat.new }
+  end
+
+  def test_dup_copies_storage
+    a = Larb::QuatArray.from(rotations)
+    b = a.dup
+    b[0] = Larb::Quat.new(1, 2, 3, 4)
+    assert_equal rotations[0], a[0]
+  end
+
+  def test_multiply_matches_quat
+    qs = rotations
+    other = qs.reverse
+    result = Larb::QuatArray.from(qs).multiply(Larb::QuatArray.from(other))
+    qs.zip(other).each_with_index do |(q, o), i|
+      assert result[i].near?(q * o)
+    end
+  end
+
+  def test_class_multiply_broadcasts_quat
+    q = axis_angle(0.3)
+    result = Larb::QuatArray.multiply(Larb::QuatArray.from(rotations), q)
+    rotations.each_with_index { |r, i| assert result[i].near?(r * q) }
+  end
+
+  def test_multiply_in_place
+    a = Larb::QuatArray.from(rotations)
+    a.multiply(a, a)
+    rotations.each_with_index { |r, i| assert a[i].near?(r * r) }
+  end
+
+  def test_multiply_type_mismatch
+    assert_raise(TypeError) { Larb::QuatArray.new(1).multiply(1) }
+  end
+
+  def test_slerp_with_scalar
+    a = Larb::QuatArray.from(rotations)
+    b = Larb::QuatArray.from(rotations.reverse)
+    result = a.slerp(b, 0.25)
+    rotations.zip(rotations.reverse).each_with_index do |(q, o), i|
+      assert result[i].near?(q.slerp(o, 0.25))
+    end
+  end
+
+  def test_slerp_with_per_element_t
+    ts = [0.0, 0.5, 1.0]
+    target = axis_angle(2.0)
+    result = Larb::QuatArray.from(rotations).slerp(target, ts)
+    rotations.zip(ts).each_with_index do |(q, t), i|
+      assert result[i].near?(q.slerp(target, t))
+    end
+  end
+
+  def test_slerp_t_length_mismatch
+    assert_raise(ArgumentError) { Larb::QuatArray.new(2).slerp(Larb::Quat.new, [0.5]) }
+  end
+
+  def test_nlerp_matches_quat_lerp
+    target = axis_angle(1.5)
+    out = Larb::QuatArray.new(3)
+    assert_same out, Larb::QuatArray.from(rotations).nlerp(target, 0.4, out)
+    rotations.each_with_index { |q, i| assert out[i].near?(q.lerp(target, 0.4)) }
+  end
+
+  def test_interpolate_converts_t_before_reading_storage
+    a = Larb::QuatArray.from([axis_angle(0.5)])
+    b = Larb::QuatArray.from([axis_angle(0.5)])
+    t = Object.new
+    t.define_singleton_method(:to_f) do
+      a.to_io_buffer.resize(a.to_io_buffer.size * 8)
+      0.5
+    end
+    assert a.nlerp(b, t)[0].near?(axis_angle(0.5))
+    u = Object.new
+    u.define_singleton_method(:to_f) do
+      b.to_io_buffer.resize(b.to_io_buffer.size * 8)
+      0.5
+    end
+    assert a.slerp(b, [u])[0].near?(axis_angle(0.5))
+  end
+
+  def test_normalize
+    a = Larb::QuatArray.from([Larb::Quat.new(0, 0, 0, 2), Larb::Quat.new(0, 3, 0, 4)])
+    assert_equal Larb::Quat.new(0, 0, 0, 1), a.normalize[0]
+    assert_same a, a.normalize!
+    assert a[1].near?(Larb::Quat.new(0, 0.6, 0, 0.8))
+  end
+
+  def test_conjugate
+    a = Larb::QuatArray.from([Larb::Quat.new(1, 2, 3, 4)])
+    assert_equal Larb::Quat.new(1, 2, 3, 4).conjugate, a.conjugate[0]
+  end
+
+  def test_inspect
+    assert_equal "QuatArray[Quat[0.0, 0.0, 0.0, 1.0]]", Larb::QuatArray.new(1).inspect
+  end
+
+  def test_io_buffer_round_trip
+    a = Larb::QuatArray.new(2)
+    assert_equal [0.0, 0.0, 0.0, 1.0], a.to_io_buffer.get_values([:f64] * 4, 32)
+    b = Larb::QuatArray.from_io_buffer(a.to_io_buffer)
+    b[1] = Larb::Quat.new(1, 2, 3, 4)
+    assert_equal Larb::Quat.new(1, 2, 3, 4), a[1]
+  end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(Larb::QuatArray.new(3))
+    assert_equal "d", view.format
+    assert_equal [3, 4], view.shape
+    assert_equal 1.0, view[2, 3]
+    view.release
+  end
+
+  def test_float32_storage
+    q = Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 1, 0), 0.5)
+    a = Larb::QuatArray.from([q, Larb::Quat.identity], type: :float32)
+    assert_equal :float32, a.type
+    assert_equal 32, a.to_io_buffer.size
+    assert_equal Larb::Quat.identity, Larb::QuatArray.new(1, type: :float32)[0]
+    assert a.multiply(a)[0].near?(q * q, 1e-6)
+    assert a.slerp(Larb::Quat.identity, 0.5)[0].near?(q.slerp(Larb::Quat.identity, 0.5), 1e-6)
+    assert_raise(ArgumentError) { a.multiply(a.convert(:float64)) }
+  end
+
+  def test_float32_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(Larb::QuatArray.new(2, type: :float32))
+    assert_equal "f", view.format
+    assert_equal [16, 4], view.strides
+    assert_equal 1.0, view[1, 3]
+    view.release
+  end
+end
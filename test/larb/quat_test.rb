@@ -221,4 +221,42 @@ class QuatTest < Test::Unit::TestCase
     q = Larb::Quat.new(1, 2, 3, 4)
     assert_equal q.inspect, q.to_s
   end
+
+  def test_mul_bang
+    a = Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 1, 0), 0.3)
+    b = Larb::Quat.from_axis_angle(Larb::Vec3.new(1, 0, 0), 0.7)
+    expected = a * b
+    assert_same a, a.mul!(b)
+    assert a.near?(expected)
+  end
+
+  def test_mul_bang_with_self
+    q = Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 0, 1), 0.4)
+    expected = q * q
+    q.mul!(q)
+    assert q.near?(expected)
+  end
+
+  def test_slerp_bang
+    a = Larb::Quat.identity.dup
+    b = Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 1, 0), Math::PI / 2)
+    expected = a.slerp(b, 0.5)
+    a.slerp!(b, 0.5)
+    assert a.near?(expected)
+  end
+
+  def test_lerp_bang
+    a = Larb::Quat.identity.dup
+    b = Larb::Quat.from_axis_angle(Larb::Vec3.new(0, 1, 0), 1.0)
+    expected = a.lerp(b, 0.25)
+    a.lerp!(b, 0.25)
+    assert a.near?(expected)
+  end
+
+  def test_identity_constant_is_frozen
+    assert_same Larb::Quat::IDENTITY, Larb::Quat.identity
+    assert_raise(FrozenError) { Larb::Quat.identity.w = 2 }
+    assert_raise(FrozenError) { Larb::Quat.identity.normalize! }
+    assert_equal Larb::Quat.identity, Larb::Quat.identity.dup
+  end
 end
@@ -0,0 +1,116 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class TaskTest < Test::Unit::TestCase
+  class Scheduler
+    def initialize
+      @waiting = 0
+      @ready = Thread::Queue.new
+    end
+
+    def fiber(&block)
+      Fiber.new(blocking: false, &block).tap(&:resume)
+    end
+
+    def block(_blocker, _timeout = nil)
+      @waiting += 1
+      Fiber.yield
+    end
+
+    def unblock(_blocker, fiber)
+      @ready << fiber
+    end
+
+    def kernel_sleep(*) = block(nil)
+
+    def io_wait(*) = block(nil)
+
+    def close
+      while @waiting.positive?
+        @waiting -= 1
+        @ready.pop(timeout: 5).resume
+      end
+    end
+  end
+
+  def setup
+    @gvl_threshold = Larb.gvl_threshold
+  end
+
+  def teardown
+    Larb.gvl_threshold = @gvl_threshold
+  end
+
+  def points
+    Larb::Vec3Array.from([Larb::Vec3.new(1, 2, 3), Larb::Vec3.new(0, 3, 4)])
+  end
+
+  def test_value
+    task = Larb.async { points.add(points) }
+    assert_equal points.add(points), task.value
+    assert_same task, task.wait
+    assert task.done?
+  end
+
+  def test_matches_synchronous_kernels
+    Larb.gvl_threshold = nil
+    m = Larb::Mat4.rotation_y(0.3)
+    a = points
+    out = Larb::Vec3Array.new(2)
+    task = Larb.async { m.transform_points(a, out).normalize }
+    assert_equal m.transform_points(a).normalize, task.value
+    assert_equal m.transform_points(a), out
+    assert_false out.to_io_buffer.locked?
+  end
+
+  def test_kernels_in_nested_fibers_release_the_gvl
+    Larb.gvl_threshold = nil
+    a = Larb::Vec3Array.new(2_000_000)
+    task = Larb.async { Fiber.new { a.normalize! }.resume }
+    locked = false
+    until task.done?
+      locked ||= a.to_io_buffer.locked?
+      Thread.pass
+    end
+    task.wait
+    assert locked
+  end
+
+  def test_wait_with_timeout
+    gate = Thread::Queue.new
+    task = Larb.async { gate.pop }
+    assert_nil task.wait(0.01)
+    assert_false task.done?
+    gate << :done
+    assert_equal :done, task.value
+  end
+
+  def test_exceptions_are_raised_on_wait
+    task = Larb.async { points.add(1) }
+    assert_raise(TypeError) { task.wait }
+    assert_raise(TypeError) { task.value }
+    assert task.done?
+  end
+
+  def test_requires_block
+    assert_raise(ArgumentError) { Larb.async }
+  end
+
+  def test_wait_yields_to_other_fibers
+    order = Thread.new do
+      order = []
+      gate = Thread::Queue.new
+      task = Larb.async { gate.pop.add(points) }
+      Fiber.set_scheduler(Scheduler.new)
+      Fiber.schedule { order << task.wait.value }
+      Fiber.schedule do
+        order << :other
+        gate << points
+      end
+      Fiber.set_scheduler(nil)
+      order
+    end.value
+    assert_equal [:other, points.add(points)], order
+  end
+end
@@ -0,0 +1,155 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class Vec2ArrayTest < Test::Unit::TestCase
+  def build(*points)
+    Larb::Vec2Array.from(points.map { |p| Larb::Vec2.new(*p) })
+  end
+
+  def test_new_with_length_is_zero_filled
+    a = Larb::Vec2Array.new(3)
+    assert_equal 3, a.length
+    assert_equal Larb::Vec2.new(0, 0), a[2]
+    assert_equal 0, Larb::Vec2Array.new.length
+  end
+
+  def test_new_with_negative_length
+    assert_raise(ArgumentError) { Larb::Vec2Array.new(-1) }
+  end
+
+  def test_from_and_index
+    a = build([1, 2], [3, 4])
+    assert_equal 2, a.size
+    assert_equal Larb::Vec2.new(1, 2), a[0]
+    assert_equal Larb::Vec2.new(3, 4), a[-1]
+    assert_nil a[2]
+  end
+
+  def test_index_assign
+    a = Larb::Vec2Array.new(2)
+    a[1] = Larb::Vec2.new(7, 8)
+    assert_equal Larb::Vec2.new(7, 8), a[1]
+    assert_raise(IndexError) { a[2] = Larb::Vec2.new }
+  end
+
+  def test_each_and_to_a
+    a = build([1, 2], [3, 4])
+    assert_equal [Larb::Vec2.new(1, 2), Larb::Vec2.new(3, 4)], a.to_a
+    assert_equal [2.0, 4.0], a.map(&:y)
+  end
+
+  def test_dup_copies_storage
+    a = build([1, 2])
+    b = a.dup
+    b[0] = Larb::Vec2.new(0, 0)
+    assert_equal Larb::Vec2.new(1, 2), a[0]
+  end
+
+  def test_add_and_sub
+    a = build([1, 2], [3, 4])
+    assert_equal build([2, 4], [6, 8]), a.add(a)
+    assert_equal build([0, 2], [2, 4]), a.sub(Larb::Vec2.new(1, 0))
+  end
+
+  def test_add_into_output
+    a = build([1, 2])
+    assert_same a, a.add(a, a)
+    assert_equal build([2, 4]), a
+  end
+
+  def test_add_length_mismatch
+    assert_raise(ArgumentError) { build([1, 2]).add(Larb::Vec2Array.new(2)) }
+  end
+
+  def test_add_type_mismatch
+    assert_raise(TypeError) { build([1, 2]).add(Larb::Vec3.new) }
+  end
+
+  def test_scale
+    a = build([1, 2], [3, 4])
+    assert_equal build([2, 4], [6, 8]), a.scale(2)
+    assert_equal build([2, 6], [6, 12]), a.scale(Larb::Vec2.new(2, 3))
+  end
+
+  def test_rotate_matches_vec2
+    points = [Larb::Vec2.new(1, 0), Larb::Vec2.new(3, -2)]
+    result = Larb::Vec2Array.from(points).rotate(Math::PI / 3)
+    points.each_with_index { |p, i| assert result[i].near?(p.rotate(Math::PI / 3)) }
+  end
+
+  def test_rotate_in_place
+    a = build([1, 0])
+    a.rotate(Math::PI / 2, a)
+    assert a[0].near?(Larb::Vec2.new(0, 1))
+  end
+
+  def test_dot_and_lengths
+    a = build([3, 4], [1, 0])
+    assert_equal [11.0, 1.0], a.dot(Larb::Vec2.new(1, 2))
+    assert_equal [5.0, 1.0], a.lengths
+  end
+
+  def test_normalize
+    a = build([0, 5], [3, 0])
+    assert_equal build([0, 1], [1, 0]), a.normalize
+    assert_same a, a.normalize!
+    assert_equal build([0, 1], [1, 0]), a
+  end
+
+  def test_lerp
+    assert_equal build([5, 10]), build([0, 0]).lerp(build([10, 20]), 0.5)
+  end
+
+  def test_lerp_converts_t_before_reading_storage
+    a = build([1, 2])
+    t = Object.new
+    t.define_singleton_method(:to_f) do
+      a.to_io_buffer.resize(a.to_io_buffer.size * 8)
+      0.5
+    end
+    assert_equal build([1, 2]), a.lerp(build([1, 2]), t)
+  end
+
+  def test_equality
+    assert_equal build([1, 2]), build([1, 2])
+    assert_not_equal build([1, 2]), build([1, 3])
+  end
+
+  def test_inspect
+    assert_equal "Vec2Array[Vec2[1.0, 2.0]]", build([1, 2]).inspect
+  end
+
+  def test_io_buffer_round_trip
+    a = build([1, 2], [3, 4])
+    b = Larb::Vec2Array.from_io_buffer(a.to_io_buffer)
+    b[0] = Larb::Vec2.new(5, 6)
+    assert_equal Larb::Vec2.new(5, 6), a[0]
+    assert_equal [5.0, 6.0, 3.0, 4.0], a.to_io_buffer.get_values([:f64] * 4, 0)
+  end
+
+  def test_memory_view
+    require "fiddle"
+    view = Fiddle::MemoryView.new(build([1, 2], [3, 4]))
+    assert_equal [2, 2], view.shape
+    assert_equal 3.0, view[1, 0]
+    view.release
+  end
+
+  def test_float32_storage
+    a = build([1, 2], [3, 4]).convert(:float32)
+    assert_equal :float32, a.type
+    assert_equal 16, a.to_io_buffer.size
+    assert_equal build([2, 4], [6, 8]), a.add(a)
+    assert_equal build([1, 2], [3, 4]).rotate(0.5).to_a.map(&:x).map { |x| x.round(5) },
+                 a.rotate(0.5).to_a.map(&:x).map { |x| x.round(5) }
+    assert_raise(ArgumentError) { a.add(build([1, 2], [3, 4])) }
+  end
+
+  def test_float32_transform_points
+    a = Larb::Vec2Array.from([Larb::Vec2.new(1, 2)], type: :float32)
+    result = Larb::Mat2d.translation(1, 1).transform_points(a)
+    assert_equal :float32, result.type
+    assert_equal Larb::Vec2.new(2, 3), result[0]
+  end
+end
@@ -248,4 +248,51 @@ class Vec2Test < Test::Unit::TestCase
     v = Larb::Vec2.new(1, 2)
     assert_equal v.inspect, v.to_s
   end
+
+  def test_bang_arithmetic
+    v = Larb::Vec2.new(1, 2)
+    assert_same v, v.add!(Larb::Vec2.new(1, 1))
+    assert_equal Larb::Vec2.new(2, 3), v
+    v.sub!(Larb::Vec2.new(1, 2))
+    assert_equal Larb::Vec2.new(1, 1), v
+    v.mul!(3)
+    assert_equal Larb::Vec2.new(3, 3), v
+    v.scale!(2)
+    assert_equal Larb::Vec2.new(6, 6), v
+    v.negate!
+    assert_equal Larb::Vec2.new(-6, -6), v
+  end
+
+  def test_lerp_bang
+    v = Larb::Vec2.new(0, 0)
+    v.lerp!(Larb::Vec2.new(10, 20), 0.25)
+    assert_equal Larb::Vec2.new(2.5, 5), v
+  end
+
+  def test_bang_on_frozen_raises
+    assert_raise(FrozenError) { Larb::Vec2.new.freeze.negate! }
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Vec2::ZERO, Larb::Vec2.zero
+    assert_equal Larb::Vec2.new(1, 1), Larb::Vec2::ONE
+    assert Larb::Vec2::ONE.frozen?
+    assert_raise(FrozenError) { Larb::Vec2.zero.x = 1 }
+    assert_raise(FrozenError) { Larb::Vec2.zero[1] = 1 }
+  end
+
+  def test_dup_is_mutable_copy
+    v = Larb::Vec2.one.dup
+    v.x = 5
+    assert_equal Larb::Vec2.new(5, 1), v
+    assert_equal Larb::Vec2.new(1, 1), Larb::Vec2.one
+  end
+
+  def test_scalar_coercion
+    v = Larb::Vec2.new(1, 2)
+    v.x = Rational(3, 2)
+    assert_equal Larb::Vec2.new(1.5, 2), v
+    assert_equal Larb::Vec2.new(3, 4), Larb::Vec2.new(1.5, 2) * 2
+    assert_equal Larb::Vec2.new(2, 4), Larb::Vec2.new(1, 2) * Struct.new(:to_f).new(2.0)
+  end
 end
@@ -0,0 +1,318 @@
+# frozen_string_literal: true
+
+require_relative "../test_helper"
+
+class Vec3ArrayTest < Test::Unit::TestCase
+  def build(*points)
+    Larb::Vec3Array.from(points.map { |p| Larb::Vec3.new(*p) })
+  end
+
+  def test_new_with_default_length
+    a = Larb::Vec3Array.new
+    assert_equal 0, a.length
+  end
+
+  def test_new_with_length_is_zero_filled
+    a = Larb::Vec3Array.new(3)
+    assert_equal 3, a.length
+    assert_equal Larb::Vec3.new(0, 0, 0), a[2]
+  end
+
+  def test_new_with_negative_length
+    assert_raise(ArgumentError) { Larb::Vec3Array.new(-1) }
+  end
+
+  def test_from
+    a = build([1, 2, 3], [4, 5, 6])
+    assert_equal 2, a.size
+    assert_equal Larb::Vec3.new(1, 2, 3), a[0]
+    assert_equal Larb::Vec3.new(4, 5, 6), a[-1]
+  end
+
+  def test_index_out_of_range
+    a = build([1, 2, 3])
+    assert_nil a[1]
+    assert_raise(IndexError) { a[1] = Larb::Vec3.new }
+  end
+
+  def test_index_assign
+    a = Larb::Vec3Array.new(2)
+    a[1] = Larb::Vec3.new(7, 8, 9)
+    assert_equal Larb::Vec3.new(7, 8, 9), a[1]
+  end
+
+  def test_each_and_to_a
+    a = build([1, 2, 3], [4, 5, 6])
+    assert_equal [Larb::Vec3.new(1, 2, 3), Larb::Vec3.new(4, 5, 6)], a.to_a
+    assert_equal [1.0, 4.0], a.map(&:x)
+  end
+
+  def test_dup_copies_storage
+    a = build([1, 2, 3])
+    b = a.dup
+    b[0] = Larb::Vec3.new(0, 0, 0)
+    assert_equal Larb::Vec3.new(1, 2, 3), a[0]
+  end
+
+  def test_freeze_detaches_storage
+    a = build([1, 2, 3])
+    assert_same a, a.freeze
+    assert Ractor.shareable?(Ractor.make_shareable(a))
+    assert a.to_io_buffer.readonly?
+    assert_raise(FrozenError) { a[0] = Larb::Vec3.new }
+    assert_raise(FrozenError) { a.normalize! }
+    assert_raise(FrozenError) { a.add(a, a) }
+    assert_equal build([2, 4, 6]), a.add(a)
+    b = a.dup
+    b[0] = Larb::Vec3.new
+    assert_equal Larb::Vec3.new(1, 2, 3), a[0]
+  end
+
+  def test_overlapping_views_are_rejected
+    a = build([1, 2, 3], [4, 5, 6], [7, 8, 9])
+    head = a.view(0, 2)
+    tail = a.view(1, 2)
+    assert_raise(ArgumentError) { head.add(head, tail) }
+    assert_raise(ArgumentError) { head.normalize(tail) }
+    assert_raise(ArgumentError) { Larb::Mat4.identity.transform_points(head, tail) }
+    head.add(a.view(0, 2), head)
+    assert_equal build([2, 4, 6], [8, 10, 12], [7, 8, 9]), a
+  end
+
+  def test_view_shares_storage
+    a = build([1, 2, 3], [4, 5, 6], [7, 8, 9])
+    view = a.view(1, 5)
+    assert_equal build([4, 5, 6], [7, 8, 9]), view
+    view.normalize!
+    assert_equal view[0], a[1]
+    assert_equal 0, a.view(3, 1).length
+    assert_raise(IndexError) { a.view(4, 1) }
+    assert_raise(ArgumentError) { a.view(0, -1) }
+    assert_equal :float32, a.convert(:float32).view(1, 1).type
+    assert_raise(IO::Buffer::AccessError) { a.freeze.view(0, 1)[0] = Larb::Vec3.new }
+    readonly = Larb::Vec3Array.from_io_buffer(IO::Buffer.for([1.0, 2.0, 3.0].pack("d*").freeze))
+    assert_raise(IO::Buffer::AccessError) { readonly.view(0, 1).normalize! }
+  end
+
+  def test_add
+    a = build([1, 2, 3], [4, 5, 6])
+    b = build([1, 1, 1], [2, 2, 2])
+    assert_equal build([2, 3, 4], [6, 7, 8]), a.add(b)
+  end
+
+  def test_add_broadcasts_vec3
+    a = build([1, 2, 3], [4, 5, 6])
+    assert_equal build([2, 2, 3], [5, 5, 6]), a.add(Larb::Vec3.new(1, 0, 0))
+  end
+
+  def test_add_into_output
+    a = build([1, 2, 3])
+    out = Larb::Vec3Array.new(1)
+    assert_same out, a.add(a, out)
+    assert_equal build([2, 4, 6]), out
+  end
+
+  def test_add_in_place
+    a = build([1, 2, 3])
+    a.add(a, a)
+    assert_equal build([2, 4, 6]), a
+  end
+
+  def test_add_length_mismatch
+    assert_raise(ArgumentError) { build([1, 2, 3]).add(Larb::Vec3Array.new(2)) }
+  end
+
+  def test_add_type_mismatch
+    assert_raise(TypeError) { build([1, 2, 3]).add(1) }
+  end
+
+  def test_sub
+    a = build([4, 5, 6])
+    assert_equal build([3, 3, 3]), a.sub(build([1, 2, 3]))
+  end
+
+  def test_scale
+    a = build([1, 2, 3], [4, 5, 6])
+    assert_equal build([2, 4, 6], [8, 10, 12]), a.scale(2)
+    assert_equal build([1, 4, 9], [4, 10, 18]), a.scale(Larb::Vec3.new(1, 2, 3))
+  end
+
+  def test_dot
+    a = build([1, 2, 3], [1, 0, 0])
+    assert_equal [32.0, 4.0], a.dot(build([4, 5, 6], [4, 5, 6]))
+  end
+
+  def test_cross
+    a = build([1, 0, 0], [1, 2, 3])
+    b = build([0, 1, 0], [4, 5, 6])
+    assert_equal build([0, 0, 1], [-3, 6, -3]), a.cross(b)
+  end
+
+  def test_cross_in_place
+    a = build([1, 2, 3])
+    a.cross(build([4, 5, 6]), a)
+    assert_equal build([-3, 6, -3]), a
+  end
+
+  def test_lengths
+    assert_equal [7.0, 5.0], build([2, 3, 6], [0, 3, 4]).lengths
+  end
+
+  def test_normalize
+    result = build([0, 3, 4]).normalize
+    assert result[0].near?(Larb::Vec3.new(0, 0.6, 0.8))
+  end
+
+  def test_normalize_bang
+    a = build([0, 0, 5], [3, 0, 0])
+    assert_same a, a.normalize!
+    assert_equal build([0, 0, 1], [1, 0, 0]), a
+  end
+
+  def test_lerp
+    a = build([0, 0, 0])
+    b = build([10, 20, 30])
+    assert_equal build([5, 10, 15]), a.lerp(b, 0.5)
+  end
+
+  def test_lerp_converts_t_before_reading_storage
+    a = build([1, 2, 3])
+    t = Object.new
+    t.define_singleton_method(:to_f) do
+      a.to_io_buffer.resize(a.to_io_buffer.size * 8)
+      0.5
+    end
+    assert_equal build([1, 2, 3]), a.lerp(build([1, 2, 3]), t)
+  end
+
+  def test_equality
+    assert_equal build([1, 2, 3]), build([1, 2, 3])
+    assert_not_equal build([1, 2, 3]), build([1, 2, 4])
+    assert_not_equal build([1, 2, 3]), build([1, 2, 3], [1, 2, 3])
+  end
+
+  def test_inspect
+    assert_equal "Vec3Array[Vec3[1.0, 2.0, 3.0]]", build([1, 2, 3]).inspect
+  end
+
+  def test_to_io_buffer_shares_storage
+    a = build([1, 2, 3], [4, 5, 6])
+    buffer = a.to_io_buffer
+    assert_equal 48, buffer.size
+    assert_equal [1.0, 2.0, 3.0, 4.0, 5.0, 6.0], buffer.get_values([:f64] * 6, 0)
+    buffer.set_value(:f64, 0, 9.0)
+    assert_equal Larb::Vec3.new(9, 2, 3), a[0]
+  end
+
+  def test_from_io_buffer_wraps_storage
+    buffer = IO::Buffer.new(48)
+    a = Larb::Vec3Array.from_io_buffer(buffer)
+    assert_equal 2, a.length
+    a[1] = Larb::Vec3.new(7, 8, 9)
+    assert_equal 8.0, buffer.get_value(:f64, 32)
+    assert_same buffer, a.to_io_buffer
+  end
+
+  def test_from_io_buffer_with_length
+    assert_equal 1, Larb::Vec3Array.from_io_buffer(IO::Buffer.new(64), 1).length
+    assert_raise(ArgumentError) { Larb::Vec3Array.from_io_buffer(IO::Buffer.new(64)) }
+    assert_raise(ArgumentError) { Larb::Vec3Array.from_io_buffer(IO::Buffer.new(16), 1) }
+    assert_raise(TypeError) { Larb::Vec3Array.from_io_buffer("x" * 24) }
+  end
+
+  def test_from_readonly_io_buffer
+    a = Larb::Vec3Array.from_io_buffer(IO::Buffer.for([1.0, 2.0, 3.0].pack("d*").freeze))
+    assert_equal Larb::Vec3.new(1, 2, 3), a[0]
+    assert_raise(IO::Buffer::AccessError) { a[0] = Larb::Vec3.new }
+    assert_raise(IO::Buffer::AccessError) { a.normalize! }
+    assert_raise(IO::Buffer::AccessError) { a.add(a, a) }
+  end
+
+  def test_freed_io_buffer_raises
+    buffer = IO::Buffer.new(24)
+    a = Larb::Vec3Array.from_io_buffer(buffer)
+    buffer.free
+    assert_raise(RuntimeError) { a[0] }
+  end
+
+  def test_memory_view
+    require "fiddle"
+    a = build([1, 2, 3], [4, 5, 6])
+    view = Fiddle::MemoryView.new(a)
+    assert_equal "d", view.format
+    assert_equal [2, 3], view.shape
+    assert_equal [24, 8], view.strides
+    assert_equal 6.0, view[1, 2]
+    assert_raise(IO::Buffer::LockedError) { a.to_io_buffer.free }
+    view.release
+  end
+
+  def test_float32_storage
+    a = Larb::Vec3Array.from([Larb::Vec3.new(1, 2, 3), Larb::Vec3.new(4, 5, 6)], type: :float32)
+    assert_equal :float32, a.type
+    assert_equal 24, a.to_io_buffer.size
+    assert_equal [1.0, 2.0, 3.0], a.to_io_buffer.get_values([:f32] * 3, 0)
+    assert_equal :float64, Larb::Vec3Array.new(1).type
+    assert_equal :float32, Larb::Vec3Array.new(1, type: :float32).type
+  end
+
+  def test_float32_kernels_match_float64
+    a = build([1, 2, 3], [0, 3, 4])
+    b = build([4, 5, 6], [1, 1, 1])
+    af = a.convert(:float32)
+    bf = b.convert(:float32)
+    assert_equal :float32, af.add(bf).type
+    assert_equal a.add(b), af.add(bf)
+    assert_equal a.cross(b), af.cross(bf)
+    assert_equal a.scale(2), af.scale(2)
+    assert_equal a.lengths, af.lengths
+    af.normalize.each_with_index { |v, i| assert v.near?(a.normalize[i], 1e-6) }
+    assert_equal a, af.convert(:float64)
+  end
+
+  def test_float32_type_mismatch
+    a = build([1, 2, 3])
+    assert_raise(ArgumentError) { a.add(a.convert(:float32)) }
+    assert_raise(ArgumentError) { a.add(a, a.convert(:float32)) }
+    assert_raise(ArgumentError) { Larb::Vec3Array.new(1, type: :float16) }
+  end
+
+  def test_float32_transform_points
+    m = Larb::Mat4.translation(1, 2, 3)
+    a = build([1, 1, 1]).convert(:float32)
+    result = m.transform_points(a)
+    assert_equal :float32, result.type
+    assert_equal Larb::Vec3.new(2, 3, 4), result[0]
+    assert_raise(ArgumentError) { m.transform_points(a, Larb::Vec3Array.new(1)) }
+  end
+
+  def test_float32_io_buffer_and_memory_view
+    require "fiddle"
+    buffer = IO::Buffer.new(24)
+    a = Larb::Vec3Array.from_io_buffer(buffer, type: :float32)
+    assert_equal 2, a.length
+    a[1] = Larb::Vec3.new(7, 8, 9)
+    assert_equal 8.0, buffer.get_value(:f32, 16)
+    view = Fiddle::MemoryView.new(a)
+    assert_equal "f", view.format
+    assert_equal [12, 4], view.strides
+    view.release
+  end
+
+  def test_buffer_survives_minor_gc_after_resize
+    a = Larb::Vec3Array.new(1)
+    4.times { GC.start }
+    a.send(:initialize, 2)
+    GC.start(full_mark: false, immediate_sweep: true)
+    a[1] = Larb::Vec3.new(1, 2, 3)
+    assert_equal 48, a.to_io_buffer.size
+    assert_equal Larb::Vec3.new(1, 2, 3), a[1]
+  end
+
+  def test_survives_compaction
+    omit "compaction unsupported" unless GC.respond_to?(:verify_compaction_references)
+    a = build([1, 2, 3])
+    GC.verify_compaction_references(expand_heap: true, toward: :empty)
+    assert_equal Larb::Vec3.new(1, 2, 3), a[0]
+  end
+end
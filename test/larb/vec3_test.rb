@@ -307,4 +307,106 @@ class Vec3Test < Test::Unit::TestCase
     v = Larb::Vec3.new(1, 2, 3)
     assert_equal v.inspect, v.to_s
   end
+
+  def test_add_bang
+    v = Larb::Vec3.new(1, 2, 3)
+    assert_same v, v.add!(Larb::Vec3.new(1, 1, 1))
+    assert_equal Larb::Vec3.new(2, 3, 4), v
+  end
+
+  def test_sub_bang
+    v = Larb::Vec3.new(1, 2, 3)
+    v.sub!(Larb::Vec3.new(1, 1, 1))
+    assert_equal Larb::Vec3.new(0, 1, 2), v
+  end
+
+  def test_mul_bang
+    v = Larb::Vec3.new(1, 2, 3)
+    v.mul!(2)
+    assert_equal Larb::Vec3.new(2, 4, 6), v
+    v.scale!(Larb::Vec3.new(1, 0.5, 2))
+    assert_equal Larb::Vec3.new(2, 2, 12), v
+  end
+
+  def test_negate_bang
+    v = Larb::Vec3.new(1, -2, 3)
+    assert_same v, v.negate!
+    assert_equal Larb::Vec3.new(-1, 2, -3), v
+  end
+
+  def test_cross_bang
+    v = Larb::Vec3.new(1, 2, 3)
+    other = Larb::Vec3.new(4, 5, 6)
+    expected = v.cross(other)
+    v.cross!(other)
+    assert_equal expected, v
+  end
+
+  def test_cross_bang_with_self
+    v = Larb::Vec3.new(1, 2, 3)
+    v.cross!(v)
+    assert_equal Larb::Vec3.zero, v
+  end
+
+  def test_lerp_bang
+    v = Larb::Vec3.new(0, 0, 0)
+    v.lerp!(Larb::Vec3.new(10, 20, 30), 0.5)
+    assert_equal Larb::Vec3.new(5, 10, 15), v
+  end
+
+  def test_min_max_bang
+    v = Larb::Vec3.new(1, 5, 3)
+    v.min!(Larb::Vec3.new(2, 2, 2))
+    assert_equal Larb::Vec3.new(1, 2, 2), v
+    v.max!(Larb::Vec3.new(0, 4, 0))
+    assert_equal Larb::Vec3.new(1, 4, 2), v
+  end
+
+  def test_bang_on_frozen_raises
+    v = Larb::Vec3.new(1, 2, 3).freeze
+    assert_raise(FrozenError) { v.add!(Larb::Vec3.one) }
+  end
+
+  def test_survives_compaction
+    omit "compaction unsupported" unless GC.respond_to?(:verify_compaction_references)
+    v = Larb::Vec3.new(1, 2, 3)
+    GC.verify_compaction_references(expand_heap: true, toward: :empty)
+    assert_equal Larb::Vec3.new(1, 2, 3), v
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Vec3::UP, Larb::Vec3.up
+    assert_same Larb::Vec3.zero, Larb::Vec3.zero
+    assert_equal Larb::Vec3.new(-1, 0, 0), Larb::Vec3::LEFT
+    assert Larb::Vec3::FORWARD.frozen?
+    assert_raise(FrozenError) { Larb::Vec3.up.y = 2 }
+    assert_raise(FrozenError) { Larb::Vec3.up.normalize! }
+    assert_raise(FrozenError) { Larb::Vec3.up.send(:initialize, 1, 2, 3) }
+  end
+
+  def test_constants_for_subclass_allocate
+    subclass = Class.new(Larb::Vec3)
+    v = subclass.up
+    assert_instance_of subclass, v
+    assert_not_predicate v, :frozen?
+    assert_equal Larb::Vec3.new(0, 1, 0), v
+  end
+
+  def test_dup_is_mutable_copy
+    v = Larb::Vec3.up.dup
+    v.add!(Larb::Vec3.right)
+    assert_equal Larb::Vec3.new(1, 1, 0), v
+    assert_equal Larb::Vec3.new(0, 1, 0), Larb::Vec3::UP
+    assert_raise(TypeError) { Larb::Vec3.new.send(:initialize_copy, Larb::Vec2.new) }
+  end
+
+  def test_scalar_coercion
+    v = Larb::Vec3.new(1, 2, 3)
+    assert_equal Larb::Vec3.new(2, 4, 6), v * 2
+    assert_equal Larb::Vec3.new(0.5, 1, 1.5), v * Rational(1, 2)
+    assert_equal (2**70).to_f, (v * 2**70).x
+    assert_equal Larb::Vec3.new(3, 6, 9), v * Struct.new(:to_f).new(3.0)
+    assert_equal Larb::Vec3.new(1.5, 0, 0), Larb::Vec3.new("1.5")
+    assert_raise(NoMethodError) { v * Object.new }
+  end
 end
@@ -186,4 +186,29 @@ class Vec4Test < Test::Unit::TestCase
     v = Larb::Vec4.new(1, 2, 3, 4)
     assert_equal v.inspect, v.to_s
   end
+
+  def test_bang_arithmetic
+    v = Larb::Vec4.new(1, 2, 3, 4)
+    assert_same v, v.add!(Larb::Vec4.new(1, 1, 1, 1))
+    assert_equal Larb::Vec4.new(2, 3, 4, 5), v
+    v.sub!(Larb::Vec4.new(2, 2, 2, 2))
+    assert_equal Larb::Vec4.new(0, 1, 2, 3), v
+    v.mul!(2)
+    assert_equal Larb::Vec4.new(0, 2, 4, 6), v
+    v.negate!
+    assert_equal Larb::Vec4.new(0, -2, -4, -6), v
+  end
+
+  def test_lerp_bang
+    v = Larb::Vec4.new(0, 0, 0, 0)
+    v.lerp!(Larb::Vec4.new(2, 4, 6, 8), 0.5)
+    assert_equal Larb::Vec4.new(1, 2, 3, 4), v
+  end
+
+  def test_constants_are_frozen
+    assert_same Larb::Vec4::ONE, Larb::Vec4.one
+    assert_equal Larb::Vec4.new(0, 0, 0, 0), Larb::Vec4::ZERO
+    assert_raise(FrozenError) { Larb::Vec4.zero.w = 1 }
+    assert_equal Larb::Vec4.new(2, 2, 2, 2), Larb::Vec4.one.dup.mul!(2)
+  end
 end
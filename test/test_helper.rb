@@ -2,3 +2,5 @@
 
 require "test-unit"
 require_relative "../lib/larb"
+
+Warning[:experimental] = false